@@ -7,12 +7,25 @@
 //
 
 #import "AppDelegate.h"
+#import "BCAnalyticsBatcher.h"
+#import "BCStartupTimeline.h"
+#import "BCStallWatchdog.h"
 #import "ViewController.h"
 
 @implementation AppDelegate
 
 - (BOOL)application:(UIApplication *)application didFinishLaunchingWithOptions:(NSDictionary *)launchOptions
 {
+    // Start the startup clock before any work is done.
+    [BCStartupTimeline sharedTimeline];
+    
+    // Report main-thread stalls, such as a WV_Play or plist read, with where they happen.
+    [[BCStallWatchdog sharedWatchdog] start];
+    
+    // Post analytics beacons in batches instead of waking the radio for each one, once widevine.plist
+    // names an analyticsBatchUrl.
+    [[BCAnalyticsBatcher sharedBatcher] install];
+    
     self.window = [[[UIWindow alloc] initWithFrame:[[UIScreen mainScreen] bounds]] autorelease];
     self.viewController = [[[ViewController alloc] init] autorelease];
     self.window.rootViewController = self.viewController;
@@ -0,0 +1,49 @@
+//
+//  VideoRowModel.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+@class BCVideo;
+@class BCTimeFormatter;
+
+/**
+ * What a VideoViewCell shows for one video, worked out ahead of time so that
+ * cellForRowAtIndexPath: only has to copy it into the cell.
+ *
+ * Row models are immutable and may be built on any thread, given a formatter
+ * used only by that thread.
+ */
+@interface VideoRowModel : NSObject
+
+/**
+ * Returns the row model of video, formatting its duration with formatter.
+ */
++ (VideoRowModel *)rowModelWithVideo:(BCVideo *)video formatter:(BCTimeFormatter *)formatter;
+
+/**
+ * The video the row shows. Compared by identity to tell whether a cached model
+ * is still current for a row whose page was reloaded.
+ */
+@property (nonatomic, readonly, retain) BCVideo *video;
+
+/**
+ * The video's name, cut to the length the cell can show.
+ */
+@property (nonatomic, readonly, copy) NSString *title;
+
+/**
+ * The video's duration as h:mm:ss.
+ */
+@property (nonatomic, readonly, copy) NSString *durationText;
+
+/**
+ * The URL of the video's still, to look up in BCImageCache stillImageCache.
+ */
+@property (nonatomic, readonly, retain) NSURL *stillURL;
+
+@end
@@ -0,0 +1,62 @@
+//
+//  VideoRowModel.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCVideo.h"
+#import "BCTimeFormatter.h"
+
+#import "VideoRowModel.h"
+
+// Longest title kept; the name label truncates well before this.
+#define VideoRowModelMaxTitleLength 80
+
+@interface VideoRowModel ()
+
+@property (nonatomic, readwrite, retain) BCVideo *video;
+@property (nonatomic, readwrite, copy) NSString *title;
+@property (nonatomic, readwrite, copy) NSString *durationText;
+@property (nonatomic, readwrite, retain) NSURL *stillURL;
+
+@end
+
+@implementation VideoRowModel
+
+@synthesize video;
+@synthesize title;
+@synthesize durationText;
+@synthesize stillURL;
+
++ (VideoRowModel *)rowModelWithVideo:(BCVideo *)video formatter:(BCTimeFormatter *)formatter
+{
+    VideoRowModel *model = [[[VideoRowModel alloc] init] autorelease];
+    model.video = video;
+
+    NSString *name = [video.properties objectForKey:@"name"];
+    if ([name length] > VideoRowModelMaxTitleLength) {
+        name = [[name substringToIndex:VideoRowModelMaxTitleLength - 1] stringByAppendingString:@"…"];
+    }
+    model.title = name;
+
+    NSNumber *duration = [video.properties objectForKey:@"duration"];
+    model.durationText = [formatter stringForSeconds:duration.unsignedLongValue / 1000
+                                               style:BCTimeFormatterStyleHoursMinutesSeconds];
+
+    model.stillURL = [video.properties objectForKey:@"videoStillURL"];
+    return model;
+}
+
+- (void)dealloc
+{
+    self.video = nil;
+    self.title = nil;
+    self.durationText = nil;
+    self.stillURL = nil;
+
+    [super dealloc];
+}
+
+@end
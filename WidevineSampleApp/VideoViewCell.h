@@ -8,10 +8,17 @@
 
 #import <UIKit/UIKit.h>
 
+@class VideoRowModel;
+
 @interface VideoViewCell : UITableViewCell
 
 + (NSString *)reuseIdentifier;
 
+/**
+ * Shows the name and duration of a row model. The still is loaded separately.
+ */
+- (void)configureWithRowModel:(VideoRowModel *)rowModel;
+
 @property(strong,nonatomic) IBOutlet UIImageView *videoStill;
 @property(strong,nonatomic) IBOutlet UILabel *videoNameLabel;
 @property(strong,nonatomic) IBOutlet UILabel *durationLabel;
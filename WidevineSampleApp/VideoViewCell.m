@@ -6,34 +6,68 @@
 //
 //
 
+#import "VideoRowModel.h"
+
 #import "VideoViewCell.h"
 
+@interface VideoViewCell ()
+
+- (void)setUpSelectedBackgroundView;
+
+@end
+
 @implementation VideoViewCell
 
 @synthesize videoStill;
 @synthesize videoNameLabel;
 @synthesize durationLabel;
 
+/**
+ * Returns the selection color shared by every cell.
+ */
++ (UIColor *)selectedBackgroundColor
+{
+    static UIColor *selectedBackgroundColor = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        selectedBackgroundColor = [[UIColor colorWithRed:0.016 green:0.333 blue:0.569 alpha:1] retain]; /*#045591*/
+    });
+    return selectedBackgroundColor;
+}
+
 - (id)initWithStyle:(UITableViewCellStyle)style reuseIdentifier:(NSString *)reuseIdentifier
 {
     self = [super initWithStyle:style reuseIdentifier:reuseIdentifier];
     if (self) {
-        // Initialization code
+        [self setUpSelectedBackgroundView];
     }
     return self;
 }
 
-- (void)setSelected:(BOOL)selected animated:(BOOL)animated
+- (void)awakeFromNib
 {
-    [super setSelected:selected animated:animated];
+    [super awakeFromNib];
+    [self setUpSelectedBackgroundView];
+}
 
-    // Configure the view for the selected state
+/**
+ * Gives the cell its selected background once, rather than on every selection
+ * change. A view can't be in two cells at once, so each cell has its own.
+ */
+- (void)setUpSelectedBackgroundView
+{
     UIView *bgColorView = [[UIView alloc] init];
-    [bgColorView setBackgroundColor:[UIColor colorWithRed:0.016 green:0.333 blue:0.569 alpha:1]]; /*#045591*/
+    [bgColorView setBackgroundColor:[VideoViewCell selectedBackgroundColor]];
     [self setSelectedBackgroundView:bgColorView];
     [bgColorView release];
 }
 
+- (void)configureWithRowModel:(VideoRowModel *)rowModel
+{
+    self.videoNameLabel.text = rowModel.title;
+    self.durationLabel.text = rowModel.durationText;
+}
+
 + (NSString *)reuseIdentifier {
     return @"VideoViewCellIdentifier";
 }
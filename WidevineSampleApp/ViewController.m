@@ -10,10 +10,19 @@
 #import "BCVideo.h"
 #import "BCCatalog.h"
 #import "BCEventLogger.h"
-#import "BCUIControls.h"
+#import "BCSeekingControls.h"
 #import "BCPlaylist.h"
 #import "BCEvent.h"
 #import "BCWidevinePlugin.h"
+#import "BCPlaylistSnapshot.h"
+#import "BCPagedPlaylist.h"
+#import "BCConnectionWarmer.h"
+#import "BCMediaService+Widevine.h"
+#import "BCQoEMonitor.h"
+#import "BCAnalyticsBatcher.h"
+#import "BCChapterIndex.h"
+#import "BCStartupTimeline.h"
+#import "BCWidevineConfiguration.h"
 #import "Constants.h"
 
 #import "WidevineInfo.h"
@@ -26,8 +35,10 @@
     BCCatalog *catalog;
     BCEventEmitter *eventEmitter;
     BCEventLogger *logger;
-    BCUIControls *controlsComponent;
+    BCSeekingControls *controlsComponent;
     WidevineInfo *infoComponent;
+    BCPagedPlaylist *pagedPlaylist;
+    BCQoEMonitor *qoeMonitor;
 }
 
 @property(nonatomic,retain) BCWidevinePlugin *widevinePlugin;
@@ -35,8 +46,10 @@
 @property(nonatomic,retain) BCCatalog *catalog;
 @property(nonatomic,retain) BCEventEmitter *eventEmitter;
 @property(nonatomic,retain) BCEventLogger *logger;
-@property(nonatomic,retain) BCUIControls *controlsComponent;
+@property(nonatomic,retain) BCSeekingControls *controlsComponent;
 @property(nonatomic,retain) WidevineInfo *infoComponent;
+@property(nonatomic,retain) BCPagedPlaylist *pagedPlaylist;
+@property(nonatomic,retain) BCQoEMonitor *qoeMonitor;
 @end
 
 @implementation ViewController
@@ -48,9 +61,13 @@
 @synthesize logger;
 @synthesize controlsComponent;
 @synthesize infoComponent;
+@synthesize pagedPlaylist;
+@synthesize qoeMonitor;
 
 - (void)dealloc
 {
+    // The monitor observes the plugin without retaining it, so it lets go first.
+    self.qoeMonitor.widevinePlugin = nil;
     self.widevinePlugin = nil;
     self.player = nil;
     self.catalog = nil;
@@ -58,6 +75,8 @@
     self.logger = nil;
     self.controlsComponent = nil;
     self.infoComponent = nil;
+    self.pagedPlaylist = nil;
+    self.qoeMonitor = nil;
     
     [[NSNotificationCenter defaultCenter] removeObserver:self];
     
@@ -68,52 +87,214 @@
 {
     [super viewDidLoad];
     
+    // widevine.plist is read and validated once here; everything else uses the parsed configuration. See
+    // BCWidevineConfiguration.h for the keys it may contain, such as 'mediaApiBaseUrl' to test with a
+    // different Media API base url, 'pagedSearchPageSize' to page through a video search instead of loading
+    // a playlist, or 'WVDRMServerKey' to warm the connection to the license server during startup.
+    NSError *error = nil;
     NSString *path = [[NSBundle mainBundle] pathForResource:@"widevine" ofType:@"plist"];
-    NSDictionary *dictionary = [NSDictionary dictionaryWithContentsOfFile:path];
+    if (![BCWidevineConfiguration loadSharedConfigurationWithContentsOfFile:path error:&error]) {
+        [self displayErrorAlert:[error localizedDescription]];
+        return;
+    }
+    BCWidevineConfiguration *configuration = [BCWidevineConfiguration sharedConfiguration];
+    [self applyAnalyticsBatchURL:configuration];
+    
+    // The first Media API request doesn't depend on the plugin, so it is sent before the plugin brings up
+    // Widevine and the player. Its response arrives on a later run loop pass, once the plugin is ready.
+    self.catalog = [[[BCCatalog alloc] initWithToken:configuration.mediaApiToken
+                                             baseURL:configuration.mediaApiBaseURL] autorelease];
     
-    // To test with a different base url for the media api, add a string value to 'widevine.plist' named
-    // 'mediaApiBaseUrl' with the value set to the base url you would like to test.
-    [self initializePluginWithToken:(NSString *) [dictionary objectForKey:@"mediaApiToken"]
-                            baseUrl:[dictionary objectForKey:@"mediaApiBaseUrl"]];
+    BCPlaylist *snapshot = nil;
+    if (configuration.pagedSearchPageSize > 0) {
+        [self loadPagedPlaylist];
+    } else {
+        snapshot = [BCPlaylistSnapshot playlistWithContentsOfFile:
+                    [self snapshotPathForReferenceID:configuration.playlistReferenceID]];
+        [self prefetchPlaylist];
+    }
+    
+    [self initializePluginWithToken:configuration.mediaApiToken
+                            baseUrl:configuration.mediaApiBaseURL
+                       drmServerUrl:configuration.drmServerURL];
     [[NSNotificationCenter defaultCenter] addObserver:self
                                              selector:@selector(refreshPlaylist)
                                                  name:BCWidevinePluginRefreshPlaylist
                                                object:nil];
-    [self refreshPlaylist];
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(configurationDidChange:)
+                                                 name:BCWidevineConfigurationDidChangeNotification
+                                               object:nil];
+    
+    // Show the playlist from the last launch right away; the plugin's request reconciles it.
+    if ([snapshot.videos count] > 0) {
+        [self showPlaylist:snapshot];
+    }
+    if (configuration.pagedSearchPageSize == 0) {
+        [self findPlaylistReplacing:([snapshot.videos count] > 0 ? snapshot : nil)];
+    }
 }
 
 - (void)refreshPlaylist
 {
-    NSString *path = [[NSBundle mainBundle] pathForResource:@"widevine" ofType:@"plist"];
-    NSDictionary *dictionary = [NSDictionary dictionaryWithContentsOfFile:path];
-    
     [self.widevinePlugin stop];
+    if ([BCWidevineConfiguration sharedConfiguration].pagedSearchPageSize > 0) {
+        [self loadPagedPlaylist];
+    } else {
+        self.pagedPlaylist = nil;
+        self.infoComponent.pagedPlaylist = nil;
+        [self findPlaylistReplacing:nil];
+    }
+}
+
+- (void)configurationDidChange:(NSNotification *)notification
+{
+    // The token or base url may have changed, so paged searches go through a new catalog from here on. The
+    // plugin keeps the ones it was created with for the playlist until the next launch.
+    BCWidevineConfiguration *configuration = notification.object;
+    [self applyAnalyticsBatchURL:configuration];
+    self.catalog = [[[BCCatalog alloc] initWithToken:configuration.mediaApiToken
+                                             baseURL:configuration.mediaApiBaseURL] autorelease];
+    [self refreshPlaylist];
+}
+
+/**
+ * Beacons are only batched when the configuration names a collector that takes batches.
+ */
+- (void)applyAnalyticsBatchURL:(BCWidevineConfiguration *)configuration
+{
+    NSString *batchURL = configuration.analyticsBatchURL;
+    [BCAnalyticsBatcher sharedBatcher].batchURL = batchURL ? [NSURL URLWithString:batchURL] : nil;
+}
+
+- (void)loadPagedPlaylist
+{
+    BCWidevineConfiguration *configuration = [BCWidevineConfiguration sharedConfiguration];
+    NSString *query = configuration.pagedSearchQuery;
+    
+    BCPagedPlaylist *playlist = [[BCPagedPlaylist alloc] initWithCatalog:self.catalog
+                                                                pageSize:configuration.pagedSearchPageSize
+                                                                 options:(query ? [NSDictionary dictionaryWithObject:query forKey:@"all"] : nil)];
+    self.pagedPlaylist = playlist;
+    [playlist release];
     
+    [[BCStartupTimeline sharedTimeline] beginPhase:@"catalogFetch"];
     __block ViewController *weakself = self;
-    [widevinePlugin findPlaylistByReferenceID:[dictionary objectForKey:@"iosPlaylistReferenceId"]
-                                      options:nil
-                                    callBlock:^(BCError *error, BCPlaylist *playlist) {
-                                        
-                                        if (playlist) {
-                                            if (!self.infoComponent) {
-                                                [weakself createInfoView];
-                                            }
-                                            BCVideo *firstVideo = [playlist.videos objectAtIndex:0];
-                                            [widevinePlugin queueVideo:firstVideo];
-                                            
-                                            [[NSNotificationCenter defaultCenter] postNotification:
-                                             [NSNotification notificationWithName:BCWidevinePluginDidRefreshPlaylist object:self]];
-                                        } else if (error) {
-                                            [weakself displayErrorAlert:error.description];
-                                        }
-                                    }];
-}
-
-- (void)initializePluginWithToken:(NSString *)token baseUrl:(NSString *)baseUrl
+    [playlist loadNextPageWithCompletionBlock:^(BCError *error, NSRange range) {
+        [[BCStartupTimeline sharedTimeline] endPhase:@"catalogFetch"];
+        if (playlist != weakself.pagedPlaylist) {
+            return;
+        }
+        if (error) {
+            [weakself displayErrorAlert:error.description];
+            return;
+        }
+        if (range.length == 0) {
+            return;
+        }
+        
+        // The plugin plays through the first page; the table pages through the rest.
+        NSMutableArray *videos = [NSMutableArray arrayWithCapacity:range.length];
+        for (NSUInteger index = range.location; index < NSMaxRange(range); index++) {
+            [videos addObject:[playlist videoAtIndex:index]];
+        }
+        if (!weakself.infoComponent) {
+            [weakself createInfoView];
+        }
+        weakself.infoComponent.pagedPlaylist = playlist;
+        [weakself showPlaylist:[BCPlaylist playlistWithVideos:videos]];
+    }];
+}
+
+/**
+ * Sends the playlist request before the plugin exists. The plugin's own request in findPlaylistReplacing:
+ * has the same query, so BCMediaRequestManager joins it to this one, or BCMediaResponseCache answers it,
+ * and the fetch overlaps plugin init rather than following it.
+ */
+- (void)prefetchPlaylist
+{
+    [[BCStartupTimeline sharedTimeline] beginPhase:@"catalogFetch"];
+    [self.catalog findPlaylistByReferenceID:[BCWidevineConfiguration sharedConfiguration].playlistReferenceID
+                                    options:nil
+                                  callBlock:^(BCError *error, BCPlaylist *playlist) {
+                                      [[BCStartupTimeline sharedTimeline] endPhase:@"catalogFetch"];
+                                  }];
+}
+
+- (void)findPlaylistReplacing:(BCPlaylist *)currentPlaylist
+{
+    NSString *referenceID = [BCWidevineConfiguration sharedConfiguration].playlistReferenceID;
+    
+    // The playlist is found through the plugin, which sets up its playback queue from the response.
+    __block ViewController *weakself = self;
+    [self.widevinePlugin findPlaylistByReferenceID:referenceID
+                                           options:nil
+                                         callBlock:^(BCError *error, BCPlaylist *playlist) {
+                                             if (playlist) {
+                                                 [BCPlaylistSnapshot writePlaylist:playlist
+                                                                            toFile:[weakself snapshotPathForReferenceID:referenceID]];
+
+                                                 if (currentPlaylist && [BCPlaylistSnapshot playlist:playlist hasSameContentAsPlaylist:currentPlaylist]) {
+                                                     // Nothing the table or the player use changed since the snapshot, so the
+                                                     // queued video is left alone. The fresh videos still replace the snapshot's,
+                                                     // which lack raw properties such as customFields.
+                                                     weakself.widevinePlugin.playlist = playlist;
+                                                 } else {
+                                                     if (currentPlaylist) {
+                                                         // A name, still or rendition URL changed, such as a WVM URL with a new
+                                                         // token, so the queued snapshot video is replaced by the fresh one.
+                                                         [weakself.widevinePlugin stop];
+                                                     }
+                                                     [weakself showPlaylist:playlist];
+                                                 }
+                                             } else if (error) {
+                                                 [weakself displayErrorAlert:error.description];
+                                             }
+                                         }];
+}
+
+- (void)showPlaylist:(BCPlaylist *)playlist
+{
+    self.widevinePlugin.playlist = playlist;
+    if (!self.infoComponent) {
+        [self createInfoView];
+    }
+    // An empty playlist leaves nothing to queue, but the table still shows it.
+    if ([playlist.videos count] > 0) {
+        BCVideo *firstVideo = [playlist.videos objectAtIndex:0];
+        [self.widevinePlugin queueVideo:firstVideo];
+        [[BCStartupTimeline sharedTimeline] finishWithMilestone:@"firstVideoQueued"];
+    }
+    
+    [[NSNotificationCenter defaultCenter] postNotification:
+     [NSNotification notificationWithName:BCWidevinePluginDidRefreshPlaylist object:self]];
+}
+
+- (NSString *)snapshotPathForReferenceID:(NSString *)referenceID
+{
+    NSString *cachesPath = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    return [cachesPath stringByAppendingPathComponent:[NSString stringWithFormat:@"%@.playlist", referenceID]];
+}
+
+- (void)initializePluginWithToken:(NSString *)token baseUrl:(NSString *)baseUrl drmServerUrl:(NSString *)drmServerUrl
 {
+    // Start the DNS, TCP and TLS setup for the first catalog call and the first license request
+    // now, so it overlaps plugin initialization instead of delaying playback.
+    [BCMediaService warmConnectionWithBaseURL:baseUrl];
+    if (drmServerUrl) {
+        [[BCConnectionWarmer sharedWarmer] warmConnectionToURL:[NSURL URLWithString:drmServerUrl]];
+    }
+    
+    BCStartupTimeline *timeline = [BCStartupTimeline sharedTimeline];
+    [timeline beginPhase:@"pluginInit"];
     self.widevinePlugin = [[BCWidevinePlugin alloc] initWithToken:token baseURL:baseUrl];
+    [timeline endPhase:@"pluginInit"];
+    if (self.widevinePlugin.widevineInitialized) {
+        [timeline markMilestone:@"widevineInitialized"];
+    }
     self.player = self.widevinePlugin.player;
     
+    [timeline beginPhase:@"playerView"];
     [self.view addSubview:self.player.view];
     self.eventEmitter = self.player.playbackEmitter;
 
@@ -122,6 +303,9 @@
                                                                                forKey:@"debug"]];
     self.logger = [[BCEventLogger alloc] initWithEventEmitter:self.eventEmitter];
     [self.logger setVerbose:NO];
+
+    self.qoeMonitor = [[[BCQoEMonitor alloc] initWithEventEmitter:self.eventEmitter] autorelease];
+    self.qoeMonitor.widevinePlugin = self.widevinePlugin;
     
     // First video will not auto-play, but subsequent videos will.
     __block ViewController *weakself = self;
@@ -129,14 +313,22 @@
         weakself.widevinePlugin.autoPlay = YES;
     }];
     
+    // Chapter events are indexed per asset for chapter scrubbing; see BCChapterIndex.
+    [self.eventEmitter on:BCEventWidevine callBlock:^(BCEvent *event) {
+        [BCChapterIndex handleWidevineEventDetails:event.details];
+    }];
+    
     [self.eventEmitter on:BCEventDidSetVideo callBlock:^(BCEvent *event) {
+        BCVideo *video = [event.details objectForKey:@"video"];
+        [BCChapterIndex setCurrentAssetID:[video.properties objectForKey:@"videoID"]];
         [[NSNotificationCenter defaultCenter] postNotification:
          [NSNotification notificationWithName:BCWidevinePluginDidSetVideo object:self userInfo:event.details]];
     }];
 
     UIView *controlsView = [[UIView alloc] initWithFrame:CGRectMake(0, 180, 320, 50)];
     [self.view addSubview:controlsView];
-    self.controlsComponent = [[BCUIControls alloc] initWithEventEmitter:self.eventEmitter andView:controlsView];
+    self.controlsComponent = [[BCSeekingControls alloc] initWithEventEmitter:self.eventEmitter andView:controlsView];
+    [timeline endPhase:@"playerView"];
 }
 
 - (BOOL)shouldAutorotate
@@ -8,6 +8,8 @@
 #import "BCQueuePlayer.h"
 #import "VideoViewCell.h"
 
+@class BCPagedPlaylist;
+
 @interface WidevineInfo : BCComponent<UIScrollViewDelegate,UITableViewDelegate,UITableViewDataSource>
 {
     UIView *widevineInfoView;
@@ -20,8 +22,26 @@
 
 @property(nonatomic, retain) BCWidevinePlugin *widevinePlugin;
 
+/**
+ * When set, the table lists the videos of this paged query instead of the plugin's
+ * playlist and loads more pages as the user scrolls.
+ */
+@property(nonatomic, retain) BCPagedPlaylist *pagedPlaylist;
+
 @property(assign,nonatomic) IBOutlet VideoViewCell *videoCell;
 
 @property(strong,nonatomic) IBOutlet UITableView *tableView;
 
+/**
+ * Number of calls to tableView:cellForRowAtIndexPath: and the main-thread time
+ * they took, in seconds.
+ */
+@property(nonatomic, readonly) NSUInteger cellForRowCount;
+@property(nonatomic, readonly) NSTimeInterval cellForRowTime;
+
+/**
+ * Returns the mean time of a call to tableView:cellForRowAtIndexPath:, in seconds.
+ */
+- (NSTimeInterval)averageCellForRowTime;
+
 @end
@@ -6,21 +6,71 @@
 //
 //
 
+#import <mach/mach_time.h>
+
 #import "WViPhoneAPI.h"
 #import "BCVideo.h"
 #import "BCEvent.h"
 #import "BCWidevinePlugin.h"
 #import "UIScrollView+SVPullToRefresh.h"
+#import "UIScrollView+SVInfiniteScrolling.h"
+#import "BCPagedPlaylist.h"
+#import "BCImageCache.h"
+#import "BCThroughputEstimator.h"
+#import "BCNetworkActivityScheduler.h"
+#import "BCTimeFormatter.h"
+#import "VideoRowModel.h"
 #import "Constants.h"
 
 #import "WidevineInfo.h"
 
+// Start loading the next page when a row this close to the end is displayed.
+#define WidevineInfoPrefetchRows 10
+
+// Used to tell how far ahead to prefetch on slow networks: the size of a row in a
+// Media API response, the round trip before it starts arriving, and how fast rows
+// go by when the user flicks through the table.
+#define WidevineInfoEstimatedBytesPerRow 2048
+#define WidevineInfoEstimatedPageLatency 0.5
+#define WidevineInfoScrolledRowsPerSecond 5
+
+// Longest time the stills of a newly loaded page wait to share a radio wake-up.
+#define WidevineInfoStillPrefetchDeadline 30
+
+/**
+ * Returns a monotonic time in seconds.
+ */
+static NSTimeInterval WidevineInfoNow(void)
+{
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    return (double)mach_absolute_time() * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+@interface WidevineInfo ()
+
+// Row models by row, as NSNumber. A model whose video is no longer the row's is rebuilt.
+@property (nonatomic, retain) NSMutableDictionary *rowModels;
+@property (nonatomic, readwrite) NSUInteger cellForRowCount;
+@property (nonatomic, readwrite) NSTimeInterval cellForRowTime;
+
+- (void)buildRowModelsInRange:(NSRange)range;
+- (void)pruneRowModels;
+
+@end
+
 @implementation WidevineInfo
 
 @synthesize widevinePlugin;
+@synthesize pagedPlaylist;
 @synthesize widevineInfoView;
 @synthesize videoCell = _videoCell;
 @synthesize tableView = _tableView;
+@synthesize rowModels;
+@synthesize cellForRowCount;
+@synthesize cellForRowTime;
 
 - (id)init
 {
@@ -35,6 +85,11 @@
         [[NSBundle mainBundle] loadNibNamed:@"WidevineInfo_iphone" owner:self options:nil];
         
         self.widevinePlugin = plugin;
+        self.rowModels = [NSMutableDictionary dictionary];
+        
+        // The table instantiates cells from the nib itself, once per reusable cell.
+        [self.tableView registerNib:[UINib nibWithNibName:@"VideoViewCell" bundle:nil]
+             forCellReuseIdentifier:[VideoViewCell reuseIdentifier]];
         
         [self.tableView addPullToRefreshWithActionHandler:^{
             [[NSNotificationCenter defaultCenter] postNotification:[NSNotification notificationWithName:BCWidevinePluginRefreshPlaylist
@@ -43,6 +98,12 @@
             [self.tableView.pullToRefreshView stopAnimating];
         }];
         
+        __block WidevineInfo *weakself = self;
+        [self.tableView addInfiniteScrollingWithActionHandler:^{
+            [weakself loadNextPage];
+        }];
+        self.tableView.showsInfiniteScrolling = NO;
+        
         NSNotificationCenter *nc = [NSNotificationCenter defaultCenter];
         [nc addObserver:self selector:@selector(reloadPlaylist) name:BCWidevinePluginDidRefreshPlaylist object:nil];
         [nc addObserver:self selector:@selector(selectVideo:) name:BCWidevinePluginDidSetVideo object:nil];
@@ -55,6 +116,8 @@
 {
     self.widevineInfoView = nil;
     self.widevinePlugin = nil;
+    self.pagedPlaylist = nil;
+    self.rowModels = nil;
     
     [[NSNotificationCenter defaultCenter] removeObserver:self];
     
@@ -63,8 +126,13 @@
 
 - (void)reloadPlaylist
 {
+    [self.rowModels removeAllObjects];
+    [self buildRowModelsInRange:NSMakeRange(0, [self tableView:self.tableView numberOfRowsInSection:0])];
+    
     [self.tableView reloadData];
     [self.tableView.pullToRefreshView stopAnimating];
+    [self.tableView.infiniteScrollingView stopAnimating];
+    self.tableView.showsInfiniteScrolling = [self.pagedPlaylist hasMorePages];
     
     [self.tableView selectRowAtIndexPath:[NSIndexPath indexPathForRow:0 inSection:0]
                                 animated:YES
@@ -74,12 +142,179 @@
 - (void)selectVideo:(NSNotification *)notification
 {
     BCVideo *video = [notification.userInfo objectForKey:@"video"];
-    NSUInteger row = [self.widevinePlugin.playlist.videos indexOfObject:video];
+    NSUInteger row = (self.pagedPlaylist ?
+                      [self.pagedPlaylist indexOfVideo:video] :
+                      [self.widevinePlugin.playlist.videos indexOfObject:video]);
+    if (row == NSNotFound) {
+        return;
+    }
     [self.tableView selectRowAtIndexPath:[NSIndexPath indexPathForRow:row inSection:0]
                                 animated:YES
                           scrollPosition:UITableViewScrollPositionMiddle];
 }
 
+#pragma mark - Paging
+
+- (BCVideo *)videoAtRow:(NSUInteger)row
+{
+    if (!self.pagedPlaylist) {
+        return [self.widevinePlugin.playlist.videos objectAtIndex:row];
+    }
+    
+    BCVideo *video = [self.pagedPlaylist videoAtIndex:row];
+    if (!video) {
+        // The row's page was evicted; reload it and redisplay whichever of its rows are still on screen.
+        BCPagedPlaylist *playlist = self.pagedPlaylist;
+        __block WidevineInfo *weakself = self;
+        [playlist loadPageContainingIndex:row completionBlock:^(BCError *error, NSRange range) {
+            if (error || playlist != weakself.pagedPlaylist) {
+                return;
+            }
+            NSMutableArray *indexPaths = [NSMutableArray array];
+            for (NSIndexPath *indexPath in [weakself.tableView indexPathsForVisibleRows]) {
+                if (NSLocationInRange(indexPath.row, range)) {
+                    [indexPaths addObject:indexPath];
+                }
+            }
+            [weakself.tableView reloadRowsAtIndexPaths:indexPaths withRowAnimation:UITableViewRowAnimationNone];
+        }];
+    }
+    
+    return video;
+}
+
+- (void)loadNextPage
+{
+    BCPagedPlaylist *playlist = self.pagedPlaylist;
+    __block WidevineInfo *weakself = self;
+    BOOL loading = [playlist loadNextPageWithCompletionBlock:^(BCError *error, NSRange range) {
+        if (playlist != weakself.pagedPlaylist) {
+            return;
+        }
+        [weakself.tableView.infiniteScrollingView stopAnimating];
+        
+        NSUInteger firstNewRow = [weakself.tableView numberOfRowsInSection:0];
+        if (!error && NSMaxRange(range) > firstNewRow) {
+            NSMutableArray *indexPaths = [NSMutableArray arrayWithCapacity:NSMaxRange(range) - firstNewRow];
+            for (NSUInteger row = firstNewRow; row < NSMaxRange(range); row++) {
+                [indexPaths addObject:[NSIndexPath indexPathForRow:row inSection:0]];
+            }
+            [weakself pruneRowModels];
+            [weakself buildRowModelsInRange:range];
+            [weakself.tableView insertRowsAtIndexPaths:indexPaths withRowAnimation:UITableViewRowAnimationNone];
+            [weakself prefetchStillsInRange:range];
+        }
+        weakself.tableView.showsInfiniteScrolling = [playlist hasMorePages];
+    }];
+    
+    if (!loading) {
+        [self.tableView.infiniteScrollingView stopAnimating];
+        self.tableView.showsInfiniteScrolling = [playlist hasMorePages];
+    }
+}
+
+/**
+ * Loads the stills of a page that was just added, with the next radio wake-up or
+ * within WidevineInfoStillPrefetchDeadline seconds, so they are ready when the
+ * user scrolls to them.
+ */
+- (void)prefetchStillsInRange:(NSRange)range
+{
+    NSMutableArray *urls = [NSMutableArray arrayWithCapacity:range.length];
+    for (NSUInteger index = range.location; index < NSMaxRange(range); index++) {
+        NSURL *url = [[self.pagedPlaylist videoAtIndex:index].properties objectForKey:@"videoStillURL"];
+        if (url) {
+            [urls addObject:url];
+        }
+    }
+    if ([urls count] == 0) {
+        return;
+    }
+    
+    [[BCNetworkActivityScheduler sharedScheduler] scheduleTaskNamed:@"stillPrefetch"
+                                                         afterDelay:0
+                                                           deadline:WidevineInfoStillPrefetchDeadline
+                                                              block:^{
+                                                                  for (NSURL *url in urls) {
+                                                                      [[BCImageCache stillImageCache] loadImageWithURL:url completionBlock:^(UIImage *image, NSURL *imageURL) {}];
+                                                                  }
+                                                              }];
+}
+
+#pragma mark - Row Models
+
+/**
+ * Builds the row models of the loaded videos in range off the main thread. Rows
+ * asked for before their models arrive build them on the spot.
+ */
+- (void)buildRowModelsInRange:(NSRange)range
+{
+    NSMutableArray *videos = [NSMutableArray arrayWithCapacity:range.length];
+    NSMutableArray *rows = [NSMutableArray arrayWithCapacity:range.length];
+    for (NSUInteger row = range.location; row < NSMaxRange(range); row++) {
+        BCVideo *video = (self.pagedPlaylist ?
+                          [self.pagedPlaylist videoAtIndex:row] :
+                          [self.widevinePlugin.playlist.videos objectAtIndex:row]);
+        if (video) {
+            [videos addObject:video];
+            [rows addObject:[NSNumber numberWithUnsignedInteger:row]];
+        }
+    }
+    if ([videos count] == 0) {
+        return;
+    }
+    
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        // The shared formatter is main-thread only, so the batch gets its own.
+        BCTimeFormatter *formatter = [[[BCTimeFormatter alloc] init] autorelease];
+        NSMutableArray *models = [NSMutableArray arrayWithCapacity:[videos count]];
+        for (BCVideo *video in videos) {
+            [models addObject:[VideoRowModel rowModelWithVideo:video formatter:formatter]];
+        }
+        
+        dispatch_async(dispatch_get_main_queue(), ^{
+            for (NSUInteger i = 0; i < [models count]; i++) {
+                NSNumber *row = [rows objectAtIndex:i];
+                if (![self.rowModels objectForKey:row]) {
+                    [self.rowModels setObject:[models objectAtIndex:i] forKey:row];
+                }
+            }
+        });
+    });
+}
+
+/**
+ * Drops the models of rows whose page was evicted, so they don't keep its videos alive.
+ */
+- (void)pruneRowModels
+{
+    if (!self.pagedPlaylist) {
+        return;
+    }
+    for (NSNumber *row in [self.rowModels allKeys]) {
+        VideoRowModel *model = [self.rowModels objectForKey:row];
+        if ([self.pagedPlaylist videoAtIndex:[row unsignedIntegerValue]] != model.video) {
+            [self.rowModels removeObjectForKey:row];
+        }
+    }
+}
+
+- (VideoRowModel *)rowModelForVideo:(BCVideo *)video atRow:(NSUInteger)row
+{
+    NSNumber *key = [NSNumber numberWithUnsignedInteger:row];
+    VideoRowModel *model = [self.rowModels objectForKey:key];
+    if (model.video != video) {
+        model = [VideoRowModel rowModelWithVideo:video formatter:[BCTimeFormatter sharedFormatter]];
+        [self.rowModels setObject:model forKey:key];
+    }
+    return model;
+}
+
+- (NSTimeInterval)averageCellForRowTime
+{
+    return self.cellForRowCount ? self.cellForRowTime / self.cellForRowCount : 0;
+}
+
 #pragma mark - UITableView Delegate
 
 - (NSInteger)numberOfSectionsInTableView:(UITableView *)tableView
@@ -89,6 +324,9 @@
 
 - (NSInteger)tableView:(UITableView *)tableView numberOfRowsInSection:(NSInteger)section
 {
+    if (self.pagedPlaylist) {
+        return self.pagedPlaylist.count;
+    }
     return [self.widevinePlugin.playlist.videos count];
 }
 
@@ -97,42 +335,74 @@
     return 80;
 }
 
+/**
+ * Returns how close to the end of the table the next page is requested, so that on
+ * slow networks it has time to arrive before the user scrolls there.
+ */
+- (NSUInteger)prefetchRows
+{
+    NSUInteger pageSize = self.pagedPlaylist.pageSize;
+    NSTimeInterval pageDuration = WidevineInfoEstimatedPageLatency +
+        [[BCThroughputEstimator sharedEstimator] estimatedDurationForBytes:pageSize * WidevineInfoEstimatedBytesPerRow];
+    NSUInteger rows = (NSUInteger)ceil(pageDuration * WidevineInfoScrolledRowsPerSecond);
+    return MAX(WidevineInfoPrefetchRows, MIN(rows, pageSize));
+}
+
 - (UITableViewCell *)tableView:(UITableView *)tableView cellForRowAtIndexPath:(NSIndexPath *)indexPath
 {
-	// Try to retrieve from the table view a now-unused cell with the given identifier.
-	VideoViewCell *cell = (VideoViewCell *)[tableView dequeueReusableCellWithIdentifier:[VideoViewCell reuseIdentifier]];
-	
-	// If no cell is available, create a new one using the given identifier.
-	if (cell == nil) {
-        [[NSBundle mainBundle] loadNibNamed:@"VideoViewCell" owner:self options:nil];
-        cell = _videoCell;
-        _videoCell = nil;
-	}
-	
-	// Set up the cell.
-	BCVideo *video = [self.widevinePlugin.playlist.videos objectAtIndex:indexPath.row];
-    NSURL *stillUrl = [video.properties objectForKey:@"videoStillURL"];
-    NSData *imageData = [NSData dataWithContentsOfURL:stillUrl];
-    cell.videoStill.image = [UIImage imageWithData:imageData];
-	cell.videoNameLabel.text = [video.properties objectForKey:@"name"];
-    cell.durationLabel.text = [self hmsForDuration:[video.properties objectForKey:@"duration"]];
-	
-	return cell;
+    NSTimeInterval start = WidevineInfoNow();
+    VideoViewCell *cell = [self videoCellForRowAtIndexPath:indexPath];
+    self.cellForRowTime += WidevineInfoNow() - start;
+    self.cellForRowCount++;
+    return cell;
 }
 
-- (NSString *)hmsForDuration:(NSNumber *)duration
+- (VideoViewCell *)videoCellForRowAtIndexPath:(NSIndexPath *)indexPath
 {
-    unsigned long seconds = duration.unsignedLongValue / 1000;
-    NSUInteger h = seconds / 3600;
-    NSUInteger m = (seconds / 60) % 60;
-    NSUInteger s = (seconds % 60);
+	// The registered nib makes a new cell when there is no unused one.
+	VideoViewCell *cell = (VideoViewCell *)[self.tableView dequeueReusableCellWithIdentifier:[VideoViewCell reuseIdentifier]];
+	
+	// Fetch the next page before the user reaches the end of the table.
+    if (self.pagedPlaylist &&
+        indexPath.row + [self prefetchRows] >= self.pagedPlaylist.count &&
+        [self.pagedPlaylist hasMorePages] &&
+        self.tableView.infiniteScrollingView.state == SVInfiniteScrollingStateStopped) {
+        [self.tableView triggerInfiniteScrolling];
+    }
     
-    return [NSString stringWithFormat:@"%u:%02u:%02u", h, m, s];
+	// Set up the cell.
+	BCVideo *video = [self videoAtRow:indexPath.row];
+    if (!video) {
+        cell.videoStill.image = nil;
+        cell.videoNameLabel.text = nil;
+        cell.durationLabel.text = nil;
+        return cell;
+    }
+    VideoRowModel *model = [self rowModelForVideo:video atRow:indexPath.row];
+    [cell configureWithRowModel:model];
+    
+    NSURL *stillUrl = model.stillURL;
+    cell.videoStill.image = [[BCImageCache stillImageCache] imageForURL:stillUrl];
+    if (!cell.videoStill.image && stillUrl) {
+        __block WidevineInfo *weakself = self;
+        [[BCImageCache stillImageCache] loadImageWithURL:stillUrl completionBlock:^(UIImage *image, NSURL *url) {
+            // The cell may have been reused for another row by now.
+            VideoViewCell *visibleCell = (VideoViewCell *)[weakself.tableView cellForRowAtIndexPath:indexPath];
+            if (visibleCell && [weakself videoAtRow:indexPath.row] == video) {
+                visibleCell.videoStill.image = image;
+            }
+        }];
+    }
+	
+	return cell;
 }
 
 - (void)tableView:(UITableView *)tableView didSelectRowAtIndexPath:(NSIndexPath *)indexPath
 {
-    BCVideo *video = [self.widevinePlugin.playlist.videos objectAtIndex:indexPath.row];
+    BCVideo *video = [self videoAtRow:indexPath.row];
+    if (!video) {
+        return;
+    }
     
     self.widevinePlugin.autoPlay = YES;
     [self.widevinePlugin queueVideo:video];
@@ -0,0 +1,443 @@
+//
+//  BCAnalyticsBatcher.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <UIKit/UIKit.h>
+#import <zlib.h>
+
+#import "BCAnalyticsBatcher.h"
+#import "BCJSONReader.h"
+#import "BCJSONWriter.h"
+#import "BCNetworkActivityScheduler.h"
+
+#define BCAnalyticsBatcherDefaultBeaconHost @"metrics.brightcove.com"
+#define BCAnalyticsBatcherDefaultMaxBatchCount 50
+#define BCAnalyticsBatcherDefaultMaxBatchBytes (32 * 1024)
+#define BCAnalyticsBatcherDefaultFlushInterval 60
+#define BCAnalyticsBatcherDefaultMaxStoredBatches 100
+#define BCAnalyticsBatcherDefaultMaxStoredBytes (1024 * 1024)
+#define BCAnalyticsBatcherDefaultMaxBatchAge (7 * 24 * 60 * 60)
+#define BCAnalyticsBatcherDirectoryName @"BCAnalyticsBatches"
+#define BCAnalyticsBatcherFileExtension @"json.gz"
+
+#define BCHTTPStatusNoContent 204
+#define BCHTTPStatusRequestTimeout 408
+#define BCHTTPStatusTooManyRequests 429
+
+// Marks the requests the batcher sends itself, so they aren't intercepted again.
+static NSString *const BCAnalyticsBatcherRequestProperty = @"BCAnalyticsBatcherRequest";
+
+/**
+ * Returns data compressed in gzip format, or nil on failure.
+ */
+static NSData *BCGzipData(NSData *data)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // 15 window bits, plus 16 for a gzip header.
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return nil;
+    }
+
+    NSMutableData *compressed = [NSMutableData dataWithLength:deflateBound(&stream, [data length])];
+    stream.next_in = (Bytef *)[data bytes];
+    stream.avail_in = (uInt)[data length];
+    stream.next_out = [compressed mutableBytes];
+    stream.avail_out = (uInt)[compressed length];
+
+    int status = deflate(&stream, Z_FINISH);
+    [compressed setLength:stream.total_out];
+    deflateEnd(&stream);
+
+    return status == Z_STREAM_END ? compressed : nil;
+}
+
+/**
+ * Returns gzip data decompressed, or nil if it is corrupt.
+ */
+static NSData *BCGunzipData(NSData *data)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+        return nil;
+    }
+
+    NSMutableData *decompressed = [NSMutableData dataWithLength:[data length] * 4];
+    stream.next_in = (Bytef *)[data bytes];
+    stream.avail_in = (uInt)[data length];
+
+    int status = Z_OK;
+    while (status == Z_OK) {
+        if (stream.total_out >= [decompressed length]) {
+            [decompressed setLength:[decompressed length] * 2];
+        }
+        stream.next_out = (Bytef *)[decompressed mutableBytes] + stream.total_out;
+        stream.avail_out = (uInt)([decompressed length] - stream.total_out);
+        status = inflate(&stream, Z_NO_FLUSH);
+    }
+    [decompressed setLength:stream.total_out];
+    inflateEnd(&stream);
+
+    return status == Z_STREAM_END ? decompressed : nil;
+}
+
+/**
+ * Answers beacon requests locally and hands their URLs to the shared batcher.
+ */
+@interface BCAnalyticsBeaconProtocol : NSURLProtocol
+@end
+
+@implementation BCAnalyticsBeaconProtocol
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request
+{
+    // Called on the loading thread; beaconHosts and batchURL are atomic and never mutated in place.
+    BCAnalyticsBatcher *batcher = [BCAnalyticsBatcher sharedBatcher];
+    return batcher.batchURL != nil &&
+        [[[request URL] host] length] > 0 &&
+        [batcher.beaconHosts containsObject:[[[request URL] host] lowercaseString]] &&
+        [[request HTTPMethod] isEqualToString:@"GET"] &&
+        ![NSURLProtocol propertyForKey:BCAnalyticsBatcherRequestProperty inRequest:request];
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request
+{
+    return request;
+}
+
+- (void)startLoading
+{
+    NSURL *url = [[self.request URL] retain];
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [[BCAnalyticsBatcher sharedBatcher] addBeaconWithURL:url];
+        [url release];
+    });
+
+    NSHTTPURLResponse *response = [[NSHTTPURLResponse alloc] initWithURL:[self.request URL]
+                                                              statusCode:BCHTTPStatusNoContent
+                                                             HTTPVersion:@"HTTP/1.1"
+                                                            headerFields:nil];
+    [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    [self.client URLProtocolDidFinishLoading:self];
+    [response release];
+}
+
+- (void)stopLoading
+{
+}
+
+@end
+
+@interface BCAnalyticsBatcher ()
+
+@property (nonatomic, retain) NSMutableArray *beacons;
+@property (nonatomic) NSUInteger beaconBytes;
+@property (nonatomic, retain) NSMutableArray *batchPaths;
+@property (nonatomic, retain) id flushTask;
+@property (nonatomic) BOOL sending;
+@property (nonatomic) BOOL installed;
+@property (nonatomic, readwrite) NSUInteger beaconCount;
+@property (nonatomic, readwrite) NSUInteger requestCount;
+@property (nonatomic, readwrite) NSUInteger droppedBatchCount;
+@property (nonatomic, readwrite) unsigned long long uncompressedBytes;
+@property (nonatomic, readwrite) unsigned long long compressedBytes;
+
+@end
+
+@implementation BCAnalyticsBatcher
+
+@synthesize beaconHosts;
+@synthesize batchURL;
+@synthesize maxBatchCount;
+@synthesize maxBatchBytes;
+@synthesize flushInterval;
+@synthesize maxStoredBatches;
+@synthesize maxStoredBytes;
+@synthesize maxBatchAge;
+@synthesize beacons;
+@synthesize beaconBytes;
+@synthesize batchPaths;
+@synthesize flushTask;
+@synthesize sending;
+@synthesize installed;
+@synthesize beaconCount;
+@synthesize requestCount;
+@synthesize droppedBatchCount;
+@synthesize uncompressedBytes;
+@synthesize compressedBytes;
+
++ (BCAnalyticsBatcher *)sharedBatcher
+{
+    static BCAnalyticsBatcher *sharedBatcher = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedBatcher = [[BCAnalyticsBatcher alloc] init];
+    });
+    return sharedBatcher;
+}
+
++ (NSString *)batchDirectory
+{
+    NSString *cachesPath = [NSSearchPathForDirectoriesInDomains(NSCachesDirectory, NSUserDomainMask, YES) objectAtIndex:0];
+    return [cachesPath stringByAppendingPathComponent:BCAnalyticsBatcherDirectoryName];
+}
+
+- (id)init
+{
+    if (self = [super init]) {
+        self.beaconHosts = [NSSet setWithObject:BCAnalyticsBatcherDefaultBeaconHost];
+        self.maxBatchCount = BCAnalyticsBatcherDefaultMaxBatchCount;
+        self.maxBatchBytes = BCAnalyticsBatcherDefaultMaxBatchBytes;
+        self.flushInterval = BCAnalyticsBatcherDefaultFlushInterval;
+        self.maxStoredBatches = BCAnalyticsBatcherDefaultMaxStoredBatches;
+        self.maxStoredBytes = BCAnalyticsBatcherDefaultMaxStoredBytes;
+        self.maxBatchAge = BCAnalyticsBatcherDefaultMaxBatchAge;
+        self.beacons = [NSMutableArray array];
+        self.batchPaths = [NSMutableArray array];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    [[BCNetworkActivityScheduler sharedScheduler] cancelTask:self.flushTask];
+
+    self.beaconHosts = nil;
+    self.batchURL = nil;
+    self.beacons = nil;
+    self.batchPaths = nil;
+    self.flushTask = nil;
+
+    [super dealloc];
+}
+
+- (void)install
+{
+    if (self.installed) {
+        return;
+    }
+    self.installed = YES;
+
+    NSString *directory = [BCAnalyticsBatcher batchDirectory];
+    [[NSFileManager defaultManager] createDirectoryAtPath:directory withIntermediateDirectories:YES attributes:nil error:NULL];
+
+    // File names start with the time they were sealed, so sorting them sends the oldest first.
+    NSArray *names = [[[NSFileManager defaultManager] contentsOfDirectoryAtPath:directory error:NULL]
+                      sortedArrayUsingSelector:@selector(compare:)];
+    for (NSString *name in names) {
+        if ([name hasSuffix:BCAnalyticsBatcherFileExtension]) {
+            [self.batchPaths addObject:[directory stringByAppendingPathComponent:name]];
+        }
+    }
+    [self pruneBatches];
+
+    [NSURLProtocol registerClass:[BCAnalyticsBeaconProtocol class]];
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(flush)
+                                                 name:UIApplicationDidEnterBackgroundNotification
+                                               object:nil];
+}
+
+- (void)addBeaconWithURL:(NSURL *)url
+{
+    NSString *urlString = [url absoluteString];
+    long long time = (long long)([[NSDate date] timeIntervalSince1970] * 1000);
+    [self.beacons addObject:[NSDictionary dictionaryWithObjectsAndKeys:
+                             urlString, @"url",
+                             [NSNumber numberWithLongLong:time], @"time",
+                             nil]];
+    self.beaconBytes += [urlString length];
+    self.beaconCount++;
+
+    if ([self.beacons count] >= self.maxBatchCount || self.beaconBytes >= self.maxBatchBytes) {
+        [self flush];
+    } else if (!self.flushTask) {
+        // The batch may go out with any earlier wake-up, and must by flushInterval.
+        __block BCAnalyticsBatcher *weakself = self;
+        self.flushTask = [[BCNetworkActivityScheduler sharedScheduler] scheduleTaskNamed:@"analyticsFlush"
+                                                                              afterDelay:0
+                                                                                deadline:self.flushInterval
+                                                                                   block:^{
+                                                                                       [weakself flush];
+                                                                                   }];
+    }
+}
+
+- (void)flush
+{
+    [self sealBatch];
+    [self sendNextBatch];
+}
+
+- (void)networkWasUsed
+{
+    if ([self.beacons count] > 0 || [self.batchPaths count] > 0) {
+        [self flush];
+    }
+}
+
+#pragma mark - Batches
+
+/**
+ * Writes the beacons collected so far to a batch file.
+ */
+- (void)sealBatch
+{
+    [[BCNetworkActivityScheduler sharedScheduler] cancelTask:self.flushTask];
+    self.flushTask = nil;
+
+    if ([self.beacons count] == 0) {
+        return;
+    }
+
+    NSString *name = [NSString stringWithFormat:@"%013lld-%08x.%@",
+                      (long long)([[NSDate date] timeIntervalSince1970] * 1000), arc4random(), BCAnalyticsBatcherFileExtension];
+    NSString *path = [[BCAnalyticsBatcher batchDirectory] stringByAppendingPathComponent:name];
+    if ([self writeBatchWithBeacons:self.beacons toFile:path]) {
+        [self.batchPaths addObject:path];
+        [self pruneBatches];
+    }
+
+    [self.beacons removeAllObjects];
+    self.beaconBytes = 0;
+}
+
+/**
+ * Drops batches past maxBatchAge, then the oldest until the rest fit within
+ * maxStoredBatches and maxStoredBytes.
+ */
+- (void)pruneBatches
+{
+    NSFileManager *fileManager = [NSFileManager defaultManager];
+    long long now = (long long)([[NSDate date] timeIntervalSince1970] * 1000);
+    long long oldest = now - (long long)(self.maxBatchAge * 1000);
+
+    NSMutableArray *sizes = [NSMutableArray arrayWithCapacity:[self.batchPaths count]];
+    unsigned long long totalBytes = 0;
+    for (NSString *path in [[self.batchPaths copy] autorelease]) {
+        // The name starts with the time the batch was sealed.
+        long long sealed = [[path lastPathComponent] longLongValue];
+        if (sealed < oldest) {
+            [self dropBatchAtPath:path];
+            continue;
+        }
+        unsigned long long size = [[fileManager attributesOfItemAtPath:path error:NULL] fileSize];
+        [sizes addObject:[NSNumber numberWithUnsignedLongLong:size]];
+        totalBytes += size;
+    }
+
+    while ([self.batchPaths count] > 0 &&
+           ([self.batchPaths count] > self.maxStoredBatches || totalBytes > self.maxStoredBytes)) {
+        totalBytes -= [[sizes objectAtIndex:0] unsignedLongLongValue];
+        [sizes removeObjectAtIndex:0];
+        [self dropBatchAtPath:[self.batchPaths objectAtIndex:0]];
+    }
+}
+
+- (void)dropBatchAtPath:(NSString *)path
+{
+    self.droppedBatchCount++;
+    [self removeBatchAtPath:path];
+}
+
+- (BOOL)writeBatchWithBeacons:(NSArray *)batchBeacons toFile:(NSString *)path
+{
+    BCJSONWriter *writer = [[BCJSONWriter alloc] init];
+    [writer beginObject];
+    [writer writeKey:@"beacons"];
+    [writer writeObject:batchBeacons];
+    [writer endObject];
+    NSData *json = [writer.data retain];
+    [writer release];
+
+    NSData *compressed = BCGzipData(json);
+    self.uncompressedBytes += [json length];
+    self.compressedBytes += [compressed length];
+    [json release];
+
+    if (![compressed writeToFile:path atomically:YES]) {
+        NSLog(@"%s Could not write analytics batch to %@", __PRETTY_FUNCTION__, path);
+        return NO;
+    }
+    return YES;
+}
+
+/**
+ * Returns a request the beacon protocol lets through.
+ */
+- (NSMutableURLRequest *)batcherRequestWithURL:(NSURL *)url
+{
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:url];
+    [NSURLProtocol setProperty:[NSNumber numberWithBool:YES] forKey:BCAnalyticsBatcherRequestProperty inRequest:request];
+    return request;
+}
+
+- (void)sendNextBatch
+{
+    NSURL *url = self.batchURL;
+    if (self.sending || !url || [self.batchPaths count] == 0) {
+        return;
+    }
+
+    NSString *path = [self.batchPaths objectAtIndex:0];
+    NSData *compressed = [NSData dataWithContentsOfFile:path];
+    NSData *json = compressed ? BCGunzipData(compressed) : nil;
+    id batch = json ? [[BCJSONReader readerForCurrentThread] objectWithData:json error:NULL] : nil;
+    NSArray *batchBeacons = [batch isKindOfClass:[NSDictionary class]] ? [batch objectForKey:@"beacons"] : nil;
+    if (![batchBeacons isKindOfClass:[NSArray class]]) {
+        // Unreadable; there is nothing to send.
+        [self dropBatchAtPath:path];
+        [self sendNextBatch];
+        return;
+    }
+
+    self.sending = YES;
+    [self postBatch:compressed toURL:url path:path];
+}
+
+- (void)removeBatchAtPath:(NSString *)path
+{
+    [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+    [self.batchPaths removeObject:path];
+}
+
+- (void)postBatch:(NSData *)compressed toURL:(NSURL *)url path:(NSString *)path
+{
+    NSMutableURLRequest *request = [self batcherRequestWithURL:url];
+    [request setHTTPMethod:@"POST"];
+    [request setHTTPBody:compressed];
+    [request setValue:@"application/json" forHTTPHeaderField:@"Content-Type"];
+    [request setValue:@"gzip" forHTTPHeaderField:@"Content-Encoding"];
+    self.requestCount++;
+
+    __block BCAnalyticsBatcher *weakself = self;
+    [NSURLConnection sendAsynchronousRequest:request
+                                       queue:[NSOperationQueue mainQueue]
+                           completionHandler:^(NSURLResponse *response, NSData *data, NSError *error) {
+                               weakself.sending = NO;
+                               NSInteger statusCode = [response isKindOfClass:[NSHTTPURLResponse class]] ?
+                                   [(NSHTTPURLResponse *)response statusCode] : 0;
+                               if (statusCode >= 200 && statusCode < 300) {
+                                   [weakself removeBatchAtPath:path];
+                               } else if (statusCode >= 400 && statusCode < 500 &&
+                                          statusCode != BCHTTPStatusRequestTimeout &&
+                                          statusCode != BCHTTPStatusTooManyRequests) {
+                                   // The collector won't take this batch; retrying would block every later one.
+                                   NSLog(@"%s Dropping analytics batch rejected with status %d", __PRETTY_FUNCTION__, (int)statusCode);
+                                   [weakself dropBatchAtPath:path];
+                               } else {
+                                   // A network error, or a status worth retrying: keep the batch for the next flush.
+                                   return;
+                               }
+                               [weakself sendNextBatch];
+                           }];
+}
+
+@end
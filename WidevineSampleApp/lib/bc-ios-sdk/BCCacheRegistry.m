@@ -0,0 +1,153 @@
+//
+//  BCCacheRegistry.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <UIKit/UIKit.h>
+
+#import "BCCacheRegistry.h"
+
+#define BCCacheRegistryDefaultCostLimit (24 * 1024 * 1024)
+#define BCCacheRegistryDefaultMemoryWarningCostLimit (4 * 1024 * 1024)
+
+@interface BCCacheRegistry ()
+{
+    // Not retained; caches unregister themselves in dealloc.
+    CFMutableArrayRef caches;
+    BOOL trimming;
+}
+
+@end
+
+@implementation BCCacheRegistry
+
+@synthesize costLimit;
+@synthesize memoryWarningCostLimit;
+
++ (BCCacheRegistry *)sharedRegistry
+{
+    static BCCacheRegistry *sharedRegistry = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedRegistry = [[BCCacheRegistry alloc] init];
+    });
+    return sharedRegistry;
+}
+
+- (id)init
+{
+    if (self = [super init]) {
+        caches = CFArrayCreateMutable(NULL, 0, NULL);
+        self.costLimit = BCCacheRegistryDefaultCostLimit;
+        self.memoryWarningCostLimit = BCCacheRegistryDefaultMemoryWarningCostLimit;
+
+        [[NSNotificationCenter defaultCenter] addObserver:self
+                                                 selector:@selector(didReceiveMemoryWarning)
+                                                     name:UIApplicationDidReceiveMemoryWarningNotification
+                                                   object:nil];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    CFRelease(caches);
+
+    [super dealloc];
+}
+
+- (void)registerCache:(id<BCRegisteredCache>)cache
+{
+    if (!CFArrayContainsValue(caches, CFRangeMake(0, CFArrayGetCount(caches)), cache)) {
+        CFArrayAppendValue(caches, cache);
+    }
+}
+
+- (void)unregisterCache:(id<BCRegisteredCache>)cache
+{
+    CFIndex index = CFArrayGetFirstIndexOfValue(caches, CFRangeMake(0, CFArrayGetCount(caches)), cache);
+    if (index != kCFNotFound) {
+        CFArrayRemoveValueAtIndex(caches, index);
+    }
+}
+
+- (void)cacheDidGrow:(id<BCRegisteredCache>)cache
+{
+    if (!trimming && self.totalCost > self.costLimit) {
+        [self trimToCost:self.costLimit];
+    }
+}
+
+- (void)didReceiveMemoryWarning
+{
+    unsigned long long before = self.totalCost;
+    [self trimToCost:self.memoryWarningCostLimit];
+    NSLog(@"%s Trimmed caches from %llu to %llu bytes", __PRETTY_FUNCTION__, before, self.totalCost);
+}
+
+- (void)trimToCost:(unsigned long long)cost
+{
+    // Trimming may release objects whose caches unregister, so work on a copy.
+    NSArray *registered = [NSArray arrayWithArray:(NSArray *)caches];
+    trimming = YES;
+
+    for (BCCacheTier tier = 0; tier < BCCacheTierCount; tier++) {
+        unsigned long long total = self.totalCost;
+        if (total <= cost) {
+            break;
+        }
+
+        for (id<BCRegisteredCache> cache in registered) {
+            if ([cache cacheTier] != tier) {
+                continue;
+            }
+            unsigned long long cacheCost = [cache cacheCost];
+            unsigned long long excess = total - cost;
+            [cache trimToCost:(cacheCost > excess ? cacheCost - excess : 0)];
+
+            total = total - cacheCost + [cache cacheCost];
+            if (total <= cost) {
+                break;
+            }
+        }
+    }
+
+    trimming = NO;
+}
+
+- (unsigned long long)costOfTier:(BCCacheTier)tier
+{
+    unsigned long long cost = 0;
+    for (id<BCRegisteredCache> cache in (NSArray *)caches) {
+        if ([cache cacheTier] == tier) {
+            cost += [cache cacheCost];
+        }
+    }
+    return cost;
+}
+
+- (unsigned long long)totalCost
+{
+    unsigned long long cost = 0;
+    for (id<BCRegisteredCache> cache in (NSArray *)caches) {
+        cost += [cache cacheCost];
+    }
+    return cost;
+}
+
+- (NSDictionary *)costsByCacheName
+{
+    NSMutableDictionary *costs = [NSMutableDictionary dictionary];
+    for (id<BCRegisteredCache> cache in (NSArray *)caches) {
+        unsigned long long cost = [[costs objectForKey:[cache cacheName]] unsignedLongLongValue] + [cache cacheCost];
+        [costs setObject:[NSNumber numberWithUnsignedLongLong:cost] forKey:[cache cacheName]];
+    }
+    return costs;
+}
+
+@end
@@ -0,0 +1,227 @@
+//
+//  BCCatalog+Widevine.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCCatalog+Widevine.h"
+#import "BCMediaService+Widevine.h"
+#import "BCMediaResponseCache.h"
+#import "BCPlaylist.h"
+#import "BCVideo.h"
+
+// The Media API returns at most 50 videos per find_videos_by_* call.
+#define BCCatalogMaxIDsPerRequest 50
+
+// Conservative limit for request URLs, including the token.
+#define BCCatalogMaxURLLength 2000
+
+@implementation BCCatalog (Widevine)
+
+- (void)findVideosByIDs:(NSArray *)videoIDs options:(NSDictionary *)options callBlock:(BCVideoListResponseBlock)responseBlock
+{
+    [self findVideosWithCommand:@"find_videos_by_ids"
+                        idsName:@"video_ids"
+                    propertyKey:@"videoID"
+                            ids:videoIDs
+                        options:options
+                      callBlock:responseBlock];
+}
+
+- (void)findVideosByReferenceIDs:(NSArray *)referenceIDs options:(NSDictionary *)options callBlock:(BCVideoListResponseBlock)responseBlock
+{
+    [self findVideosWithCommand:@"find_videos_by_reference_ids"
+                        idsName:@"reference_ids"
+                    propertyKey:@"referenceID"
+                            ids:referenceIDs
+                        options:options
+                      callBlock:responseBlock];
+}
+
+- (void)findVideoPage:(NSUInteger)pageNumber pageSize:(NSUInteger)pageSize options:(NSDictionary *)options callBlock:(BCPlaylistResponseBlock)responseBlock
+{
+    BCPlaylistResponseBlock block = [[responseBlock copy] autorelease];
+
+    NSMutableDictionary *params = [NSMutableDictionary dictionaryWithObject:@"search_videos" forKey:@"command"];
+    [params addEntriesFromDictionary:options];
+    [params setObject:[NSNumber numberWithUnsignedInteger:pageNumber] forKey:@"page_number"];
+    [params setObject:[NSNumber numberWithUnsignedInteger:pageSize] forKey:@"page_size"];
+    [params setObject:@"true" forKey:@"get_item_count"];
+
+    [self.mediaService sendRequestWithParams:params responseBlock:^(BCError *error, id json, BCMediaResponseCacheEntry *entry) {
+        if (error) {
+            block(error, nil);
+            return;
+        }
+
+        if (!entry.object) {
+            entry.object = [self videoPageWithJSON:json pageNumber:pageNumber pageSize:pageSize];
+        }
+        block(nil, entry.object);
+    }];
+}
+
+- (BCPlaylist *)videoPageWithJSON:(NSDictionary *)json pageNumber:(NSUInteger)pageNumber pageSize:(NSUInteger)pageSize
+{
+    NSArray *items = [json objectForKey:@"items"];
+    NSMutableArray *videos = [NSMutableArray arrayWithCapacity:pageSize];
+    if ([items isKindOfClass:[NSArray class]]) {
+        for (id item in items) {
+            if ([item isKindOfClass:[NSDictionary class]]) {
+                [videos addObject:[self.mediaService makeVideoWithJSON:item]];
+            }
+        }
+    }
+
+    NSMutableDictionary *properties = [NSMutableDictionary dictionaryWithCapacity:3];
+    [properties setObject:[NSNumber numberWithUnsignedInteger:pageNumber] forKey:@"pageNumber"];
+    [properties setObject:[NSNumber numberWithUnsignedInteger:pageSize] forKey:@"pageSize"];
+
+    // total_count is -1 when the Media API did not count the results.
+    id totalCount = [json objectForKey:@"total_count"];
+    if ([totalCount isKindOfClass:[NSNumber class]] && [totalCount integerValue] >= 0) {
+        [properties setObject:totalCount forKey:@"totalCount"];
+    }
+
+    return [BCPlaylist playlistWithVideos:videos properties:properties];
+}
+
+- (void)findVideosWithCommand:(NSString *)command
+                      idsName:(NSString *)idsName
+                  propertyKey:(NSString *)propertyKey
+                          ids:(NSArray *)ids
+                      options:(NSDictionary *)options
+                    callBlock:(BCVideoListResponseBlock)responseBlock
+{
+    BCVideoListResponseBlock block = [[responseBlock copy] autorelease];
+
+    NSMutableArray *requestedIDs = [NSMutableArray arrayWithCapacity:[ids count]];
+    for (id requestedID in ids) {
+        [requestedIDs addObject:[requestedID description]];
+    }
+
+    NSArray *chunks = [self chunksForIDs:requestedIDs command:command idsName:idsName options:options];
+    if ([chunks count] == 0) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            block(nil, [NSArray array]);
+        });
+        return;
+    }
+
+    NSMutableDictionary *videosByID = [NSMutableDictionary dictionaryWithCapacity:[requestedIDs count]];
+    NSMutableDictionary *errors = [NSMutableDictionary dictionary];
+    __block NSUInteger remainingChunks = [chunks count];
+
+    for (NSArray *chunk in chunks) {
+        NSDictionary *params = [self paramsForIDs:chunk command:command idsName:idsName options:options];
+        [self.mediaService sendRequestWithParams:params responseBlock:^(BCError *error, id json, BCMediaResponseCacheEntry *entry) {
+            if (!error) {
+                // Keep the videos with the response so a repeated or coalesced lookup reuses them.
+                if (!entry.object) {
+                    entry.object = [self videosByIDWithJSON:json propertyKey:propertyKey requestedIDs:chunk];
+                }
+                [videosByID addEntriesFromDictionary:entry.object];
+            }
+
+            for (NSString *requestedID in chunk) {
+                if (![videosByID objectForKey:requestedID]) {
+                    NSString *message = [NSString stringWithFormat:@"No video was found for %@.", requestedID];
+                    [errors setObject:(error ? error : [BCError errorWithCode:BCErrorCodeCatalogRequestError message:message])
+                               forKey:requestedID];
+                }
+            }
+
+            if (--remainingChunks > 0) {
+                return;
+            }
+
+            NSMutableArray *videos = [NSMutableArray arrayWithCapacity:[requestedIDs count]];
+            for (NSString *requestedID in requestedIDs) {
+                BCVideo *video = [videosByID objectForKey:requestedID];
+                [videos addObject:(video ? (id)video : [NSNull null])];
+            }
+            block([errors count] > 0 ? errors : nil, videos);
+        }];
+    }
+}
+
+- (NSDictionary *)paramsForIDs:(NSArray *)ids command:(NSString *)command idsName:(NSString *)idsName options:(NSDictionary *)options
+{
+    NSMutableDictionary *params = [NSMutableDictionary dictionaryWithDictionary:options];
+    [params setObject:command forKey:@"command"];
+    [params setObject:[ids componentsJoinedByString:@","] forKey:idsName];
+    return params;
+}
+
+/**
+ * Splits ids into chunks whose request URLs fit within the Media API's limits.
+ * Duplicates are dropped; the first occurrence decides the order.
+ */
+- (NSArray *)chunksForIDs:(NSArray *)ids command:(NSString *)command idsName:(NSString *)idsName options:(NSDictionary *)options
+{
+    NSMutableArray *chunks = [NSMutableArray array];
+    NSMutableArray *chunk = [NSMutableArray arrayWithCapacity:BCCatalogMaxIDsPerRequest];
+    NSMutableSet *seenIDs = [NSMutableSet setWithCapacity:[ids count]];
+
+    for (NSString *requestedID in ids) {
+        if ([seenIDs containsObject:requestedID]) {
+            continue;
+        }
+        [seenIDs addObject:requestedID];
+
+        [chunk addObject:requestedID];
+        if ([chunk count] == 1) {
+            // A single ID always gets a request, however long it is.
+            continue;
+        }
+
+        NSDictionary *params = [self paramsForIDs:chunk command:command idsName:idsName options:options];
+        NSUInteger length = [[[[self.mediaService requestWithParams:params] URL] absoluteString] length];
+        if ([chunk count] > BCCatalogMaxIDsPerRequest || length > BCCatalogMaxURLLength) {
+            [chunk removeLastObject];
+            [chunks addObject:[NSArray arrayWithArray:chunk]];
+            [chunk removeAllObjects];
+            [chunk addObject:requestedID];
+        }
+    }
+    if ([chunk count] > 0) {
+        [chunks addObject:[NSArray arrayWithArray:chunk]];
+    }
+
+    return chunks;
+}
+
+/**
+ * Builds the videos in a find_videos_by_* response, keyed by the requested ID
+ * each one answers. Items the Media API could not find are null.
+ */
+- (NSDictionary *)videosByIDWithJSON:(NSDictionary *)json propertyKey:(NSString *)propertyKey requestedIDs:(NSArray *)requestedIDs
+{
+    NSArray *items = [json objectForKey:@"items"];
+    if (![items isKindOfClass:[NSArray class]]) {
+        return [NSDictionary dictionary];
+    }
+
+    NSMutableDictionary *videosByID = [NSMutableDictionary dictionaryWithCapacity:[items count]];
+    [items enumerateObjectsUsingBlock:^(id item, NSUInteger index, BOOL *stop) {
+        if (![item isKindOfClass:[NSDictionary class]]) {
+            return;
+        }
+
+        BCVideo *video = [self.mediaService makeVideoWithJSON:item];
+        NSString *videoKey = [video.properties objectForKey:propertyKey];
+        if (!videoKey && index < [requestedIDs count]) {
+            // Items are returned in the order requested.
+            videoKey = [requestedIDs objectAtIndex:index];
+        }
+        if (videoKey) {
+            [videosByID setObject:video forKey:videoKey];
+        }
+    }];
+
+    return videosByID;
+}
+
+@end
@@ -0,0 +1,303 @@
+//
+//  BCChapterIndex.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCChapterIndex.h"
+#import "BCImageCache.h"
+#import "BCWidevinePlugin.h"
+
+// Number of assets whose indexes are kept for replay.
+#define BCChapterIndexCacheLimit 8
+
+/**
+ * One chapter as reported by the library. The image is kept as delivered,
+ * usually compressed data, until a decoded copy is asked for.
+ */
+@interface BCChapter : NSObject
+
+@property (nonatomic) NSTimeInterval time;
+@property (nonatomic) BOOL hasTime;
+@property (nonatomic, retain) NSString *title;
+@property (nonatomic, retain) id imageSource;
+
+@end
+
+@implementation BCChapter
+
+@synthesize time;
+@synthesize hasTime;
+@synthesize title;
+@synthesize imageSource;
+
+- (void)dealloc
+{
+    self.title = nil;
+    self.imageSource = nil;
+
+    [super dealloc];
+}
+
+@end
+
+@interface BCChapterIndex ()
+{
+    NSTimeInterval *times;
+}
+
+@property (nonatomic, readwrite, retain) NSString *assetID;
+@property (nonatomic, retain) NSMutableDictionary *chaptersByLibraryIndex;
+@property (nonatomic, retain) NSArray *sortedChapters;
+@property (nonatomic) NSUInteger expectedChapterCount;
+
+- (id)initWithAssetID:(NSString *)assetID;
+- (void)handleEvent:(WViOsApiEvent)event attributes:(NSDictionary *)attributes;
+
+@end
+
+static NSMutableDictionary *BCChapterIndexCache = nil;
+static NSMutableArray *BCChapterIndexCacheOrder = nil;
+static NSString *BCChapterIndexCurrentAssetID = nil;
+static BCChapterIndex *BCChapterIndexCurrent = nil;
+
+@implementation BCChapterIndex
+
+@synthesize assetID;
+@synthesize chaptersByLibraryIndex;
+@synthesize sortedChapters;
+@synthesize expectedChapterCount;
+
+#pragma mark - Cache
+
++ (BCChapterIndex *)chapterIndexForAssetID:(NSString *)assetID
+{
+    if (!BCChapterIndexCache) {
+        BCChapterIndexCache = [[NSMutableDictionary alloc] init];
+        BCChapterIndexCacheOrder = [[NSMutableArray alloc] init];
+    }
+
+    NSString *key = assetID ?: @"";
+    BCChapterIndex *index = [BCChapterIndexCache objectForKey:key];
+    if (!index) {
+        index = [[[BCChapterIndex alloc] initWithAssetID:assetID] autorelease];
+        [BCChapterIndexCache setObject:index forKey:key];
+    }
+
+    [BCChapterIndexCacheOrder removeObject:key];
+    [BCChapterIndexCacheOrder addObject:key];
+    while ([BCChapterIndexCacheOrder count] > BCChapterIndexCacheLimit) {
+        [BCChapterIndexCache removeObjectForKey:[BCChapterIndexCacheOrder objectAtIndex:0]];
+        [BCChapterIndexCacheOrder removeObjectAtIndex:0];
+    }
+    return index;
+}
+
++ (BCChapterIndex *)currentChapterIndex
+{
+    return BCChapterIndexCurrent;
+}
+
++ (void)setCurrentAssetID:(NSString *)assetID
+{
+    if (assetID == BCChapterIndexCurrentAssetID || [assetID isEqualToString:BCChapterIndexCurrentAssetID]) {
+        return;
+    }
+    [BCChapterIndexCurrentAssetID release];
+    BCChapterIndexCurrentAssetID = [assetID copy];
+    [BCChapterIndexCurrent release];
+    BCChapterIndexCurrent = nil;
+}
+
++ (void)handleWidevineEvent:(WViOsApiEvent)event attributes:(NSDictionary *)attributes
+{
+    if (event != WViOsApiEvent_ChapterSetup && event != WViOsApiEvent_ChapterTitle && event != WViOsApiEvent_ChapterImage) {
+        return;
+    }
+
+    NSString *assetID = [attributes objectForKey:WVAssetIDKey];
+    if (assetID) {
+        [self setCurrentAssetID:[NSString stringWithFormat:@"%@", assetID]];
+    }
+    if (!BCChapterIndexCurrent) {
+        BCChapterIndexCurrent = [[self chapterIndexForAssetID:BCChapterIndexCurrentAssetID] retain];
+    }
+    [BCChapterIndexCurrent handleEvent:event attributes:attributes];
+}
+
++ (void)handleWidevineEventDetails:(NSDictionary *)details
+{
+    id status = [details objectForKey:widevineStatus];
+    WViOsApiEvent event = WViOsApiEvent_NullEvent;
+
+    if ([status isKindOfClass:[NSNumber class]]) {
+        event = [status intValue];
+    } else if ([status isKindOfClass:[NSString class]]) {
+        for (int candidate = WViOsApiEvent_ChapterTitle; candidate <= WViOsApiEvent_ChapterSetup; candidate++) {
+            if ([status isEqualToString:NSStringFromWViOsApiEvent(candidate)]) {
+                event = candidate;
+            }
+        }
+    }
+    [self handleWidevineEvent:event attributes:details];
+}
+
+#pragma mark - Index
+
+- (id)initWithAssetID:(NSString *)asset
+{
+    if (self = [super init]) {
+        self.assetID = asset;
+        self.chaptersByLibraryIndex = [NSMutableDictionary dictionary];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    free(times);
+    self.assetID = nil;
+    self.chaptersByLibraryIndex = nil;
+    self.sortedChapters = nil;
+
+    [super dealloc];
+}
+
+- (BOOL)isComplete
+{
+    return self.expectedChapterCount > 0 && [self.sortedChapters count] >= self.expectedChapterCount;
+}
+
+- (void)handleEvent:(WViOsApiEvent)event attributes:(NSDictionary *)attributes
+{
+    if (event == WViOsApiEvent_ChapterSetup) {
+        NSUInteger count = [[attributes objectForKey:WVNumChaptersKey] unsignedIntegerValue];
+        if (self.isComplete && count == self.expectedChapterCount) {
+            // A replay of an asset that is already indexed.
+            return;
+        }
+        self.expectedChapterCount = count;
+        [self.chaptersByLibraryIndex removeAllObjects];
+        [self rebuildTimes];
+        return;
+    }
+
+    NSNumber *libraryIndex = [attributes objectForKey:WVChapterIndexKey];
+    if (!libraryIndex || self.isComplete) {
+        return;
+    }
+
+    BCChapter *chapter = [self.chaptersByLibraryIndex objectForKey:libraryIndex];
+    if (!chapter) {
+        chapter = [[[BCChapter alloc] init] autorelease];
+        [self.chaptersByLibraryIndex setObject:chapter forKey:libraryIndex];
+    }
+
+    NSNumber *time = [attributes objectForKey:WVChapterTimeIndexKey];
+    if (time && (!chapter.hasTime || chapter.time != [time doubleValue])) {
+        chapter.time = [time doubleValue];
+        chapter.hasTime = YES;
+        [self rebuildTimes];
+    }
+    if (event == WViOsApiEvent_ChapterTitle) {
+        chapter.title = [attributes objectForKey:WVChapterTitleKey];
+    } else if (event == WViOsApiEvent_ChapterImage) {
+        chapter.imageSource = [attributes objectForKey:WVChapterImageKey];
+    }
+}
+
+/**
+ * Sorts the chapters that have a start time and copies their times into times.
+ */
+- (void)rebuildTimes
+{
+    NSMutableArray *chapters = [NSMutableArray arrayWithCapacity:[self.chaptersByLibraryIndex count]];
+    for (BCChapter *chapter in [self.chaptersByLibraryIndex allValues]) {
+        if (chapter.hasTime) {
+            [chapters addObject:chapter];
+        }
+    }
+    [chapters sortUsingComparator:^NSComparisonResult(BCChapter *a, BCChapter *b) {
+        return a.time < b.time ? NSOrderedAscending : (a.time > b.time ? NSOrderedDescending : NSOrderedSame);
+    }];
+    self.sortedChapters = chapters;
+
+    free(times);
+    times = malloc(MAX([chapters count], 1) * sizeof(NSTimeInterval));
+    for (NSUInteger i = 0; i < [chapters count]; i++) {
+        times[i] = [[chapters objectAtIndex:i] time];
+    }
+}
+
+- (NSUInteger)chapterCount
+{
+    return [self.sortedChapters count];
+}
+
+- (NSUInteger)chapterAtTime:(NSTimeInterval)time
+{
+    // Find the first chapter starting after time; the one before it is playing.
+    NSUInteger low = 0;
+    NSUInteger high = self.chapterCount;
+    while (low < high) {
+        NSUInteger middle = low + (high - low) / 2;
+        if (times[middle] <= time) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low == 0 ? NSNotFound : low - 1;
+}
+
+- (NSTimeInterval)timeOfChapter:(NSUInteger)chapter
+{
+    return times[chapter];
+}
+
+- (NSString *)titleOfChapter:(NSUInteger)chapter
+{
+    return [[self.sortedChapters objectAtIndex:chapter] title];
+}
+
+#pragma mark - Images
+
+- (NSString *)imageKeyForChapter:(NSUInteger)chapter maxPixelSize:(CGFloat)maxPixelSize
+{
+    return [NSString stringWithFormat:@"%@#%g@%g", self.assetID, [self timeOfChapter:chapter], maxPixelSize];
+}
+
+- (UIImage *)cachedImageForChapter:(NSUInteger)chapter maxPixelSize:(CGFloat)maxPixelSize
+{
+    return [[BCImageCache chapterImageCache] imageForKey:[self imageKeyForChapter:chapter maxPixelSize:maxPixelSize]];
+}
+
+- (void)loadImageForChapter:(NSUInteger)chapter maxPixelSize:(CGFloat)maxPixelSize block:(BCChapterImageBlock)block
+{
+    UIImage *cached = [self cachedImageForChapter:chapter maxPixelSize:maxPixelSize];
+    id source = [[self.sortedChapters objectAtIndex:chapter] imageSource];
+    if (cached || !source) {
+        block(cached, chapter);
+        return;
+    }
+
+    NSString *key = [self imageKeyForChapter:chapter maxPixelSize:maxPixelSize];
+    BCChapterImageBlock completionBlock = [[block copy] autorelease];
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        UIImage *image = [source isKindOfClass:[UIImage class]] ? source : nil;
+        if ([source isKindOfClass:[NSData class]]) {
+            image = [UIImage imageWithData:source];
+        }
+        UIImage *decoded = image ? [BCImageCache decodedImageWithImage:image maxPixelSize:maxPixelSize] : nil;
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [[BCImageCache chapterImageCache] setImage:decoded forKey:key];
+            completionBlock(decoded, chapter);
+        });
+    });
+}
+
+@end
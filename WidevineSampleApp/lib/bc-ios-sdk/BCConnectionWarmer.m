@@ -0,0 +1,126 @@
+//
+//  BCConnectionWarmer.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCConnectionWarmer.h"
+
+#define BCConnectionWarmerDefaultKeepAliveInterval 30
+#define BCConnectionWarmerDefaultTimeoutInterval 10
+
+@interface BCConnectionWarmer ()
+
+@property (nonatomic, retain) NSMutableSet *warmingHosts;
+@property (nonatomic, retain) NSMutableDictionary *lastUseDates;
+@property (nonatomic, retain) NSMutableDictionary *warmUpDurations;
+
+@end
+
+@implementation BCConnectionWarmer
+
+@synthesize warmingHosts;
+@synthesize lastUseDates;
+@synthesize warmUpDurations;
+@synthesize keepAliveInterval;
+@synthesize timeoutInterval;
+
++ (BCConnectionWarmer *)sharedWarmer
+{
+    static BCConnectionWarmer *sharedWarmer = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedWarmer = [[BCConnectionWarmer alloc] init];
+    });
+    return sharedWarmer;
+}
+
+/**
+ * Returns the key of the connection pool that requests to url share.
+ */
++ (NSString *)hostKeyForURL:(NSURL *)url
+{
+    NSString *scheme = [[url scheme] lowercaseString];
+    NSNumber *port = [url port];
+    if (!port) {
+        port = [NSNumber numberWithInt:([scheme isEqualToString:@"https"] ? 443 : 80)];
+    }
+    return [NSString stringWithFormat:@"%@://%@:%@", scheme, [[url host] lowercaseString], port];
+}
+
+- (id)init
+{
+    if (self = [super init]) {
+        self.warmingHosts = [NSMutableSet set];
+        self.lastUseDates = [NSMutableDictionary dictionary];
+        self.warmUpDurations = [NSMutableDictionary dictionary];
+        self.keepAliveInterval = BCConnectionWarmerDefaultKeepAliveInterval;
+        self.timeoutInterval = BCConnectionWarmerDefaultTimeoutInterval;
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    self.warmingHosts = nil;
+    self.lastUseDates = nil;
+    self.warmUpDurations = nil;
+
+    [super dealloc];
+}
+
+- (void)warmConnectionToURL:(NSURL *)url
+{
+    if (![url host]) {
+        return;
+    }
+
+    NSString *hostKey = [BCConnectionWarmer hostKeyForURL:url];
+    NSDate *lastUse = [self.lastUseDates objectForKey:hostKey];
+    if ([self.warmingHosts containsObject:hostKey] ||
+        (lastUse && -[lastUse timeIntervalSinceNow] < self.keepAliveInterval)) {
+        return;
+    }
+    [self.warmingHosts addObject:hostKey];
+
+    // The path doesn't matter, only that the request reaches the server.
+    NSMutableURLRequest *request = [NSMutableURLRequest requestWithURL:[NSURL URLWithString:@"/" relativeToURL:url]
+                                                           cachePolicy:NSURLRequestReloadIgnoringLocalCacheData
+                                                       timeoutInterval:self.timeoutInterval];
+    [request setHTTPMethod:@"HEAD"];
+
+    NSDate *startDate = [NSDate date];
+    __block BCConnectionWarmer *weakself = self;
+    [NSURLConnection sendAsynchronousRequest:request
+                                       queue:[NSOperationQueue mainQueue]
+                           completionHandler:^(NSURLResponse *response, NSData *data, NSError *error) {
+                               [weakself.warmingHosts removeObject:hostKey];
+                               if (!response) {
+                                   NSLog(@"%s Could not warm %@: %@", __PRETTY_FUNCTION__, hostKey, error);
+                                   return;
+                               }
+
+                               NSTimeInterval duration = -[startDate timeIntervalSinceNow];
+                               [weakself.warmUpDurations setObject:[NSNumber numberWithDouble:duration] forKey:hostKey];
+                               [weakself.lastUseDates setObject:[NSDate date] forKey:hostKey];
+                               NSLog(@"%s Warmed %@ in %.0f ms", __PRETTY_FUNCTION__, hostKey, duration * 1000);
+                           }];
+}
+
+- (void)connectionToURLWasUsed:(NSURL *)url
+{
+    if ([url host]) {
+        [self.lastUseDates setObject:[NSDate date] forKey:[BCConnectionWarmer hostKeyForURL:url]];
+    }
+}
+
+- (NSTimeInterval)warmUpDurationForURL:(NSURL *)url
+{
+    NSNumber *duration = [url host] ? [self.warmUpDurations objectForKey:[BCConnectionWarmer hostKeyForURL:url]] : nil;
+    return duration ? [duration doubleValue] : -1;
+}
+
+@end
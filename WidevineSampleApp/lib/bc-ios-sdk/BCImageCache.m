@@ -0,0 +1,314 @@
+//
+//  BCImageCache.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCImageCache.h"
+#import "BCThroughputEstimator.h"
+
+/**
+ * Returns the bytes held by the bitmap of a decoded image.
+ */
+static unsigned long long BCImageCost(UIImage *image)
+{
+    CGImageRef cgImage = image.CGImage;
+    return cgImage ? (unsigned long long)CGImageGetBytesPerRow(cgImage) * CGImageGetHeight(cgImage) : 0;
+}
+
+typedef void (^BCImageLoadCompletionBlock)(NSData *data, NSTimeInterval transferDuration);
+
+/**
+ * Loads the data of one image, calling its completion block on the cache's
+ * load queue with the data, or nil on failure, and the time from the response
+ * arriving to the last byte.
+ */
+@interface BCImageLoad : NSObject <NSURLConnectionDataDelegate>
+
+@property (nonatomic, retain) NSURLConnection *connection;
+@property (nonatomic, retain) NSMutableData *receivedData;
+@property (nonatomic, retain) NSDate *responseDate;
+@property (nonatomic, copy) BCImageLoadCompletionBlock completionBlock;
+
+@end
+
+@implementation BCImageLoad
+
+@synthesize connection;
+@synthesize receivedData;
+@synthesize responseDate;
+@synthesize completionBlock;
+
++ (void)loadURL:(NSURL *)url queue:(NSOperationQueue *)queue completionBlock:(BCImageLoadCompletionBlock)completionBlock
+{
+    BCImageLoad *load = [[BCImageLoad alloc] init];
+    load.completionBlock = completionBlock;
+    load.receivedData = [NSMutableData data];
+
+    // The connection keeps its delegate until it finishes or fails.
+    NSURLConnection *urlConnection = [[NSURLConnection alloc] initWithRequest:[NSURLRequest requestWithURL:url]
+                                                                     delegate:load
+                                                             startImmediately:NO];
+    [urlConnection setDelegateQueue:queue];
+    load.connection = urlConnection;
+    [urlConnection start];
+
+    [urlConnection release];
+    [load release];
+}
+
+- (void)dealloc
+{
+    self.connection = nil;
+    self.receivedData = nil;
+    self.responseDate = nil;
+    self.completionBlock = nil;
+
+    [super dealloc];
+}
+
+- (void)finishWithData:(NSData *)data
+{
+    // Timed before the completion block decodes the image, so decoding doesn't count as transfer time.
+    NSTimeInterval transferDuration = data ? -[self.responseDate timeIntervalSinceNow] : 0;
+    self.completionBlock(data, transferDuration);
+    self.completionBlock = nil;
+    self.connection = nil;
+}
+
+#pragma mark - NSURLConnectionDataDelegate
+
+- (void)connection:(NSURLConnection *)urlConnection didReceiveResponse:(NSURLResponse *)urlResponse
+{
+    self.responseDate = [NSDate date];
+    [self.receivedData setLength:0];
+}
+
+- (void)connection:(NSURLConnection *)urlConnection didReceiveData:(NSData *)data
+{
+    [self.receivedData appendData:data];
+}
+
+- (void)connectionDidFinishLoading:(NSURLConnection *)urlConnection
+{
+    [self finishWithData:self.receivedData];
+}
+
+- (void)connection:(NSURLConnection *)urlConnection didFailWithError:(NSError *)error
+{
+    [self finishWithData:nil];
+}
+
+@end
+
+@interface BCImageCache ()
+
+@property (nonatomic, retain) NSString *name;
+@property (nonatomic, retain) NSMutableDictionary *images;
+@property (nonatomic, retain) NSMutableArray *keysByUse;
+@property (nonatomic, retain) NSMutableDictionary *pendingBlocks;
+@property (nonatomic, retain) NSOperationQueue *loadQueue;
+@property (nonatomic) unsigned long long cost;
+
+@end
+
+@implementation BCImageCache
+
+@synthesize name;
+@synthesize images;
+@synthesize keysByUse;
+@synthesize pendingBlocks;
+@synthesize loadQueue;
+@synthesize cost;
+
++ (BCImageCache *)stillImageCache
+{
+    static BCImageCache *stillImageCache = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        stillImageCache = [[BCImageCache alloc] initWithName:@"videoStills"];
+    });
+    return stillImageCache;
+}
+
++ (BCImageCache *)chapterImageCache
+{
+    static BCImageCache *chapterImageCache = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        chapterImageCache = [[BCImageCache alloc] initWithName:@"chapterImages"];
+    });
+    return chapterImageCache;
+}
+
++ (UIImage *)decodedImageWithImage:(UIImage *)image
+{
+    return [self decodedImageWithImage:image maxPixelSize:0];
+}
+
++ (UIImage *)decodedImageWithImage:(UIImage *)image maxPixelSize:(CGFloat)maxPixelSize
+{
+    CGImageRef cgImage = image.CGImage;
+    if (!cgImage) {
+        return image;
+    }
+
+    size_t width = CGImageGetWidth(cgImage);
+    size_t height = CGImageGetHeight(cgImage);
+    if (maxPixelSize > 0 && MAX(width, height) > maxPixelSize) {
+        CGFloat ratio = maxPixelSize / MAX(width, height);
+        width = MAX((size_t)(width * ratio), 1);
+        height = MAX((size_t)(height * ratio), 1);
+    }
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
+    CGContextRef context = CGBitmapContextCreate(NULL, width, height, 8, 0, colorSpace,
+                                                 kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little);
+    CGColorSpaceRelease(colorSpace);
+    if (!context) {
+        return image;
+    }
+
+    CGContextDrawImage(context, CGRectMake(0, 0, width, height), cgImage);
+    CGImageRef decodedImage = CGBitmapContextCreateImage(context);
+    CGContextRelease(context);
+
+    UIImage *decoded = [UIImage imageWithCGImage:decodedImage scale:image.scale orientation:image.imageOrientation];
+    CGImageRelease(decodedImage);
+    return decoded;
+}
+
+- (id)initWithName:(NSString *)cacheName
+{
+    if (self = [super init]) {
+        self.name = cacheName;
+        self.images = [NSMutableDictionary dictionary];
+        self.keysByUse = [NSMutableArray array];
+        self.pendingBlocks = [NSMutableDictionary dictionary];
+        self.loadQueue = [[[NSOperationQueue alloc] init] autorelease];
+        self.loadQueue.maxConcurrentOperationCount = 2;
+        [[BCCacheRegistry sharedRegistry] registerCache:self];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    [[BCCacheRegistry sharedRegistry] unregisterCache:self];
+
+    self.name = nil;
+    self.images = nil;
+    self.keysByUse = nil;
+    self.pendingBlocks = nil;
+    self.loadQueue = nil;
+
+    [super dealloc];
+}
+
+- (UIImage *)imageForKey:(NSString *)key
+{
+    UIImage *image = key ? [self.images objectForKey:key] : nil;
+    if (image) {
+        [self.keysByUse removeObject:key];
+        [self.keysByUse addObject:key];
+    }
+    return image;
+}
+
+- (void)setImage:(UIImage *)image forKey:(NSString *)key
+{
+    if (!image || !key) {
+        return;
+    }
+
+    [self removeImageForKey:key];
+    [self.images setObject:image forKey:key];
+    [self.keysByUse addObject:key];
+    self.cost += BCImageCost(image);
+
+    [[BCCacheRegistry sharedRegistry] cacheDidGrow:self];
+}
+
+- (void)removeImageForKey:(NSString *)key
+{
+    UIImage *image = [self.images objectForKey:key];
+    if (image) {
+        self.cost -= BCImageCost(image);
+        [self.images removeObjectForKey:key];
+        [self.keysByUse removeObject:key];
+    }
+}
+
+- (void)removeAllImages
+{
+    [self.images removeAllObjects];
+    [self.keysByUse removeAllObjects];
+    self.cost = 0;
+}
+
+- (UIImage *)imageForURL:(NSURL *)url
+{
+    return [self imageForKey:[url absoluteString]];
+}
+
+- (void)loadImageWithURL:(NSURL *)url completionBlock:(BCImageCacheCompletionBlock)completionBlock
+{
+    NSString *key = [url absoluteString];
+    UIImage *image = [self imageForKey:key];
+    if (image || !key) {
+        completionBlock(image, url);
+        return;
+    }
+
+    BCImageCacheCompletionBlock block = [[completionBlock copy] autorelease];
+    NSMutableArray *blocks = [self.pendingBlocks objectForKey:key];
+    if (blocks) {
+        [blocks addObject:block];
+        return;
+    }
+    [self.pendingBlocks setObject:[NSMutableArray arrayWithObject:block] forKey:key];
+
+    __block BCImageCache *weakself = self;
+    [BCImageLoad loadURL:url queue:self.loadQueue completionBlock:^(NSData *data, NSTimeInterval transferDuration) {
+        UIImage *loadedImage = data ? [BCImageCache decodedImageWithImage:[UIImage imageWithData:data]] : nil;
+
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [[BCThroughputEstimator sharedEstimator] recordTransferOfBytes:[data length] duration:transferDuration];
+            [weakself setImage:loadedImage forKey:key];
+
+            NSArray *waitingBlocks = [[[weakself.pendingBlocks objectForKey:key] retain] autorelease];
+            [weakself.pendingBlocks removeObjectForKey:key];
+            for (BCImageCacheCompletionBlock waitingBlock in waitingBlocks) {
+                waitingBlock(loadedImage, url);
+            }
+        });
+    }];
+}
+
+#pragma mark - BCRegisteredCache
+
+- (NSString *)cacheName
+{
+    return self.name;
+}
+
+- (BCCacheTier)cacheTier
+{
+    return BCCacheTierImages;
+}
+
+- (unsigned long long)cacheCost
+{
+    return self.cost;
+}
+
+- (void)trimToCost:(unsigned long long)maxCost
+{
+    while ([self.keysByUse count] > 0 && self.cost > maxCost) {
+        [self removeImageForKey:[self.keysByUse objectAtIndex:0]];
+    }
+}
+
+@end
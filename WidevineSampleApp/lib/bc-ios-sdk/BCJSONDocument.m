@@ -0,0 +1,464 @@
+//
+//  BCJSONDocument.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCJSONDocument.h"
+#import "BCJSONKeyCache.h"
+#import "BCJSONReader.h"
+#import "BCJSONTape.h"
+
+// Keys up to this many bytes are compared without allocating.
+#define BCJSONDocumentKeyBufferLength 128
+
+@interface BCJSONDocument ()
+{
+    BCJSONTape tape;
+    const uint8_t *bytes;
+}
+
+@property (nonatomic, retain) NSData *data;
+@property (nonatomic, retain) BCJSONKeyCache *keyCache;
+
+- (const BCJSONTapeEntry *)entryAtIndex:(uint32_t)index;
+- (NSString *)newKeyAtIndex:(uint32_t)index;
+- (id)newViewAtIndex:(uint32_t)index;
+- (id)newObjectAtIndex:(uint32_t)index;
+- (NSString *)newStringAtIndex:(uint32_t)index;
+
+@end
+
+#pragma mark - Views
+
+@interface BCJSONStringView : NSString
+{
+    BCJSONDocument *document;
+    const uint8_t *characters;
+    NSUInteger length;
+}
+
+- (id)initWithDocument:(BCJSONDocument *)document index:(uint32_t)index;
+
+@end
+
+@interface BCJSONArrayView : NSArray
+{
+    BCJSONDocument *document;
+    uint32_t index;
+    NSUInteger count;
+    uint32_t *elementIndexes;
+    id *values;
+}
+
+- (id)initWithDocument:(BCJSONDocument *)document index:(uint32_t)index;
+
+@end
+
+@interface BCJSONObjectView : NSDictionary
+{
+    BCJSONDocument *document;
+    uint32_t index;
+    NSUInteger count;
+    uint32_t *keyIndexes;
+    id *values;
+}
+
+- (id)initWithDocument:(BCJSONDocument *)document index:(uint32_t)index;
+
+@end
+
+@implementation BCJSONStringView
+
+- (id)initWithDocument:(BCJSONDocument *)jsonDocument index:(uint32_t)entryIndex
+{
+    if (self = [super init]) {
+        const BCJSONTapeEntry *entry = [jsonDocument entryAtIndex:entryIndex];
+        document = [jsonDocument retain];
+        characters = (const uint8_t *)[jsonDocument.data bytes] + entry->offset;
+        length = entry->length;
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    [document release];
+
+    [super dealloc];
+}
+
+- (NSUInteger)length
+{
+    return length;
+}
+
+- (unichar)characterAtIndex:(NSUInteger)characterIndex
+{
+    if (characterIndex >= length) {
+        [NSException raise:NSRangeException format:@"Index %lu out of bounds", (unsigned long)characterIndex];
+    }
+    return characters[characterIndex];
+}
+
+- (void)getCharacters:(unichar *)buffer range:(NSRange)range
+{
+    if (NSMaxRange(range) > length) {
+        [NSException raise:NSRangeException format:@"Range %@ out of bounds", NSStringFromRange(range)];
+    }
+    for (NSUInteger i = 0; i < range.length; i++) {
+        buffer[i] = characters[range.location + i];
+    }
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    return (NSString *)CFStringCreateWithBytes(NULL, characters, length, kCFStringEncodingASCII, false);
+}
+
+@end
+
+@implementation BCJSONArrayView
+
+- (id)initWithDocument:(BCJSONDocument *)jsonDocument index:(uint32_t)entryIndex
+{
+    if (self = [super init]) {
+        document = [jsonDocument retain];
+        index = entryIndex;
+        count = [jsonDocument entryAtIndex:entryIndex]->length;
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    if (values) {
+        for (NSUInteger i = 0; i < count; i++) {
+            [values[i] release];
+        }
+        free(values);
+    }
+    free(elementIndexes);
+    [document release];
+
+    [super dealloc];
+}
+
+- (NSUInteger)count
+{
+    return count;
+}
+
+- (id)objectAtIndex:(NSUInteger)elementIndex
+{
+    if (elementIndex >= count) {
+        [NSException raise:NSRangeException format:@"Index %lu out of bounds", (unsigned long)elementIndex];
+    }
+
+    if (!values) {
+        // Elements are found by skipping over their siblings, so record where each one starts.
+        values = calloc(count, sizeof(id));
+        elementIndexes = malloc(count * sizeof(uint32_t));
+        uint32_t element = index + 1;
+        for (NSUInteger i = 0; i < count; i++) {
+            elementIndexes[i] = element;
+            element = [document entryAtIndex:element]->next;
+        }
+    }
+    if (!values[elementIndex]) {
+        values[elementIndex] = [document newViewAtIndex:elementIndexes[elementIndex]];
+    }
+    return values[elementIndex];
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    return [document newObjectAtIndex:index];
+}
+
+@end
+
+@implementation BCJSONObjectView
+
+- (id)initWithDocument:(BCJSONDocument *)jsonDocument index:(uint32_t)entryIndex
+{
+    if (self = [super init]) {
+        document = [jsonDocument retain];
+        index = entryIndex;
+        count = [jsonDocument entryAtIndex:entryIndex]->length;
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    if (values) {
+        for (NSUInteger i = 0; i < count; i++) {
+            [values[i] release];
+        }
+        free(values);
+    }
+    free(keyIndexes);
+    [document release];
+
+    [super dealloc];
+}
+
+- (NSUInteger)count
+{
+    return count;
+}
+
+- (void)indexMembers
+{
+    if (keyIndexes) {
+        return;
+    }
+
+    keyIndexes = malloc(count * sizeof(uint32_t));
+    values = calloc(count, sizeof(id));
+    uint32_t key = index + 1;
+    for (NSUInteger i = 0; i < count; i++) {
+        keyIndexes[i] = key;
+        key = [document entryAtIndex:key + 1]->next;
+    }
+}
+
+- (BOOL)keyAtIndex:(NSUInteger)member matchesBytes:(const char *)keyBytes length:(NSUInteger)keyLength
+{
+    const BCJSONTapeEntry *entry = [document entryAtIndex:keyIndexes[member]];
+    const uint8_t *documentBytes = [document.data bytes];
+
+    if (!(entry->flags & BCJSONTapeFlagEscaped)) {
+        return entry->length == keyLength && memcmp(documentBytes + entry->offset, keyBytes, keyLength) == 0;
+    }
+
+    // Escaped keys never get longer when decoded, so one that is shorter than keyLength can't match.
+    if (entry->length < keyLength) {
+        return NO;
+    }
+    uint8_t *decoded = malloc(entry->length);
+    size_t decodedLength = BCJSONTapeDecodeString(entry, documentBytes, decoded);
+    BOOL matches = decodedLength == keyLength && memcmp(decoded, keyBytes, keyLength) == 0;
+    free(decoded);
+    return matches;
+}
+
+- (id)objectForKey:(id)key
+{
+    if (![key isKindOfClass:[NSString class]] || count == 0) {
+        return nil;
+    }
+
+    char buffer[BCJSONDocumentKeyBufferLength];
+    const char *keyBytes = buffer;
+    NSUInteger keyLength = 0;
+    NSRange remaining;
+    if (![key getBytes:buffer
+             maxLength:sizeof(buffer)
+            usedLength:&keyLength
+              encoding:NSUTF8StringEncoding
+               options:0
+                 range:NSMakeRange(0, [key length])
+        remainingRange:&remaining] || remaining.length > 0) {
+        keyBytes = [key UTF8String];
+        keyLength = strlen(keyBytes);
+    }
+
+    [self indexMembers];
+
+    // Search from the end so that, as with NSMutableDictionary, the last duplicate key wins.
+    for (NSUInteger member = count; member-- > 0;) {
+        if ([self keyAtIndex:member matchesBytes:keyBytes length:keyLength]) {
+            if (!values[member]) {
+                values[member] = [document newViewAtIndex:keyIndexes[member] + 1];
+            }
+            return values[member];
+        }
+    }
+
+    return nil;
+}
+
+- (NSEnumerator *)keyEnumerator
+{
+    [self indexMembers];
+
+    NSMutableArray *keys = [NSMutableArray arrayWithCapacity:count];
+    for (NSUInteger member = 0; member < count; member++) {
+        NSString *key = [document newKeyAtIndex:keyIndexes[member]];
+        [keys addObject:key];
+        [key release];
+    }
+    return [keys objectEnumerator];
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    return [document newObjectAtIndex:index];
+}
+
+@end
+
+#pragma mark - Document
+
+@implementation BCJSONDocument
+
+@synthesize data;
+@synthesize keyCache;
+
++ (id)documentWithData:(NSData *)jsonData error:(NSError **)error
+{
+    BCJSONDocument *document = [[[self alloc] init] autorelease];
+    document.data = jsonData;
+
+    const char *errorMessage = NULL;
+    size_t errorOffset = 0;
+    if (!BCJSONTapeParse(&document->tape, [jsonData bytes], [jsonData length], &errorMessage, &errorOffset)) {
+        if (error) {
+            NSString *description = [NSString stringWithFormat:@"%s (at byte %lu)", errorMessage, (unsigned long)errorOffset];
+            *error = [NSError errorWithDomain:BCJSONReaderErrorDomain
+                                         code:0
+                                     userInfo:[NSDictionary dictionaryWithObject:description forKey:NSLocalizedDescriptionKey]];
+        }
+        return nil;
+    }
+    document->bytes = [jsonData bytes];
+
+    return document;
+}
+
+- (void)dealloc
+{
+    BCJSONTapeFree(&tape);
+    self.data = nil;
+    self.keyCache = nil;
+
+    [super dealloc];
+}
+
+- (const BCJSONTapeEntry *)entryAtIndex:(uint32_t)index
+{
+    return &tape.entries[index];
+}
+
+- (id)rootViewWithKeyCache:(BCJSONKeyCache *)cache
+{
+    self.keyCache = cache;
+    return [[self newViewAtIndex:0] autorelease];
+}
+
+- (id)rootObjectWithKeyCache:(BCJSONKeyCache *)cache
+{
+    self.keyCache = cache;
+    id object = [self newObjectAtIndex:0];
+    self.keyCache = nil;
+    return [object autorelease];
+}
+
+- (NSString *)newKeyAtIndex:(uint32_t)index
+{
+    const BCJSONTapeEntry *entry = &tape.entries[index];
+    if (!self.keyCache || (entry->flags & BCJSONTapeFlagEscaped)) {
+        return [self newStringAtIndex:index];
+    }
+    return [self.keyCache newStringWithBytes:bytes + entry->offset length:entry->length];
+}
+
+- (NSString *)newStringAtIndex:(uint32_t)index
+{
+    const BCJSONTapeEntry *entry = &tape.entries[index];
+    CFStringEncoding encoding = (entry->flags & BCJSONTapeFlagASCII) ? kCFStringEncodingASCII : kCFStringEncodingUTF8;
+
+    if (!(entry->flags & BCJSONTapeFlagEscaped)) {
+        return (NSString *)CFStringCreateWithBytes(NULL, bytes + entry->offset, entry->length, encoding, false);
+    }
+
+    uint8_t *decoded = malloc(entry->length);
+    size_t decodedLength = BCJSONTapeDecodeString(entry, bytes, decoded);
+    // An escape such as é can make an ASCII string decode to UTF-8.
+    NSString *string = (NSString *)CFStringCreateWithBytes(NULL, decoded, decodedLength, kCFStringEncodingUTF8, false);
+    free(decoded);
+    return string;
+}
+
+/**
+ * Returns a retained scalar for entries that are not containers or strings.
+ */
+- (id)newScalarAtIndex:(uint32_t)index
+{
+    const BCJSONTapeEntry *entry = &tape.entries[index];
+    switch (entry->type) {
+        case BCJSONTapeTypeTrue:
+            return [[NSNumber alloc] initWithBool:YES];
+        case BCJSONTapeTypeFalse:
+            return [[NSNumber alloc] initWithBool:NO];
+        case BCJSONTapeTypeNumber:
+            if (entry->flags & BCJSONTapeFlagInteger) {
+                return [[NSNumber alloc] initWithLongLong:BCJSONTapeIntegerValue(entry, bytes)];
+            }
+            return [[NSNumber alloc] initWithDouble:BCJSONTapeDoubleValue(entry, bytes)];
+        default:
+            return [[NSNull null] retain];
+    }
+}
+
+- (id)newViewAtIndex:(uint32_t)index
+{
+    const BCJSONTapeEntry *entry = &tape.entries[index];
+    switch (entry->type) {
+        case BCJSONTapeTypeObject:
+            return [[BCJSONObjectView alloc] initWithDocument:self index:index];
+        case BCJSONTapeTypeArray:
+            return [[BCJSONArrayView alloc] initWithDocument:self index:index];
+        case BCJSONTapeTypeString:
+            if ((entry->flags & BCJSONTapeFlagASCII) && !(entry->flags & BCJSONTapeFlagEscaped)) {
+                return [[BCJSONStringView alloc] initWithDocument:self index:index];
+            }
+            return [self newStringAtIndex:index];
+        default:
+            return [self newScalarAtIndex:index];
+    }
+}
+
+- (id)newObjectAtIndex:(uint32_t)index
+{
+    const BCJSONTapeEntry *entry = &tape.entries[index];
+    switch (entry->type) {
+        case BCJSONTapeTypeObject: {
+            NSMutableDictionary *object = [[NSMutableDictionary alloc] initWithCapacity:entry->length];
+            uint32_t key = index + 1;
+            for (uint32_t member = 0; member < entry->length; member++) {
+                NSString *keyString = [self newKeyAtIndex:key];
+                id value = [self newObjectAtIndex:key + 1];
+                [object setObject:value forKey:keyString];
+                [keyString release];
+                [value release];
+                key = tape.entries[key + 1].next;
+            }
+            return object;
+        }
+        case BCJSONTapeTypeArray: {
+            NSMutableArray *array = [[NSMutableArray alloc] initWithCapacity:entry->length];
+            uint32_t element = index + 1;
+            for (uint32_t i = 0; i < entry->length; i++) {
+                id value = [self newObjectAtIndex:element];
+                [array addObject:value];
+                [value release];
+                element = tape.entries[element].next;
+            }
+            return array;
+        }
+        case BCJSONTapeTypeString:
+            return [self newStringAtIndex:index];
+        default:
+            return [self newScalarAtIndex:index];
+    }
+}
+
+@end
@@ -0,0 +1,120 @@
+//
+//  BCJSONKeyCache.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCJSONKeyCache.h"
+
+#define BCJSONKeyCacheMaxKeyLength 31
+
+typedef struct BCJSONKeyCacheSlot {
+    uint32_t hash;
+    uint8_t length;
+    uint8_t bytes[BCJSONKeyCacheMaxKeyLength];
+    NSString *string;
+} BCJSONKeyCacheSlot;
+
+/**
+ * FNV-1a, which is cheap for short keys and spreads them well enough for a small table.
+ */
+static inline uint32_t BCJSONKeyCacheHash(const uint8_t *bytes, NSUInteger length)
+{
+    uint32_t hash = 2166136261u;
+    for (NSUInteger i = 0; i < length; i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+@interface BCJSONKeyCache ()
+{
+    BCJSONKeyCacheSlot *slots;
+}
+
+@property (nonatomic, readwrite) NSUInteger capacity;
+@property (nonatomic, readwrite) NSUInteger hits;
+@property (nonatomic, readwrite) NSUInteger misses;
+
+@end
+
+@implementation BCJSONKeyCache
+
+@synthesize capacity;
+@synthesize hits;
+@synthesize misses;
+
+- (id)initWithCapacity:(NSUInteger)slotCount
+{
+    if (self = [super init]) {
+        NSUInteger roundedCapacity = 1;
+        while (roundedCapacity < slotCount) {
+            roundedCapacity <<= 1;
+        }
+        self.capacity = roundedCapacity;
+        slots = calloc(roundedCapacity, sizeof(BCJSONKeyCacheSlot));
+    }
+
+    return self;
+}
+
+- (id)init
+{
+    return [self initWithCapacity:1024];
+}
+
+- (void)dealloc
+{
+    [self removeAllStrings];
+    free(slots);
+
+    [super dealloc];
+}
+
+- (NSUInteger)maxKeyLength
+{
+    return BCJSONKeyCacheMaxKeyLength;
+}
+
+- (double)hitRate
+{
+    NSUInteger lookups = self.hits + self.misses;
+    return lookups ? (double)self.hits / lookups : 0;
+}
+
+- (NSString *)newStringWithBytes:(const uint8_t *)bytes length:(NSUInteger)length
+{
+    if (length > BCJSONKeyCacheMaxKeyLength) {
+        return [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+    }
+
+    uint32_t hash = BCJSONKeyCacheHash(bytes, length);
+    BCJSONKeyCacheSlot *slot = &slots[hash & (self.capacity - 1)];
+    if (slot->string && slot->hash == hash && slot->length == length && memcmp(slot->bytes, bytes, length) == 0) {
+        self.hits++;
+        return [slot->string retain];
+    }
+
+    self.misses++;
+    NSString *string = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+    [slot->string release];
+    slot->string = [string retain];
+    slot->hash = hash;
+    slot->length = length;
+    memcpy(slot->bytes, bytes, length);
+    return string;
+}
+
+- (void)removeAllStrings
+{
+    for (NSUInteger i = 0; i < self.capacity; i++) {
+        [slots[i].string release];
+    }
+    memset(slots, 0, self.capacity * sizeof(BCJSONKeyCacheSlot));
+    self.hits = 0;
+    self.misses = 0;
+}
+
+@end
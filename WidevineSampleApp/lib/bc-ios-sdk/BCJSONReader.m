@@ -0,0 +1,72 @@
+//
+//  BCJSONReader.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCJSONReader.h"
+#import "BCJSONDocument.h"
+#import "BCJSONKeyCache.h"
+
+NSString * const BCJSONReaderErrorDomain = @"BCJSONReaderErrorDomain";
+
+#define BCJSONReaderThreadKey @"BCJSONReader"
+
+// Enough for the keys of every Media API command with room to spare.
+#define BCJSONReaderKeyCacheCapacity 1024
+
+@interface BCJSONReader ()
+
+@property (nonatomic, retain, readwrite) BCJSONKeyCache *keyCache;
+
+@end
+
+@implementation BCJSONReader
+
+@synthesize keyCache;
+
++ (id)reader
+{
+    return [[[self alloc] init] autorelease];
+}
+
++ (BCJSONReader *)readerForCurrentThread
+{
+    NSMutableDictionary *threadDictionary = [[NSThread currentThread] threadDictionary];
+    BCJSONReader *reader = [threadDictionary objectForKey:BCJSONReaderThreadKey];
+    if (!reader) {
+        reader = [self reader];
+        [threadDictionary setObject:reader forKey:BCJSONReaderThreadKey];
+    }
+    return reader;
+}
+
+- (id)init
+{
+    if (self = [super init]) {
+        self.keyCache = [[[BCJSONKeyCache alloc] initWithCapacity:BCJSONReaderKeyCacheCapacity] autorelease];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    self.keyCache = nil;
+
+    [super dealloc];
+}
+
+- (id)objectWithData:(NSData *)data error:(NSError **)error
+{
+    return [[BCJSONDocument documentWithData:data error:error] rootObjectWithKeyCache:self.keyCache];
+}
+
+- (id)viewWithData:(NSData *)data error:(NSError **)error
+{
+    return [[BCJSONDocument documentWithData:data error:error] rootViewWithKeyCache:self.keyCache];
+}
+
+@end
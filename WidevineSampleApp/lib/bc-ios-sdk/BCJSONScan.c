@@ -0,0 +1,392 @@
+//
+//  BCJSONScan.c
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#include "BCJSONScan.h"
+
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define BCJSON_X86 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BCJSON_NEON 1
+#endif
+
+typedef const uint8_t *(*BCJSONScanFunction)(const uint8_t *p, const uint8_t *end);
+typedef bool (*BCJSONTestFunction)(const uint8_t *p, const uint8_t *end);
+
+static struct {
+    BCJSONScanFunction scanString;
+    BCJSONScanFunction skipWhitespace;
+    BCJSONTestFunction isASCII;
+    const char *name;
+} BCJSONScanFunctions;
+
+#pragma mark - Scalar
+
+static inline bool BCJSONIsStringSpecial(uint8_t c)
+{
+    return c == '"' || c == '\\' || c < 0x20;
+}
+
+static inline bool BCJSONIsWhitespace(uint8_t c)
+{
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static const uint8_t *BCJSONScanStringScalar(const uint8_t *p, const uint8_t *end)
+{
+    while (p < end && !BCJSONIsStringSpecial(*p)) {
+        p++;
+    }
+    return p;
+}
+
+static const uint8_t *BCJSONSkipWhitespaceScalar(const uint8_t *p, const uint8_t *end)
+{
+    while (p < end && BCJSONIsWhitespace(*p)) {
+        p++;
+    }
+    return p;
+}
+
+static bool BCJSONIsASCIIScalar(const uint8_t *p, const uint8_t *end)
+{
+    uint8_t bits = 0;
+    while (p < end) {
+        bits |= *p++;
+    }
+    return bits < 0x80;
+}
+
+/*
+ * Validates the multi-byte sequences in [p, end). Table 3-7 of the Unicode
+ * standard gives the allowed ranges for the second byte of each lead byte.
+ */
+static bool BCJSONValidateUTF8Scalar(const uint8_t *p, const uint8_t *end)
+{
+    while (p < end) {
+        uint8_t c = *p;
+        if (c < 0x80) {
+            p++;
+            continue;
+        }
+
+        int trailing;
+        uint8_t low = 0x80;
+        uint8_t high = 0xBF;
+        if (c >= 0xC2 && c <= 0xDF) {
+            trailing = 1;
+        } else if (c >= 0xE0 && c <= 0xEF) {
+            trailing = 2;
+            if (c == 0xE0) {
+                low = 0xA0;
+            } else if (c == 0xED) {
+                high = 0x9F;
+            }
+        } else if (c >= 0xF0 && c <= 0xF4) {
+            trailing = 3;
+            if (c == 0xF0) {
+                low = 0x90;
+            } else if (c == 0xF4) {
+                high = 0x8F;
+            }
+        } else {
+            return false;
+        }
+
+        if (end - p <= trailing || p[1] < low || p[1] > high) {
+            return false;
+        }
+        for (int i = 2; i <= trailing; i++) {
+            if ((p[i] & 0xC0) != 0x80) {
+                return false;
+            }
+        }
+        p += trailing + 1;
+    }
+    return true;
+}
+
+#pragma mark - SSE2 and AVX2
+
+#if BCJSON_X86
+
+static const uint8_t *BCJSONScanStringSSE2(const uint8_t *p, const uint8_t *end)
+{
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        // max(v, 0x1F) == 0x1F exactly when v <= 0x1F, as an unsigned byte.
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+                                       _mm_cmpeq_epi8(_mm_max_epu8(v, control), control));
+        int mask = _mm_movemask_epi8(special);
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+    return BCJSONScanStringScalar(p, end);
+}
+
+static const uint8_t *BCJSONSkipWhitespaceSSE2(const uint8_t *p, const uint8_t *end)
+{
+    // Media API responses are compact, so most calls stop at the first byte.
+    if (p < end && !BCJSONIsWhitespace(*p)) {
+        return p;
+    }
+
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i carriageReturn = _mm_set1_epi8('\r');
+    const __m128i tab = _mm_set1_epi8('\t');
+
+    while (end - p >= 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)p);
+        __m128i whitespace = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, newline)),
+                                          _mm_or_si128(_mm_cmpeq_epi8(v, carriageReturn), _mm_cmpeq_epi8(v, tab)));
+        int mask = _mm_movemask_epi8(whitespace) ^ 0xFFFF;
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+    return BCJSONSkipWhitespaceScalar(p, end);
+}
+
+static bool BCJSONIsASCIISSE2(const uint8_t *p, const uint8_t *end)
+{
+    __m128i bits = _mm_setzero_si128();
+    while (end - p >= 16) {
+        bits = _mm_or_si128(bits, _mm_loadu_si128((const __m128i *)p));
+        p += 16;
+    }
+    return _mm_movemask_epi8(bits) == 0 && BCJSONIsASCIIScalar(p, end);
+}
+
+__attribute__((target("avx2")))
+static const uint8_t *BCJSONScanStringAVX2(const uint8_t *p, const uint8_t *end)
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control = _mm256_set1_epi8(0x1F);
+
+    while (end - p >= 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)p);
+        __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)),
+                                          _mm256_cmpeq_epi8(_mm256_max_epu8(v, control), control));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(special);
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+    return BCJSONScanStringSSE2(p, end);
+}
+
+__attribute__((target("avx2")))
+static bool BCJSONIsASCIIAVX2(const uint8_t *p, const uint8_t *end)
+{
+    __m256i bits = _mm256_setzero_si256();
+    while (end - p >= 32) {
+        bits = _mm256_or_si256(bits, _mm256_loadu_si256((const __m256i *)p));
+        p += 32;
+    }
+    return _mm256_movemask_epi8(bits) == 0 && BCJSONIsASCIISSE2(p, end);
+}
+
+/*
+ * AVX2 needs both CPU support (CPUID leaf 7) and the OS saving the YMM
+ * registers on context switches (OSXSAVE and XCR0 bits 1 and 2).
+ */
+static bool BCJSONCPUSupportsAVX2(void)
+{
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_OSXSAVE)) {
+        return false;
+    }
+
+    unsigned int xcr0Low, xcr0High;
+    __asm__ volatile ("xgetbv" : "=a" (xcr0Low), "=d" (xcr0High) : "c" (0));
+    if ((xcr0Low & 0x6) != 0x6) {
+        return false;
+    }
+
+    if (__get_cpuid_max(0, NULL) < 7) {
+        return false;
+    }
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return (ebx & bit_AVX2) != 0;
+}
+
+#endif
+
+#pragma mark - NEON
+
+#if BCJSON_NEON
+
+/*
+ * Returns the index of the first 0xFF byte in a comparison result, or 16 if
+ * there is none.
+ */
+static inline int BCJSONFirstSetByte(uint8x16_t mask)
+{
+    uint64x2_t lanes = vreinterpretq_u64_u8(mask);
+    uint64_t low = vgetq_lane_u64(lanes, 0);
+    if (low) {
+        return __builtin_ctzll(low) >> 3;
+    }
+    uint64_t high = vgetq_lane_u64(lanes, 1);
+    if (high) {
+        return 8 + (__builtin_ctzll(high) >> 3);
+    }
+    return 16;
+}
+
+static const uint8_t *BCJSONScanStringNEON(const uint8_t *p, const uint8_t *end)
+{
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t control = vdupq_n_u8(0x20);
+
+    while (end - p >= 16) {
+        uint8x16_t v = vld1q_u8(p);
+        uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash)), vcltq_u8(v, control));
+        int index = BCJSONFirstSetByte(special);
+        if (index < 16) {
+            return p + index;
+        }
+        p += 16;
+    }
+    return BCJSONScanStringScalar(p, end);
+}
+
+static const uint8_t *BCJSONSkipWhitespaceNEON(const uint8_t *p, const uint8_t *end)
+{
+    if (p < end && !BCJSONIsWhitespace(*p)) {
+        return p;
+    }
+
+    const uint8x16_t space = vdupq_n_u8(' ');
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    const uint8x16_t carriageReturn = vdupq_n_u8('\r');
+    const uint8x16_t tab = vdupq_n_u8('\t');
+
+    while (end - p >= 16) {
+        uint8x16_t v = vld1q_u8(p);
+        uint8x16_t whitespace = vorrq_u8(vorrq_u8(vceqq_u8(v, space), vceqq_u8(v, newline)),
+                                         vorrq_u8(vceqq_u8(v, carriageReturn), vceqq_u8(v, tab)));
+        int index = BCJSONFirstSetByte(vmvnq_u8(whitespace));
+        if (index < 16) {
+            return p + index;
+        }
+        p += 16;
+    }
+    return BCJSONSkipWhitespaceScalar(p, end);
+}
+
+static bool BCJSONIsASCIINEON(const uint8_t *p, const uint8_t *end)
+{
+    uint8x16_t bits = vdupq_n_u8(0);
+    while (end - p >= 16) {
+        bits = vorrq_u8(bits, vld1q_u8(p));
+        p += 16;
+    }
+    return BCJSONFirstSetByte(vcgeq_u8(bits, vdupq_n_u8(0x80))) == 16 && BCJSONIsASCIIScalar(p, end);
+}
+
+#endif
+
+#pragma mark - Dispatch
+
+static void BCJSONScanSelectFunctions(void)
+{
+    BCJSONScanFunctions.scanString = BCJSONScanStringScalar;
+    BCJSONScanFunctions.skipWhitespace = BCJSONSkipWhitespaceScalar;
+    BCJSONScanFunctions.isASCII = BCJSONIsASCIIScalar;
+    BCJSONScanFunctions.name = "scalar";
+
+#if BCJSON_X86 && defined(__SSE2__)
+    BCJSONScanFunctions.scanString = BCJSONScanStringSSE2;
+    BCJSONScanFunctions.skipWhitespace = BCJSONSkipWhitespaceSSE2;
+    BCJSONScanFunctions.isASCII = BCJSONIsASCIISSE2;
+    BCJSONScanFunctions.name = "sse2";
+
+    if (BCJSONCPUSupportsAVX2()) {
+        // Whitespace runs are too short in practice to benefit from 32-byte vectors.
+        BCJSONScanFunctions.scanString = BCJSONScanStringAVX2;
+        BCJSONScanFunctions.isASCII = BCJSONIsASCIIAVX2;
+        BCJSONScanFunctions.name = "avx2";
+    }
+#elif BCJSON_NEON
+    // Every ARM CPU iOS runs on has NEON, so it is chosen at compile time.
+    BCJSONScanFunctions.scanString = BCJSONScanStringNEON;
+    BCJSONScanFunctions.skipWhitespace = BCJSONSkipWhitespaceNEON;
+    BCJSONScanFunctions.isASCII = BCJSONIsASCIINEON;
+    BCJSONScanFunctions.name = "neon";
+#endif
+}
+
+static inline void BCJSONScanInitialize(void)
+{
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, BCJSONScanSelectFunctions);
+}
+
+const uint8_t *BCJSONScanString(const uint8_t *p, const uint8_t *end)
+{
+    BCJSONScanInitialize();
+    return BCJSONScanFunctions.scanString(p, end);
+}
+
+const uint8_t *BCJSONSkipWhitespace(const uint8_t *p, const uint8_t *end)
+{
+    BCJSONScanInitialize();
+    return BCJSONScanFunctions.skipWhitespace(p, end);
+}
+
+bool BCJSONIsASCII(const uint8_t *p, const uint8_t *end)
+{
+    BCJSONScanInitialize();
+    return BCJSONScanFunctions.isASCII(p, end);
+}
+
+bool BCJSONValidateUTF8(const uint8_t *p, const uint8_t *end)
+{
+    BCJSONScanInitialize();
+
+    // Skip ASCII a vector at a time and only decode the blocks that contain multi-byte sequences.
+    while (p < end) {
+        const uint8_t *blockEnd = end - p > 64 ? p + 64 : end;
+        if (BCJSONScanFunctions.isASCII(p, blockEnd)) {
+            p = blockEnd;
+            continue;
+        }
+
+        // Validate up to the end of the block, extended past any sequence straddling it.
+        while (blockEnd < end && (*blockEnd & 0xC0) == 0x80) {
+            blockEnd++;
+        }
+        if (!BCJSONValidateUTF8Scalar(p, blockEnd)) {
+            return false;
+        }
+        p = blockEnd;
+    }
+    return true;
+}
+
+const char *BCJSONScanImplementation(void)
+{
+    BCJSONScanInitialize();
+    return BCJSONScanFunctions.name;
+}
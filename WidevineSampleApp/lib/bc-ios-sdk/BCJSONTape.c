@@ -0,0 +1,502 @@
+//
+//  BCJSONTape.c
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#include "BCJSONTape.h"
+#include "BCJSONScan.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define BCJSONTapeMaxDepth 512
+
+// Integers with more digits than this may not fit in a long long and are read as doubles.
+#define BCJSONTapeMaxIntegerDigits 18
+
+#define BCJSONTapeMaxNumberLength 63
+
+typedef struct BCJSONTapeParser {
+    BCJSONTape *tape;
+    const uint8_t *start;
+    const uint8_t *p;
+    const uint8_t *end;
+    unsigned int depth;
+    const char *errorMessage;
+} BCJSONTapeParser;
+
+static bool BCJSONTapeParseValue(BCJSONTapeParser *parser);
+
+static bool BCJSONTapeFail(BCJSONTapeParser *parser, const char *message)
+{
+    if (!parser->errorMessage) {
+        parser->errorMessage = message;
+    }
+    return false;
+}
+
+static inline void BCJSONTapeSkipWhitespace(BCJSONTapeParser *parser)
+{
+    parser->p = BCJSONSkipWhitespace(parser->p, parser->end);
+}
+
+/**
+ * Appends an entry and returns its index, or UINT32_MAX if memory ran out.
+ */
+static uint32_t BCJSONTapeAppend(BCJSONTapeParser *parser, BCJSONTapeType type, const uint8_t *offset)
+{
+    BCJSONTape *tape = parser->tape;
+    if (tape->count == tape->capacity) {
+        uint32_t capacity = tape->capacity ? tape->capacity * 2 : 64;
+        BCJSONTapeEntry *entries = realloc(tape->entries, capacity * sizeof(BCJSONTapeEntry));
+        if (!entries) {
+            BCJSONTapeFail(parser, "Out of memory.");
+            return UINT32_MAX;
+        }
+        tape->entries = entries;
+        tape->capacity = capacity;
+    }
+
+    uint32_t index = tape->count++;
+    BCJSONTapeEntry *entry = &tape->entries[index];
+    entry->type = type;
+    entry->flags = 0;
+    entry->offset = (uint32_t)(offset - parser->start);
+    entry->length = 0;
+    entry->next = index + 1;
+    return index;
+}
+
+static inline int BCJSONTapeHexValue(uint8_t c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ * Reads four hex digits at p, which must be in bounds. Returns -1 if any is invalid.
+ */
+static long BCJSONTapeHex4(const uint8_t *p)
+{
+    long value = 0;
+    for (int i = 0; i < 4; i++) {
+        int digit = BCJSONTapeHexValue(p[i]);
+        if (digit < 0) {
+            return -1;
+        }
+        value = (value << 4) | digit;
+    }
+    return value;
+}
+
+/**
+ * Validates one escape sequence; parser->p is on the backslash.
+ */
+static bool BCJSONTapeParseEscape(BCJSONTapeParser *parser)
+{
+    const uint8_t *p = parser->p + 1;
+    if (p >= parser->end) {
+        return BCJSONTapeFail(parser, "Unterminated string.");
+    }
+
+    switch (*p) {
+        case '"':
+        case '\\':
+        case '/':
+        case 'b':
+        case 'f':
+        case 'n':
+        case 'r':
+        case 't':
+            parser->p = p + 1;
+            return true;
+        case 'u':
+            break;
+        default:
+            return BCJSONTapeFail(parser, "Invalid escape sequence in string.");
+    }
+
+    if (parser->end - p < 5) {
+        return BCJSONTapeFail(parser, "Invalid escape sequence in string.");
+    }
+    long codeUnit = BCJSONTapeHex4(p + 1);
+    p += 5;
+    if (codeUnit < 0 || (codeUnit >= 0xDC00 && codeUnit <= 0xDFFF)) {
+        return BCJSONTapeFail(parser, "Invalid escape sequence in string.");
+    }
+    if (codeUnit >= 0xD800 && codeUnit <= 0xDBFF) {
+        // A high surrogate must be followed by an escaped low surrogate.
+        if (parser->end - p < 6 || p[0] != '\\' || p[1] != 'u') {
+            return BCJSONTapeFail(parser, "Unpaired surrogate in string.");
+        }
+        long low = BCJSONTapeHex4(p + 2);
+        if (low < 0xDC00 || low > 0xDFFF) {
+            return BCJSONTapeFail(parser, "Unpaired surrogate in string.");
+        }
+        p += 6;
+    }
+    parser->p = p;
+    return true;
+}
+
+/**
+ * parser->p is on the opening quote.
+ */
+static bool BCJSONTapeParseString(BCJSONTapeParser *parser)
+{
+    const uint8_t *contents = parser->p + 1;
+    uint32_t index = BCJSONTapeAppend(parser, BCJSONTapeTypeString, contents);
+    if (index == UINT32_MAX) {
+        return false;
+    }
+
+    uint8_t flags = 0;
+    parser->p = contents;
+    while (true) {
+        parser->p = BCJSONScanString(parser->p, parser->end);
+        if (parser->p >= parser->end) {
+            return BCJSONTapeFail(parser, "Unterminated string.");
+        }
+        if (*parser->p == '"') {
+            break;
+        }
+        if (*parser->p != '\\') {
+            return BCJSONTapeFail(parser, "Unescaped control character in string.");
+        }
+        flags |= BCJSONTapeFlagEscaped;
+        if (!BCJSONTapeParseEscape(parser)) {
+            return false;
+        }
+    }
+
+    if (BCJSONIsASCII(contents, parser->p)) {
+        flags |= BCJSONTapeFlagASCII;
+    }
+
+    BCJSONTapeEntry *entry = &parser->tape->entries[index];
+    entry->flags = flags;
+    entry->length = (uint32_t)(parser->p - contents);
+    parser->p++;
+    return true;
+}
+
+static inline bool BCJSONTapeIsDigit(const BCJSONTapeParser *parser, const uint8_t *p)
+{
+    return p < parser->end && *p >= '0' && *p <= '9';
+}
+
+static bool BCJSONTapeParseNumber(BCJSONTapeParser *parser)
+{
+    const uint8_t *start = parser->p;
+    const uint8_t *p = start;
+    bool integer = true;
+
+    if (p < parser->end && *p == '-') {
+        p++;
+    }
+    const uint8_t *digits = p;
+    while (BCJSONTapeIsDigit(parser, p)) {
+        p++;
+    }
+    size_t digitCount = p - digits;
+    if (digitCount == 0 || (digitCount > 1 && *digits == '0')) {
+        return BCJSONTapeFail(parser, "Invalid number.");
+    }
+
+    if (p < parser->end && *p == '.') {
+        integer = false;
+        p++;
+        if (!BCJSONTapeIsDigit(parser, p)) {
+            return BCJSONTapeFail(parser, "Invalid number.");
+        }
+        while (BCJSONTapeIsDigit(parser, p)) {
+            p++;
+        }
+    }
+    if (p < parser->end && (*p == 'e' || *p == 'E')) {
+        integer = false;
+        p++;
+        if (p < parser->end && (*p == '+' || *p == '-')) {
+            p++;
+        }
+        if (!BCJSONTapeIsDigit(parser, p)) {
+            return BCJSONTapeFail(parser, "Invalid number.");
+        }
+        while (BCJSONTapeIsDigit(parser, p)) {
+            p++;
+        }
+    }
+    if (p - start > BCJSONTapeMaxNumberLength) {
+        return BCJSONTapeFail(parser, "Number is too long.");
+    }
+
+    uint32_t index = BCJSONTapeAppend(parser, BCJSONTapeTypeNumber, start);
+    if (index == UINT32_MAX) {
+        return false;
+    }
+    BCJSONTapeEntry *entry = &parser->tape->entries[index];
+    entry->length = (uint32_t)(p - start);
+    if (integer && digitCount <= BCJSONTapeMaxIntegerDigits) {
+        entry->flags = BCJSONTapeFlagInteger;
+    }
+    parser->p = p;
+    return true;
+}
+
+static bool BCJSONTapeParseLiteral(BCJSONTapeParser *parser, BCJSONTapeType type, const char *literal, size_t length)
+{
+    if ((size_t)(parser->end - parser->p) < length || memcmp(parser->p, literal, length) != 0) {
+        return BCJSONTapeFail(parser, "Unexpected character.");
+    }
+    if (BCJSONTapeAppend(parser, type, parser->p) == UINT32_MAX) {
+        return false;
+    }
+    parser->p += length;
+    return true;
+}
+
+/**
+ * parser->p is on the opening bracket or brace.
+ */
+static bool BCJSONTapeParseContainer(BCJSONTapeParser *parser)
+{
+    bool isObject = *parser->p == '{';
+    uint8_t close = isObject ? '}' : ']';
+
+    if (parser->depth >= BCJSONTapeMaxDepth) {
+        return BCJSONTapeFail(parser, "Too many nested objects and arrays.");
+    }
+    uint32_t index = BCJSONTapeAppend(parser, isObject ? BCJSONTapeTypeObject : BCJSONTapeTypeArray, parser->p);
+    if (index == UINT32_MAX) {
+        return false;
+    }
+    parser->p++;
+    parser->depth++;
+
+    uint32_t members = 0;
+    BCJSONTapeSkipWhitespace(parser);
+    if (parser->p < parser->end && *parser->p == close) {
+        parser->p++;
+    } else {
+        while (true) {
+            if (isObject) {
+                BCJSONTapeSkipWhitespace(parser);
+                if (parser->p >= parser->end || *parser->p != '"') {
+                    return BCJSONTapeFail(parser, "Expected a string key in object.");
+                }
+                if (!BCJSONTapeParseString(parser)) {
+                    return false;
+                }
+                BCJSONTapeSkipWhitespace(parser);
+                if (parser->p >= parser->end || *parser->p != ':') {
+                    return BCJSONTapeFail(parser, "Expected ':' in object.");
+                }
+                parser->p++;
+            }
+            if (!BCJSONTapeParseValue(parser)) {
+                return false;
+            }
+            members++;
+
+            BCJSONTapeSkipWhitespace(parser);
+            if (parser->p < parser->end && *parser->p == ',') {
+                parser->p++;
+                continue;
+            }
+            if (parser->p < parser->end && *parser->p == close) {
+                parser->p++;
+                break;
+            }
+            return BCJSONTapeFail(parser, isObject ? "Expected ',' or '}' in object." : "Expected ',' or ']' in array.");
+        }
+    }
+
+    parser->depth--;
+    BCJSONTapeEntry *entry = &parser->tape->entries[index];
+    entry->length = members;
+    entry->next = parser->tape->count;
+    return true;
+}
+
+static bool BCJSONTapeParseValue(BCJSONTapeParser *parser)
+{
+    BCJSONTapeSkipWhitespace(parser);
+    if (parser->p >= parser->end) {
+        return BCJSONTapeFail(parser, "Unexpected end of data.");
+    }
+
+    switch (*parser->p) {
+        case '{':
+        case '[':
+            return BCJSONTapeParseContainer(parser);
+        case '"':
+            return BCJSONTapeParseString(parser);
+        case 't':
+            return BCJSONTapeParseLiteral(parser, BCJSONTapeTypeTrue, "true", 4);
+        case 'f':
+            return BCJSONTapeParseLiteral(parser, BCJSONTapeTypeFalse, "false", 5);
+        case 'n':
+            return BCJSONTapeParseLiteral(parser, BCJSONTapeTypeNull, "null", 4);
+        default:
+            if (*parser->p == '-' || (*parser->p >= '0' && *parser->p <= '9')) {
+                return BCJSONTapeParseNumber(parser);
+            }
+            return BCJSONTapeFail(parser, "Unexpected character.");
+    }
+}
+
+bool BCJSONTapeParse(BCJSONTape *tape, const uint8_t *bytes, size_t length, const char **errorMessage, size_t *errorOffset)
+{
+    BCJSONTapeParser parser;
+    memset(&parser, 0, sizeof(parser));
+    memset(tape, 0, sizeof(*tape));
+    parser.tape = tape;
+    parser.start = bytes;
+    parser.p = bytes;
+    parser.end = bytes + length;
+
+    bool valid;
+    if (length > UINT32_MAX) {
+        valid = BCJSONTapeFail(&parser, "Document is too large.");
+    } else if (!BCJSONValidateUTF8(bytes, bytes + length)) {
+        valid = BCJSONTapeFail(&parser, "Data is not valid UTF-8.");
+    } else {
+        valid = BCJSONTapeParseValue(&parser);
+        BCJSONTapeSkipWhitespace(&parser);
+        if (valid && parser.p != parser.end) {
+            valid = BCJSONTapeFail(&parser, "Unexpected data after the JSON value.");
+        }
+    }
+
+    if (!valid) {
+        if (errorMessage) {
+            *errorMessage = parser.errorMessage;
+        }
+        if (errorOffset) {
+            *errorOffset = parser.p - parser.start;
+        }
+        BCJSONTapeFree(tape);
+    }
+    return valid;
+}
+
+void BCJSONTapeFree(BCJSONTape *tape)
+{
+    free(tape->entries);
+    memset(tape, 0, sizeof(*tape));
+}
+
+static size_t BCJSONTapeEncodeUTF8(uint32_t codePoint, uint8_t *out)
+{
+    if (codePoint < 0x80) {
+        out[0] = codePoint;
+        return 1;
+    }
+    if (codePoint < 0x800) {
+        out[0] = 0xC0 | (codePoint >> 6);
+        out[1] = 0x80 | (codePoint & 0x3F);
+        return 2;
+    }
+    if (codePoint < 0x10000) {
+        out[0] = 0xE0 | (codePoint >> 12);
+        out[1] = 0x80 | ((codePoint >> 6) & 0x3F);
+        out[2] = 0x80 | (codePoint & 0x3F);
+        return 3;
+    }
+    out[0] = 0xF0 | (codePoint >> 18);
+    out[1] = 0x80 | ((codePoint >> 12) & 0x3F);
+    out[2] = 0x80 | ((codePoint >> 6) & 0x3F);
+    out[3] = 0x80 | (codePoint & 0x3F);
+    return 4;
+}
+
+size_t BCJSONTapeDecodeString(const BCJSONTapeEntry *entry, const uint8_t *bytes, uint8_t *buffer)
+{
+    const uint8_t *p = bytes + entry->offset;
+    const uint8_t *end = p + entry->length;
+
+    if (!(entry->flags & BCJSONTapeFlagEscaped)) {
+        memcpy(buffer, p, entry->length);
+        return entry->length;
+    }
+
+    // The escapes were validated when the tape was built.
+    uint8_t *out = buffer;
+    while (p < end) {
+        const uint8_t *escape = memchr(p, '\\', end - p);
+        if (!escape) {
+            escape = end;
+        }
+        memcpy(out, p, escape - p);
+        out += escape - p;
+        p = escape;
+        if (p >= end) {
+            break;
+        }
+
+        uint8_t c = p[1];
+        p += 2;
+        switch (c) {
+            case 'b': *out++ = '\b'; break;
+            case 'f': *out++ = '\f'; break;
+            case 'n': *out++ = '\n'; break;
+            case 'r': *out++ = '\r'; break;
+            case 't': *out++ = '\t'; break;
+            case 'u': {
+                uint32_t codePoint = (uint32_t)BCJSONTapeHex4(p);
+                p += 4;
+                if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                    uint32_t low = (uint32_t)BCJSONTapeHex4(p + 2);
+                    p += 6;
+                    codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                }
+                out += BCJSONTapeEncodeUTF8(codePoint, out);
+                break;
+            }
+            default:
+                *out++ = c;
+                break;
+        }
+    }
+    return out - buffer;
+}
+
+long long BCJSONTapeIntegerValue(const BCJSONTapeEntry *entry, const uint8_t *bytes)
+{
+    const uint8_t *p = bytes + entry->offset;
+    const uint8_t *end = p + entry->length;
+    bool negative = *p == '-';
+    if (negative) {
+        p++;
+    }
+
+    long long value = 0;
+    while (p < end) {
+        value = value * 10 + (*p++ - '0');
+    }
+    return negative ? -value : value;
+}
+
+double BCJSONTapeDoubleValue(const BCJSONTapeEntry *entry, const uint8_t *bytes)
+{
+    if (entry->flags & BCJSONTapeFlagInteger) {
+        return (double)BCJSONTapeIntegerValue(entry, bytes);
+    }
+
+    // strtod needs a terminated string; numbers are short enough for the stack.
+    char text[BCJSONTapeMaxNumberLength + 1];
+    memcpy(text, bytes + entry->offset, entry->length);
+    text[entry->length] = '\0';
+    return strtod(text, NULL);
+}
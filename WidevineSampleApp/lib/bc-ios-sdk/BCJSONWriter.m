@@ -0,0 +1,441 @@
+//
+//  BCJSONWriter.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <errno.h>
+#import <unistd.h>
+
+#import "BCJSONWriter.h"
+#import "BCJSONScan.h"
+#import "BCPlaylist.h"
+#import "BCRendition.h"
+#import "BCRenditionSet.h"
+#import "BCVideo.h"
+
+#define BCJSONWriterInitialCapacity 4096
+
+// Writers with a file descriptor write out their buffer once it holds this much.
+#define BCJSONWriterFlushThreshold (64 * 1024)
+
+#define BCJSONWriterMaxDepth 64
+
+/*
+ * The escape for each byte: 0 if it is written as is, 'u' for \u00XX, or the
+ * character written after the backslash.
+ */
+static const uint8_t BCJSONWriterEscapes[256] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+};
+
+static const char BCJSONWriterHexDigits[16] = "0123456789abcdef";
+
+NSString * const BCJSONWriterErrorDomain = @"BCJSONWriterErrorDomain";
+
+@interface BCJSONWriter ()
+{
+    uint8_t *buffer;
+    NSUInteger length;
+    NSUInteger capacity;
+    int fileDescriptor;
+    NSUInteger depth;
+    NSUInteger overflowDepth;
+    BOOL needsComma[BCJSONWriterMaxDepth + 1];
+    BOOL afterKey;
+}
+
+@property (nonatomic, readwrite, retain) NSError *error;
+
+@end
+
+@implementation BCJSONWriter
+
+@synthesize error;
+
++ (NSData *)dataWithObject:(id)object
+{
+    BCJSONWriter *writer = [[BCJSONWriter alloc] init];
+    [writer writeObject:object];
+    NSData *data = [writer.data retain];
+    [writer release];
+    return [data autorelease];
+}
+
+- (id)init
+{
+    return [self initWithFileDescriptor:-1];
+}
+
+- (id)initWithFileDescriptor:(int)fd
+{
+    if (self = [super init]) {
+        fileDescriptor = fd;
+        capacity = BCJSONWriterInitialCapacity;
+        buffer = malloc(capacity);
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    if (fileDescriptor >= 0) {
+        [self flush];
+    }
+    free(buffer);
+    self.error = nil;
+
+    [super dealloc];
+}
+
+- (NSData *)data
+{
+    if (self.error) {
+        return nil;
+    }
+    return [NSData dataWithBytes:buffer length:length];
+}
+
+#pragma mark - Buffer
+
+/**
+ * Makes room for count more bytes and returns where they go.
+ */
+static inline uint8_t *BCJSONWriterReserve(BCJSONWriter *writer, NSUInteger count)
+{
+    if (writer->length + count > writer->capacity) {
+        if (writer->fileDescriptor >= 0 && writer->length >= BCJSONWriterFlushThreshold) {
+            [writer flush];
+        }
+        while (writer->length + count > writer->capacity) {
+            writer->capacity *= 2;
+        }
+        writer->buffer = realloc(writer->buffer, writer->capacity);
+    }
+    return writer->buffer + writer->length;
+}
+
+static inline void BCJSONWriterAppend(BCJSONWriter *writer, const void *bytes, NSUInteger count)
+{
+    memcpy(BCJSONWriterReserve(writer, count), bytes, count);
+    writer->length += count;
+}
+
+static inline void BCJSONWriterAppendByte(BCJSONWriter *writer, uint8_t byte)
+{
+    *BCJSONWriterReserve(writer, 1) = byte;
+    writer->length++;
+}
+
+- (BOOL)flush
+{
+    if (fileDescriptor < 0) {
+        return YES;
+    }
+
+    NSUInteger written = 0;
+    while (!self.error && written < length) {
+        ssize_t result = write(fileDescriptor, buffer + written, length - written);
+        if (result < 0) {
+            if (errno != EINTR) {
+                self.error = [NSError errorWithDomain:NSPOSIXErrorDomain code:errno userInfo:nil];
+            }
+            continue;
+        }
+        written += result;
+    }
+    length = 0;
+
+    return self.error == nil;
+}
+
+#pragma mark - Structure
+
+/**
+ * Writes the separator a value needs in its current position.
+ */
+- (void)beginValue
+{
+    if (afterKey) {
+        afterKey = NO;
+        return;
+    }
+    if (needsComma[depth]) {
+        BCJSONWriterAppendByte(self, ',');
+    }
+    needsComma[depth] = YES;
+}
+
+- (void)beginContainer:(uint8_t)open
+{
+    if (overflowDepth > 0 || depth >= BCJSONWriterMaxDepth) {
+        // Deeper than needsComma can track. Fail the write rather than overrun it, and
+        // count the container so its end is matched.
+        if (!self.error) {
+            self.error = [NSError errorWithDomain:BCJSONWriterErrorDomain code:BCJSONWriterErrorTooDeep userInfo:nil];
+        }
+        overflowDepth++;
+        return;
+    }
+    [self beginValue];
+    BCJSONWriterAppendByte(self, open);
+    needsComma[++depth] = NO;
+}
+
+- (void)endContainer:(uint8_t)close
+{
+    if (overflowDepth > 0) {
+        overflowDepth--;
+        return;
+    }
+    NSAssert(depth > 0, @"Unbalanced end of JSON container");
+    depth--;
+    BCJSONWriterAppendByte(self, close);
+}
+
+- (void)beginObject
+{
+    [self beginContainer:'{'];
+}
+
+- (void)endObject
+{
+    [self endContainer:'}'];
+}
+
+- (void)beginArray
+{
+    [self beginContainer:'['];
+}
+
+- (void)endArray
+{
+    [self endContainer:']'];
+}
+
+- (void)writeKey:(NSString *)key
+{
+    [self writeString:key];
+    BCJSONWriterAppendByte(self, ':');
+    afterKey = YES;
+}
+
+#pragma mark - Scalars
+
+/**
+ * Writes UTF-8 bytes as the contents of a string, escaping where needed.
+ */
+static void BCJSONWriterAppendEscaped(BCJSONWriter *writer, const uint8_t *p, const uint8_t *end)
+{
+    while (p < end) {
+        const uint8_t *special = BCJSONScanString(p, end);
+        BCJSONWriterAppend(writer, p, special - p);
+        if (special == end) {
+            return;
+        }
+
+        uint8_t escape = BCJSONWriterEscapes[*special];
+        if (escape == 'u') {
+            uint8_t sequence[6] = { '\\', 'u', '0', '0',
+                BCJSONWriterHexDigits[*special >> 4], BCJSONWriterHexDigits[*special & 0xF] };
+            BCJSONWriterAppend(writer, sequence, sizeof(sequence));
+        } else {
+            uint8_t sequence[2] = { '\\', escape };
+            BCJSONWriterAppend(writer, sequence, sizeof(sequence));
+        }
+        p = special + 1;
+    }
+}
+
+- (void)writeString:(NSString *)string
+{
+    [self beginValue];
+    BCJSONWriterAppendByte(self, '"');
+
+    // Converted by length rather than as a C string, so embedded NULs are written (as \u0000) too.
+    CFStringRef cfString = (CFStringRef)string;
+    CFIndex characterCount = CFStringGetLength(cfString);
+    if (characterCount > 0) {
+        // Convert straight into the output buffer, then check it for anything that needs escaping.
+        CFIndex maxLength = CFStringGetMaximumSizeForEncoding(characterCount, kCFStringEncodingUTF8);
+        uint8_t *start = BCJSONWriterReserve(self, maxLength);
+        CFIndex usedLength = 0;
+        CFStringGetBytes(cfString, CFRangeMake(0, characterCount), kCFStringEncodingUTF8, '?', false,
+                         start, maxLength, &usedLength);
+
+        const uint8_t *special = BCJSONScanString(start, start + usedLength);
+        if (special == start + usedLength) {
+            length += usedLength;
+        } else {
+            // Rare: copy the converted bytes aside, since escaping them in place would overwrite them.
+            NSUInteger cleanLength = special - start;
+            NSUInteger dirtyLength = usedLength - cleanLength;
+            uint8_t *dirty = malloc(dirtyLength);
+            memcpy(dirty, special, dirtyLength);
+            length += cleanLength;
+            BCJSONWriterAppendEscaped(self, dirty, dirty + dirtyLength);
+            free(dirty);
+        }
+    }
+
+    BCJSONWriterAppendByte(self, '"');
+}
+
+- (void)writeInteger:(long long)value
+{
+    [self beginValue];
+
+    char digits[24];
+    char *p = digits + sizeof(digits);
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    do {
+        *--p = '0' + (magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0) {
+        *--p = '-';
+    }
+    BCJSONWriterAppend(self, p, digits + sizeof(digits) - p);
+}
+
+- (void)writeDouble:(double)value
+{
+    if (!isfinite(value)) {
+        // JSON has no NaN or infinity.
+        [self writeNull];
+        return;
+    }
+
+    [self beginValue];
+    char text[32];
+    int count = snprintf(text, sizeof(text), "%.17g", value);
+    BCJSONWriterAppend(self, text, count);
+}
+
+- (void)writeBool:(BOOL)value
+{
+    [self beginValue];
+    if (value) {
+        BCJSONWriterAppend(self, "true", 4);
+    } else {
+        BCJSONWriterAppend(self, "false", 5);
+    }
+}
+
+- (void)writeNull
+{
+    [self beginValue];
+    BCJSONWriterAppend(self, "null", 4);
+}
+
+- (void)writeNumber:(NSNumber *)number
+{
+    if (CFGetTypeID((CFTypeRef)number) == CFBooleanGetTypeID()) {
+        [self writeBool:[number boolValue]];
+    } else if (CFNumberIsFloatType((CFNumberRef)number)) {
+        [self writeDouble:[number doubleValue]];
+    } else {
+        [self writeInteger:[number longLongValue]];
+    }
+}
+
+#pragma mark - Objects
+
+- (void)writeObject:(id)object
+{
+    if (!object || object == [NSNull null]) {
+        [self writeNull];
+    } else if ([object isKindOfClass:[NSString class]]) {
+        [self writeString:object];
+    } else if ([object isKindOfClass:[NSNumber class]]) {
+        [self writeNumber:object];
+    } else if ([object isKindOfClass:[NSDictionary class]]) {
+        [self beginObject];
+        for (id key in object) {
+            [self writeKey:[key description]];
+            [self writeObject:[object objectForKey:key]];
+        }
+        [self endObject];
+    } else if ([object isKindOfClass:[NSArray class]]) {
+        [self beginArray];
+        for (id element in object) {
+            [self writeObject:element];
+        }
+        [self endArray];
+    } else if ([object isKindOfClass:[NSURL class]]) {
+        [self writeString:[object absoluteString]];
+    } else if ([object isKindOfClass:[BCVideo class]]) {
+        [self writeVideo:object];
+    } else if ([object isKindOfClass:[BCPlaylist class]]) {
+        [self writePlaylist:object];
+    } else {
+        [self writeString:[object description]];
+    }
+}
+
+/**
+ * Writes a key and value if the value is present.
+ */
+- (void)writeKey:(NSString *)key object:(id)object
+{
+    if (object) {
+        [self writeKey:key];
+        [self writeObject:object];
+    }
+}
+
+- (void)writeVideo:(BCVideo *)video
+{
+    NSDictionary *properties = video.properties;
+
+    [self beginObject];
+    [self writeKey:@"id" object:[properties objectForKey:@"videoID"]];
+    [self writeKey:@"referenceId" object:[properties objectForKey:@"referenceID"]];
+    [self writeKey:@"pubID" object:[properties objectForKey:@"pubID"]];
+    [self writeKey:@"name" object:[properties objectForKey:@"name"]];
+    [self writeKey:@"shortDescription" object:[properties objectForKey:@"shortDescription"]];
+    [self writeKey:@"videoStillURL" object:[properties objectForKey:@"videoStillURL"]];
+    [self writeKey:@"customFields" object:[properties objectForKey:@"customFields"]];
+
+    NSArray *wvmRenditions = [properties objectForKey:@"WVMRenditions"];
+    if (wvmRenditions) {
+        [self writeKey:@"WVMRenditions" object:wvmRenditions];
+    } else if ([video.renditionSets count] > 0) {
+        // Videos without Widevine renditions play their FLVURL.
+        BCRenditionSet *renditionSet = [video.renditionSets objectAtIndex:0];
+        if ([renditionSet.renditions count] > 0) {
+            BCRendition *rendition = [renditionSet.renditions objectAtIndex:0];
+            [self writeKey:@"FLVURL" object:[rendition.properties objectForKey:@"url"]];
+        }
+    }
+    [self endObject];
+}
+
+- (void)writePlaylist:(BCPlaylist *)playlist
+{
+    NSDictionary *properties = playlist.properties;
+
+    [self beginObject];
+    [self writeKey:@"id" object:[properties objectForKey:@"playlistID"]];
+    [self writeKey:@"referenceId" object:[properties objectForKey:@"referenceID"]];
+    [self writeKey:@"name" object:[properties objectForKey:@"name"]];
+    [self writeKey:@"shortDescription" object:[properties objectForKey:@"shortDescription"]];
+    [self writeKey:@"thumbnailURL" object:[properties objectForKey:@"thumbnailURL"]];
+    [self writeKey:@"videos"];
+    [self beginArray];
+    for (BCVideo *video in playlist.videos) {
+        [self writeVideo:video];
+    }
+    [self endArray];
+    [self endObject];
+}
+
+@end
@@ -0,0 +1,390 @@
+//
+//  BCMediaRequest.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCMediaRequest.h"
+#import "BCAnalyticsBatcher.h"
+#import "BCConnectionWarmer.h"
+#import "BCMediaRequestManager.h"
+#import "BCMediaResponseCache.h"
+#import "BCNetworkActivityScheduler.h"
+#import "BCThroughputEstimator.h"
+
+#define BCHTTPStatusOK 200
+#define BCHTTPStatusNotModified 304
+#define BCHTTPStatusTooManyRequests 429
+#define BCHTTPStatusInternalServerError 500
+
+@class BCMediaRequestAttempt;
+
+@interface BCMediaRequest ()
+
+@property (nonatomic, retain) NSURLRequest *request;
+@property (nonatomic, retain) NSMutableArray *attempts;
+@property (nonatomic, retain) NSMutableArray *completionBlocks;
+@property (nonatomic) NSUInteger attemptCount;
+@property (nonatomic) BOOL finished;
+
+- (void)attempt:(BCMediaRequestAttempt *)attempt didFailWithError:(NSError *)error;
+- (void)attemptDidFinishLoading:(BCMediaRequestAttempt *)attempt;
+
+@end
+
+/**
+ * One connection made for a BCMediaRequest. A request makes several when it
+ * retries or hedges.
+ */
+@interface BCMediaRequestAttempt : NSObject <NSURLConnectionDataDelegate>
+
+@property (nonatomic, assign) BCMediaRequest *mediaRequest;
+@property (nonatomic, retain) NSURLConnection *connection;
+@property (nonatomic, retain) NSHTTPURLResponse *response;
+@property (nonatomic, retain) NSMutableData *receivedData;
+@property (nonatomic, retain) NSDate *startDate;
+@property (nonatomic, retain) NSDate *responseDate;
+
+@end
+
+@implementation BCMediaRequestAttempt
+
+@synthesize mediaRequest;
+@synthesize connection;
+@synthesize response;
+@synthesize receivedData;
+@synthesize startDate;
+@synthesize responseDate;
+
+- (void)dealloc
+{
+    [self cancel];
+
+    self.connection = nil;
+    self.response = nil;
+    self.receivedData = nil;
+    self.startDate = nil;
+    self.responseDate = nil;
+
+    [super dealloc];
+}
+
+- (void)startWithRequest:(NSURLRequest *)urlRequest timeout:(NSTimeInterval)timeout
+{
+    self.startDate = [NSDate date];
+    self.receivedData = [NSMutableData data];
+    self.connection = [NSURLConnection connectionWithRequest:urlRequest delegate:self];
+
+    // NSURLRequest's timeout only covers idle time; this bounds the whole attempt.
+    if (timeout > 0) {
+        [self performSelector:@selector(timeOut) withObject:nil afterDelay:timeout];
+    }
+}
+
+- (void)cancel
+{
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(timeOut) object:nil];
+    [self.connection cancel];
+    self.connection = nil;
+}
+
+- (void)timeOut
+{
+    [self cancel];
+    [self.mediaRequest attempt:self didFailWithError:[NSError errorWithDomain:NSURLErrorDomain
+                                                                         code:NSURLErrorTimedOut
+                                                                     userInfo:nil]];
+}
+
+- (NSTimeInterval)latency
+{
+    return -[self.startDate timeIntervalSinceNow];
+}
+
+/**
+ * Returns the time since the response arrived, which leaves out the DNS,
+ * connect and server time that say nothing about throughput.
+ */
+- (NSTimeInterval)transferDuration
+{
+    return -[self.responseDate timeIntervalSinceNow];
+}
+
+#pragma mark - NSURLConnectionDataDelegate
+
+- (void)connection:(NSURLConnection *)urlConnection didReceiveResponse:(NSURLResponse *)urlResponse
+{
+    self.responseDate = [NSDate date];
+    if ([urlResponse isKindOfClass:[NSHTTPURLResponse class]]) {
+        self.response = (NSHTTPURLResponse *)urlResponse;
+    }
+    [[BCConnectionWarmer sharedWarmer] connectionToURLWasUsed:[urlResponse URL]];
+    [[BCNetworkActivityScheduler sharedScheduler] networkWasUsed];
+    [[BCAnalyticsBatcher sharedBatcher] networkWasUsed];
+    [self.receivedData setLength:0];
+}
+
+- (void)connection:(NSURLConnection *)urlConnection didReceiveData:(NSData *)data
+{
+    [self.receivedData appendData:data];
+}
+
+- (NSCachedURLResponse *)connection:(NSURLConnection *)urlConnection willCacheResponse:(NSCachedURLResponse *)cachedResponse
+{
+    // BCMediaResponseCache already holds the body; don't keep a second copy in NSURLCache.
+    return nil;
+}
+
+- (void)connectionDidFinishLoading:(NSURLConnection *)urlConnection
+{
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(timeOut) object:nil];
+    self.connection = nil;
+    [[BCThroughputEstimator sharedEstimator] recordTransferOfBytes:[self.receivedData length] duration:[self transferDuration]];
+    [self.mediaRequest attemptDidFinishLoading:self];
+}
+
+- (void)connection:(NSURLConnection *)urlConnection didFailWithError:(NSError *)error
+{
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(timeOut) object:nil];
+    self.connection = nil;
+    [self.mediaRequest attempt:self didFailWithError:error];
+}
+
+@end
+
+@implementation BCMediaRequest
+
+@synthesize request;
+@synthesize attempts;
+@synthesize completionBlocks;
+@synthesize attemptCount;
+@synthesize finished;
+@synthesize manager;
+
+/**
+ * Returns YES if a failure may go away on its own, so the request is worth retrying.
+ */
++ (BOOL)isTransientError:(NSError *)error
+{
+    if (![[error domain] isEqualToString:NSURLErrorDomain]) {
+        return NO;
+    }
+
+    switch ([error code]) {
+        case NSURLErrorTimedOut:
+        case NSURLErrorCannotFindHost:
+        case NSURLErrorCannotConnectToHost:
+        case NSURLErrorNetworkConnectionLost:
+        case NSURLErrorDNSLookupFailed:
+        case NSURLErrorNotConnectedToInternet:
+        case NSURLErrorBadServerResponse:
+            return YES;
+        default:
+            return NO;
+    }
+}
+
+- (id)initWithRequest:(NSURLRequest *)mediaRequest
+{
+    if (self = [super init]) {
+        self.request = mediaRequest;
+        self.attempts = [NSMutableArray array];
+        self.completionBlocks = [NSMutableArray array];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    [self cancelAttempts];
+
+    self.request = nil;
+    self.attempts = nil;
+    self.completionBlocks = nil;
+
+    [super dealloc];
+}
+
+- (NSURL *)URL
+{
+    return [self.request URL];
+}
+
+- (NSString *)key
+{
+    return [BCMediaResponseCache cacheKeyForURL:self.URL];
+}
+
+- (BOOL)isCacheHit
+{
+    return [[[BCMediaResponseCache sharedCache] entryForURL:self.URL] isFresh];
+}
+
+- (void)addCompletionBlock:(BCMediaRequestCompletionBlock)completionBlock
+{
+    BCMediaRequestCompletionBlock block = [completionBlock copy];
+    [self.completionBlocks addObject:block];
+    [block release];
+}
+
+- (void)start
+{
+    BCMediaResponseCacheEntry *entry = [[BCMediaResponseCache sharedCache] entryForURL:self.URL];
+
+    if ([entry isFresh]) {
+        [self performSelector:@selector(finishWithEntry:) withObject:entry afterDelay:0];
+        return;
+    }
+
+    [self startAttempt];
+}
+
+#pragma mark - Attempts
+
+- (void)startAttempt
+{
+    if (self.finished) {
+        return;
+    }
+
+    BCMediaRequestAttempt *attempt = [[[BCMediaRequestAttempt alloc] init] autorelease];
+    attempt.mediaRequest = self;
+    [self.attempts addObject:attempt];
+    self.attemptCount++;
+
+    // Each attempt revalidates against whatever the cache holds when it starts.
+    [attempt startWithRequest:[[BCMediaResponseCache sharedCache] conditionalRequestForRequest:self.request]
+                      timeout:self.manager.attemptTimeout];
+    [[BCConnectionWarmer sharedWarmer] connectionToURLWasUsed:self.URL];
+
+    // Requests that outlast nearly all recent ones are usually stuck on a bad connection; a
+    // second copy often finishes first. Only the first attempt of a request is hedged.
+    NSTimeInterval hedgeDelay = [self.manager hedgeDelay];
+    if (self.attemptCount == 1 && hedgeDelay > 0) {
+        [self performSelector:@selector(hedge) withObject:nil afterDelay:hedgeDelay];
+    }
+}
+
+- (void)hedge
+{
+    if (self.finished || [self.attempts count] != 1 || self.attemptCount >= self.manager.maxAttempts) {
+        return;
+    }
+    if ([self.manager requestRetryToken]) {
+        [self startAttempt];
+    }
+}
+
+- (void)cancelAttempts
+{
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(hedge) object:nil];
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(startAttempt) object:nil];
+
+    for (BCMediaRequestAttempt *attempt in self.attempts) {
+        attempt.mediaRequest = nil;
+        [attempt cancel];
+    }
+    [self.attempts removeAllObjects];
+}
+
+- (void)attempt:(BCMediaRequestAttempt *)attempt didFailWithError:(NSError *)error
+{
+    [[attempt retain] autorelease];
+    attempt.mediaRequest = nil;
+    [self.attempts removeObject:attempt];
+
+    if ([self.attempts count] > 0) {
+        // A hedged copy is still in flight; let it finish the request.
+        return;
+    }
+
+    if (self.attemptCount < self.manager.maxAttempts &&
+        [BCMediaRequest isTransientError:error] &&
+        [self.manager requestRetryToken]) {
+        [self performSelector:@selector(startAttempt) withObject:nil afterDelay:[self.manager retryDelayForAttempt:self.attemptCount]];
+        return;
+    }
+
+    [self finishWithError:error entry:nil];
+}
+
+- (void)attemptDidFinishLoading:(BCMediaRequestAttempt *)attempt
+{
+    BCMediaResponseCache *cache = [BCMediaResponseCache sharedCache];
+    NSHTTPURLResponse *response = attempt.response;
+    NSInteger statusCode = [response statusCode];
+
+    if (response && (statusCode >= BCHTTPStatusInternalServerError || statusCode == BCHTTPStatusTooManyRequests)) {
+        NSString *message = [NSHTTPURLResponse localizedStringForStatusCode:statusCode];
+        [self attempt:attempt didFailWithError:[NSError errorWithDomain:NSURLErrorDomain
+                                                                   code:NSURLErrorBadServerResponse
+                                                               userInfo:[NSDictionary dictionaryWithObject:message forKey:NSLocalizedDescriptionKey]]];
+        return;
+    }
+
+    [[attempt retain] autorelease];
+    attempt.mediaRequest = nil;
+    [self.attempts removeObject:attempt];
+    [self.manager recordLatency:[attempt latency]];
+
+    if (statusCode == BCHTTPStatusNotModified) {
+        BCMediaResponseCacheEntry *entry = [cache revalidateWithResponse:response forURL:self.URL];
+        if (entry) {
+            [self finishWithEntry:entry];
+        } else {
+            // The entry was evicted while the conditional request was in flight.
+            [self finishWithError:[NSError errorWithDomain:NSURLErrorDomain code:NSURLErrorResourceUnavailable userInfo:nil]
+                            entry:nil];
+        }
+        return;
+    }
+
+    if (response && statusCode != BCHTTPStatusOK) {
+        NSString *message = [NSHTTPURLResponse localizedStringForStatusCode:statusCode];
+        [self finishWithError:[NSError errorWithDomain:NSURLErrorDomain
+                                                  code:NSURLErrorBadServerResponse
+                                              userInfo:[NSDictionary dictionaryWithObject:message forKey:NSLocalizedDescriptionKey]]
+                        entry:nil];
+        return;
+    }
+
+    NSData *data = [NSData dataWithData:attempt.receivedData];
+    BCMediaResponseCacheEntry *entry = [cache storeResponse:response data:data forURL:self.URL];
+    if (!entry) {
+        // Not cacheable; the waiting blocks still share one entry.
+        entry = [[[BCMediaResponseCacheEntry alloc] init] autorelease];
+        entry.data = data;
+    }
+    [self finishWithEntry:entry];
+}
+
+#pragma mark - Completion
+
+- (void)finishWithEntry:(BCMediaResponseCacheEntry *)entry
+{
+    [self finishWithError:nil entry:entry];
+}
+
+- (void)finishWithError:(NSError *)error entry:(BCMediaResponseCacheEntry *)entry
+{
+    if (self.finished) {
+        return;
+    }
+    self.finished = YES;
+
+    // Completion blocks may release the last reference to the request.
+    [[self retain] autorelease];
+
+    [self cancelAttempts];
+    [self.manager mediaRequestDidFinish:self];
+
+    for (BCMediaRequestCompletionBlock completionBlock in self.completionBlocks) {
+        completionBlock(error, entry);
+    }
+    [self.completionBlocks removeAllObjects];
+}
+
+@end
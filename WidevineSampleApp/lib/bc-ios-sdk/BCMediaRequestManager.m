@@ -0,0 +1,196 @@
+//
+//  BCMediaRequestManager.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCMediaRequestManager.h"
+
+#define BCMediaRequestManagerDefaultMaxConcurrentRequests 4
+#define BCMediaRequestManagerDefaultMaxAttempts 3
+#define BCMediaRequestManagerDefaultAttemptTimeout 15
+#define BCMediaRequestManagerDefaultBaseRetryDelay 0.5
+#define BCMediaRequestManagerDefaultMaxRetryDelay 8
+#define BCMediaRequestManagerDefaultRetryBudget 10
+#define BCMediaRequestManagerDefaultRetryBudgetRefill 0.2
+
+// Latencies of this many recent requests are kept to estimate the hedge delay.
+#define BCMediaRequestManagerLatencySampleCount 64
+
+// Requests aren't hedged until this many latencies have been recorded.
+#define BCMediaRequestManagerMinimumLatencySamples 20
+
+@interface BCMediaRequestManager ()
+{
+    NSTimeInterval latencySamples[BCMediaRequestManagerLatencySampleCount];
+    NSUInteger latencySampleCount;
+    NSUInteger nextLatencySample;
+    double retryTokens;
+}
+
+@property (nonatomic, retain) NSMutableDictionary *requestsByKey;
+@property (nonatomic, retain) NSMutableArray *pendingRequests;
+@property (nonatomic, retain) NSMutableSet *activeRequests;
+@property (nonatomic, readwrite) NSUInteger coalescedRequestCount;
+@property (nonatomic, readwrite) NSUInteger retryCount;
+
+@end
+
+@implementation BCMediaRequestManager
+
+@synthesize requestsByKey;
+@synthesize pendingRequests;
+@synthesize activeRequests;
+@synthesize maxConcurrentRequests;
+@synthesize coalescedRequestCount;
+@synthesize maxAttempts;
+@synthesize attemptTimeout;
+@synthesize baseRetryDelay;
+@synthesize maxRetryDelay;
+@synthesize retryBudget;
+@synthesize retryBudgetRefill;
+@synthesize hedgingEnabled;
+@synthesize retryCount;
+
++ (BCMediaRequestManager *)sharedManager
+{
+    static BCMediaRequestManager *sharedManager = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedManager = [[BCMediaRequestManager alloc] init];
+    });
+    return sharedManager;
+}
+
+- (id)init
+{
+    if (self = [super init]) {
+        self.requestsByKey = [NSMutableDictionary dictionary];
+        self.pendingRequests = [NSMutableArray array];
+        self.activeRequests = [NSMutableSet set];
+        self.maxConcurrentRequests = BCMediaRequestManagerDefaultMaxConcurrentRequests;
+        self.maxAttempts = BCMediaRequestManagerDefaultMaxAttempts;
+        self.attemptTimeout = BCMediaRequestManagerDefaultAttemptTimeout;
+        self.baseRetryDelay = BCMediaRequestManagerDefaultBaseRetryDelay;
+        self.maxRetryDelay = BCMediaRequestManagerDefaultMaxRetryDelay;
+        self.retryBudget = BCMediaRequestManagerDefaultRetryBudget;
+        self.retryBudgetRefill = BCMediaRequestManagerDefaultRetryBudgetRefill;
+        self.hedgingEnabled = YES;
+        retryTokens = self.retryBudget;
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    self.requestsByKey = nil;
+    self.pendingRequests = nil;
+    self.activeRequests = nil;
+
+    [super dealloc];
+}
+
+- (void)sendRequest:(NSURLRequest *)urlRequest completionBlock:(BCMediaRequestCompletionBlock)completionBlock
+{
+    BCMediaRequest *request = [[[BCMediaRequest alloc] initWithRequest:urlRequest] autorelease];
+    BCMediaRequest *existingRequest = [self.requestsByKey objectForKey:request.key];
+
+    if (existingRequest) {
+        self.coalescedRequestCount++;
+        [existingRequest addCompletionBlock:completionBlock];
+        return;
+    }
+
+    request.manager = self;
+    [request addCompletionBlock:completionBlock];
+    [self.requestsByKey setObject:request forKey:request.key];
+
+    if ([request isCacheHit]) {
+        // Cache hits don't open a connection, so they don't wait for a slot.
+        [self.activeRequests addObject:request];
+        [request start];
+    } else {
+        [self.pendingRequests addObject:request];
+        [self startPendingRequests];
+    }
+}
+
+- (void)mediaRequestDidFinish:(BCMediaRequest *)request
+{
+    [self.requestsByKey removeObjectForKey:request.key];
+    [self.activeRequests removeObject:request];
+    request.manager = nil;
+
+    [self startPendingRequests];
+}
+
+- (void)startPendingRequests
+{
+    while ([self.pendingRequests count] > 0 && [self.activeRequests count] < self.maxConcurrentRequests) {
+        BCMediaRequest *request = [self.pendingRequests objectAtIndex:0];
+        [self.activeRequests addObject:request];
+        [self.pendingRequests removeObjectAtIndex:0];
+        [request start];
+    }
+}
+
+#pragma mark - Retry policy
+
+- (NSTimeInterval)retryDelayForAttempt:(NSUInteger)attempt
+{
+    NSTimeInterval bound = self.baseRetryDelay;
+    for (NSUInteger i = 1; i < attempt && bound < self.maxRetryDelay; i++) {
+        bound *= 2;
+    }
+    bound = MIN(bound, self.maxRetryDelay);
+
+    // Full jitter: anywhere between no delay and the bound.
+    return bound * arc4random_uniform(1001) / 1000.0;
+}
+
+- (NSTimeInterval)hedgeDelay
+{
+    if (!self.hedgingEnabled || latencySampleCount < BCMediaRequestManagerMinimumLatencySamples) {
+        return 0;
+    }
+
+    NSTimeInterval sorted[BCMediaRequestManagerLatencySampleCount];
+    memcpy(sorted, latencySamples, latencySampleCount * sizeof(NSTimeInterval));
+    qsort_b(sorted, latencySampleCount, sizeof(NSTimeInterval), ^int(const void *a, const void *b) {
+        NSTimeInterval x = *(const NSTimeInterval *)a;
+        NSTimeInterval y = *(const NSTimeInterval *)b;
+        return x < y ? -1 : (x > y ? 1 : 0);
+    });
+    return sorted[(latencySampleCount * 95) / 100];
+}
+
+- (void)recordLatency:(NSTimeInterval)latency
+{
+    latencySamples[nextLatencySample] = latency;
+    nextLatencySample = (nextLatencySample + 1) % BCMediaRequestManagerLatencySampleCount;
+    latencySampleCount = MIN(latencySampleCount + 1, BCMediaRequestManagerLatencySampleCount);
+
+    retryTokens = MIN(retryTokens + self.retryBudgetRefill, self.retryBudget);
+}
+
+- (void)setRetryBudget:(double)budget
+{
+    retryBudget = budget;
+    // A smaller budget takes effect at once, rather than after the tokens already saved are spent.
+    retryTokens = MIN(retryTokens, retryBudget);
+}
+
+- (BOOL)requestRetryToken
+{
+    if (retryTokens < 1) {
+        return NO;
+    }
+    retryTokens -= 1;
+    self.retryCount++;
+    return YES;
+}
+
+@end
@@ -0,0 +1,274 @@
+//
+//  BCMediaResponseCache.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCMediaResponseCache.h"
+
+#define BCMediaResponseCacheDefaultCountLimit 32
+
+/**
+ * NSHTTPURLResponse does not canonicalize header names consistently across iOS versions
+ * (ETag may arrive as "Etag"), so header lookups ignore case.
+ */
+static NSString *BCHeaderValue(NSDictionary *headers, NSString *name)
+{
+    for (NSString *key in headers) {
+        if ([key caseInsensitiveCompare:name] == NSOrderedSame) {
+            return [headers objectForKey:key];
+        }
+    }
+    return nil;
+}
+
+@implementation BCMediaResponseCacheEntry
+
+@synthesize data;
+@synthesize etag;
+@synthesize lastModified;
+@synthesize expirationDate;
+@synthesize json;
+@synthesize object;
+
+- (void)dealloc
+{
+    self.data = nil;
+    self.etag = nil;
+    self.lastModified = nil;
+    self.expirationDate = nil;
+    self.json = nil;
+    self.object = nil;
+
+    [super dealloc];
+}
+
+- (BOOL)isFresh
+{
+    return self.expirationDate && [self.expirationDate timeIntervalSinceNow] > 0;
+}
+
+- (BOOL)canRevalidate
+{
+    return self.etag || self.lastModified;
+}
+
+@end
+
+@interface BCMediaResponseCache ()
+{
+    NSMutableDictionary *entries;
+    NSMutableArray *keysByUse;
+}
+
+@end
+
+@implementation BCMediaResponseCache
+
+@synthesize countLimit;
+
++ (BCMediaResponseCache *)sharedCache
+{
+    static BCMediaResponseCache *sharedCache = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedCache = [[BCMediaResponseCache alloc] init];
+    });
+    return sharedCache;
+}
+
++ (NSString *)cacheKeyForURL:(NSURL *)url
+{
+    NSString *query = [url query];
+    if (!query) {
+        return [url absoluteString];
+    }
+
+    NSMutableArray *params = [NSMutableArray array];
+    for (NSString *param in [query componentsSeparatedByString:@"&"]) {
+        if ([param hasPrefix:@"token="]) {
+            [params addObject:@"token=REDACTED"];
+        } else {
+            [params addObject:param];
+        }
+    }
+
+    NSString *absoluteString = [url absoluteString];
+    NSRange queryStart = [absoluteString rangeOfString:@"?"];
+    return [NSString stringWithFormat:@"%@?%@",
+            [absoluteString substringToIndex:queryStart.location],
+            [[params sortedArrayUsingSelector:@selector(compare:)] componentsJoinedByString:@"&"]];
+}
+
+- (id)init
+{
+    if (self = [super init]) {
+        entries = [[NSMutableDictionary alloc] init];
+        keysByUse = [[NSMutableArray alloc] init];
+        countLimit = BCMediaResponseCacheDefaultCountLimit;
+        [[BCCacheRegistry sharedRegistry] registerCache:self];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    [[BCCacheRegistry sharedRegistry] unregisterCache:self];
+    [entries release];
+    [keysByUse release];
+
+    [super dealloc];
+}
+
+- (BCMediaResponseCacheEntry *)entryForURL:(NSURL *)url
+{
+    NSString *key = [BCMediaResponseCache cacheKeyForURL:url];
+    BCMediaResponseCacheEntry *entry = [entries objectForKey:key];
+    if (entry) {
+        [self touchKey:key];
+    }
+
+    return entry;
+}
+
+- (NSURLRequest *)conditionalRequestForRequest:(NSURLRequest *)request
+{
+    BCMediaResponseCacheEntry *entry = [self entryForURL:[request URL]];
+    if (![entry canRevalidate]) {
+        return request;
+    }
+
+    NSMutableURLRequest *conditionalRequest = [[request mutableCopy] autorelease];
+
+    // Keep NSURLCache from answering the conditional request itself, so the 304 reaches us.
+    [conditionalRequest setCachePolicy:NSURLRequestReloadIgnoringLocalCacheData];
+    if (entry.etag) {
+        [conditionalRequest setValue:entry.etag forHTTPHeaderField:@"If-None-Match"];
+    }
+    if (entry.lastModified) {
+        [conditionalRequest setValue:entry.lastModified forHTTPHeaderField:@"If-Modified-Since"];
+    }
+
+    return conditionalRequest;
+}
+
+- (BCMediaResponseCacheEntry *)storeResponse:(NSHTTPURLResponse *)response data:(NSData *)data forURL:(NSURL *)url
+{
+    NSString *key = [BCMediaResponseCache cacheKeyForURL:url];
+    NSDictionary *headers = [response allHeaderFields];
+    NSString *cacheControl = [BCHeaderValue(headers, @"Cache-Control") lowercaseString];
+
+    if ([cacheControl rangeOfString:@"no-store"].location != NSNotFound) {
+        [self removeEntryForKey:key];
+        return nil;
+    }
+
+    BCMediaResponseCacheEntry *entry = [entries objectForKey:key];
+    if (![entry.data isEqualToData:data]) {
+        entry = [[[BCMediaResponseCacheEntry alloc] init] autorelease];
+        entry.data = data;
+    }
+    entry.etag = BCHeaderValue(headers, @"ETag");
+    entry.lastModified = BCHeaderValue(headers, @"Last-Modified");
+    entry.expirationDate = [self expirationDateForCacheControl:cacheControl];
+
+    [entries setObject:entry forKey:key];
+    [self touchKey:key];
+    [self evictToCountLimit];
+    [[BCCacheRegistry sharedRegistry] cacheDidGrow:self];
+
+    return entry;
+}
+
+- (BCMediaResponseCacheEntry *)revalidateWithResponse:(NSHTTPURLResponse *)response forURL:(NSURL *)url
+{
+    BCMediaResponseCacheEntry *entry = [self entryForURL:url];
+    NSDictionary *headers = [response allHeaderFields];
+
+    // A 304 may carry updated validators and freshness information.
+    if (BCHeaderValue(headers, @"ETag")) {
+        entry.etag = BCHeaderValue(headers, @"ETag");
+    }
+    if (BCHeaderValue(headers, @"Last-Modified")) {
+        entry.lastModified = BCHeaderValue(headers, @"Last-Modified");
+    }
+    entry.expirationDate = [self expirationDateForCacheControl:[BCHeaderValue(headers, @"Cache-Control") lowercaseString]];
+
+    return entry;
+}
+
+- (void)removeAllEntries
+{
+    [entries removeAllObjects];
+    [keysByUse removeAllObjects];
+}
+
+#pragma mark - BCRegisteredCache
+
+- (NSString *)cacheName
+{
+    return @"mediaResponses";
+}
+
+- (BCCacheTier)cacheTier
+{
+    return BCCacheTierResponses;
+}
+
+- (unsigned long long)cacheCost
+{
+    // Parsed responses are views over the body, so the bodies are most of the cost.
+    unsigned long long cost = 0;
+    for (BCMediaResponseCacheEntry *entry in [entries objectEnumerator]) {
+        cost += [entry.data length];
+    }
+    return cost;
+}
+
+- (void)trimToCost:(unsigned long long)cost
+{
+    while ([keysByUse count] > 0 && [self cacheCost] > cost) {
+        [self removeEntryForKey:[keysByUse objectAtIndex:0]];
+    }
+}
+
+#pragma mark - Private
+
+- (NSDate *)expirationDateForCacheControl:(NSString *)cacheControl
+{
+    if (!cacheControl || [cacheControl rangeOfString:@"no-cache"].location != NSNotFound) {
+        return nil;
+    }
+
+    NSRange maxAge = [cacheControl rangeOfString:@"max-age="];
+    if (maxAge.location == NSNotFound) {
+        return nil;
+    }
+
+    NSInteger seconds = [[cacheControl substringFromIndex:NSMaxRange(maxAge)] integerValue];
+    return seconds > 0 ? [NSDate dateWithTimeIntervalSinceNow:seconds] : nil;
+}
+
+- (void)touchKey:(NSString *)key
+{
+    [keysByUse removeObject:key];
+    [keysByUse addObject:key];
+}
+
+- (void)removeEntryForKey:(NSString *)key
+{
+    [entries removeObjectForKey:key];
+    [keysByUse removeObject:key];
+}
+
+- (void)evictToCountLimit
+{
+    while ([keysByUse count] > self.countLimit) {
+        [self removeEntryForKey:[keysByUse objectAtIndex:0]];
+    }
+}
+
+@end
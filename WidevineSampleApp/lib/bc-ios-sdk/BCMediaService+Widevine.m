@@ -7,12 +7,211 @@
 //
 
 #import "BCMediaService+Widevine.h"
+#import "BCConnectionWarmer.h"
+#import "BCMediaRequestManager.h"
+#import "BCMediaResponseCache.h"
+#import "BCError.h"
+#import "BCEvent.h"
+#import "BCJSONReader.h"
+#import "BCPlaylist.h"
+#import "BCRegisteringEventEmitter.h"
 #import "BCRendition.h"
 #import "BCVideo.h"
 #import "BCRenditionSet.h"
 
+#define BCMediaServiceDefaultBaseURL @"https://api.brightcove.com/services/library"
+
+/**
+ * Returns the value for key, or nil if it is missing or JSON null.
+ */
+static id BCJSONValue(NSDictionary *json, NSString *key)
+{
+    id value = [json objectForKey:key];
+    return [value isEqual:[NSNull null]] ? nil : value;
+}
+
+/**
+ * Returns a rendition for an item of WVMRenditions, with the url, encodingRate (bits per
+ * second), frameWidth, frameHeight, videoCodec and size reported by the Media API, or nil
+ * if its url is missing or malformed.
+ */
+static BCRendition *BCRenditionWithWVMRendition(NSDictionary *wvmRendition)
+{
+    NSString *url = BCJSONValue(wvmRendition, @"url");
+    NSURL *renditionURL = [url isKindOfClass:[NSString class]] ? [NSURL URLWithString:url] : nil;
+    if (!renditionURL) {
+        return nil;
+    }
+
+    NSMutableDictionary *properties = [NSMutableDictionary dictionaryWithObject:renditionURL forKey:@"url"];
+    for (NSString *key in [NSArray arrayWithObjects:@"encodingRate", @"frameWidth", @"frameHeight", @"size", nil]) {
+        id value = BCJSONValue(wvmRendition, key);
+        if ([value isKindOfClass:[NSNumber class]]) {
+            [properties setObject:value forKey:key];
+        }
+    }
+    id videoCodec = BCJSONValue(wvmRendition, @"videoCodec");
+    if ([videoCodec isKindOfClass:[NSString class]]) {
+        [properties setObject:videoCodec forKey:@"videoCodec"];
+    }
+
+    return [BCRendition renditionWithProperties:properties];
+}
+
+/**
+ * Returns an owned copy of the value for key, or nil. Responses are parsed into views
+ * that reference the response buffer, so anything a BCVideo or BCPlaylist keeps is
+ * copied out with this.
+ */
+static id BCJSONOwnedValue(NSDictionary *json, NSString *key)
+{
+    return [[BCJSONValue(json, key) copy] autorelease];
+}
+
+static NSString *BCURLEncode(NSString *string)
+{
+    return [(NSString *)CFURLCreateStringByAddingPercentEscapes(NULL,
+                                                                (CFStringRef)string,
+                                                                NULL,
+                                                                CFSTR("!*'();:@&=+$,/?%#[]"),
+                                                                kCFStringEncodingUTF8) autorelease];
+}
+
 @implementation BCMediaService (Widevine)
 
+/**
+ * This override is necessary because the stock service keeps a single connection, so a
+ * request made while another is in flight (a pull-to-refresh during the initial load, say)
+ * replaces the first one. BCCatalog sends the Media API query parameters as the event
+ * details.
+ */
+- (void)onFindVideo:(BCEvent *)event
+{
+    [self sendRequestWithParams:event.details responseBlock:^(BCError *error, id json, BCMediaResponseCacheEntry *entry) {
+        if (!error && ![json isKindOfClass:[NSDictionary class]]) {
+            error = [BCError errorWithCode:BCErrorCodeCatalogRequestError message:@"No video was found."];
+        }
+        if (error) {
+            [self.emitter respond:event emit:BCEventFoundVideo withDetails:[NSDictionary dictionaryWithObject:error forKey:@"error"]];
+            return;
+        }
+
+        // Requests coalesced onto this response share the video built for the first of them.
+        if (!entry.object) {
+            entry.object = [self makeVideoWithJSON:json];
+        }
+        [self.emitter respond:event emit:BCEventFoundVideo withDetails:[NSDictionary dictionaryWithObject:entry.object forKey:@"video"]];
+    }];
+}
+
+/**
+ * See onFindVideo:.
+ */
+- (void)onFindPlaylist:(BCEvent *)event
+{
+    [self sendRequestWithParams:event.details responseBlock:^(BCError *error, id json, BCMediaResponseCacheEntry *entry) {
+        if (!error && ![json isKindOfClass:[NSDictionary class]]) {
+            error = [BCError errorWithCode:BCErrorCodeCatalogRequestError message:@"No playlist was found."];
+        }
+        if (error) {
+            [self.emitter respond:event emit:BCEventFoundPlaylist withDetails:[NSDictionary dictionaryWithObject:error forKey:@"error"]];
+            return;
+        }
+
+        // An unchanged response (a 304, a fresh cache hit or a coalesced request) reuses the
+        // playlist that was already built from it.
+        if (!entry.object) {
+            entry.object = [self makePlaylistWithJSON:json];
+        }
+        [self.emitter respond:event emit:BCEventFoundPlaylist withDetails:[NSDictionary dictionaryWithObject:entry.object forKey:@"playlist"]];
+    }];
+}
+
++ (void)warmConnectionWithBaseURL:(NSString *)baseURL
+{
+    [[BCConnectionWarmer sharedWarmer] warmConnectionToURL:[NSURL URLWithString:(baseURL ? baseURL : BCMediaServiceDefaultBaseURL)]];
+}
+
+- (NSURLRequest *)requestWithParams:(NSDictionary *)params
+{
+    NSMutableArray *query = [NSMutableArray arrayWithCapacity:[params count] + 1];
+    for (NSString *name in [[params allKeys] sortedArrayUsingSelector:@selector(compare:)]) {
+        id value = [params objectForKey:name];
+        if ([name isEqualToString:@"token"] ||
+            (![value isKindOfClass:[NSString class]] && ![value isKindOfClass:[NSNumber class]])) {
+            continue;
+        }
+        [query addObject:[NSString stringWithFormat:@"%@=%@", BCURLEncode(name), BCURLEncode([value description])]];
+    }
+    [query addObject:[NSString stringWithFormat:@"token=%@", BCURLEncode(self.apiKey)]];
+
+    NSString *baseURL = self.baseURL ? self.baseURL : BCMediaServiceDefaultBaseURL;
+    NSURL *url = [NSURL URLWithString:[NSString stringWithFormat:@"%@?%@", baseURL, [query componentsJoinedByString:@"&"]]];
+    return [NSURLRequest requestWithURL:url];
+}
+
+- (void)sendRequestWithParams:(NSDictionary *)params responseBlock:(BCMediaServiceResponseBlock)responseBlock
+{
+    BCMediaServiceResponseBlock block = [[responseBlock copy] autorelease];
+
+    [[BCMediaRequestManager sharedManager] sendRequest:[self requestWithParams:params]
+                                       completionBlock:^(NSError *error, BCMediaResponseCacheEntry *entry) {
+        if (error) {
+            block([BCError errorWithCode:BCErrorCodeCatalogRequestError message:[error localizedDescription]], nil, nil);
+            return;
+        }
+
+        // Parse once per response, however many requests are waiting on it. Only the values
+        // the mappers read become objects.
+        if (!entry.json) {
+            NSError *parseError = nil;
+            entry.json = [[BCJSONReader readerForCurrentThread] viewWithData:entry.data error:&parseError];
+            if (parseError) {
+                block([BCError errorWithCode:BCErrorCodeCatalogRequestError message:[parseError localizedDescription]], nil, nil);
+                return;
+            }
+        }
+
+        // The Media API reports errors in the body of a 200 response.
+        if ([entry.json isKindOfClass:[NSDictionary class]] && BCJSONValue(entry.json, @"error")) {
+            block([BCError errorWithCode:BCErrorCodeCatalogRequestError message:[BCJSONValue(entry.json, @"error") description]], nil, nil);
+            return;
+        }
+
+        block(nil, entry.json, entry);
+    }];
+}
+
+/**
+ * This override maps playlist properties with the same keys makeVideoWithJSON: uses for videos.
+ */
+- (BCPlaylist *)makePlaylistWithJSON:(NSDictionary *)json
+{
+    NSMutableArray *videos = [NSMutableArray array];
+    for (NSDictionary *videoJSON in BCJSONValue(json, @"videos")) {
+        [videos addObject:[self makeVideoWithJSON:videoJSON]];
+    }
+
+    NSMutableDictionary *properties = [NSMutableDictionary dictionary];
+    if (BCJSONValue(json, @"name")) {
+        [properties setValue:BCJSONOwnedValue(json, @"name") forKey:@"name"];
+    }
+    if (BCJSONValue(json, @"shortDescription")) {
+        [properties setValue:BCJSONOwnedValue(json, @"shortDescription") forKey:@"shortDescription"];
+    }
+    if (BCJSONValue(json, @"referenceId")) {
+        [properties setValue:[NSString stringWithFormat:@"%@", BCJSONValue(json, @"referenceId")] forKey:@"referenceID"];
+    }
+    if (BCJSONValue(json, @"id")) {
+        [properties setValue:[NSString stringWithFormat:@"%@", BCJSONValue(json, @"id")] forKey:@"playlistID"];
+    }
+    if (BCJSONValue(json, @"thumbnailURL")) {
+        [properties setValue:[NSURL URLWithString:BCJSONOwnedValue(json, @"thumbnailURL")] forKey:@"thumbnailURL"];
+    }
+
+    return [BCPlaylist playlistWithVideos:videos properties:properties];
+}
+
 /**
  * This override is necessary because it is the only way to populate a BCVideo with the contents of the 
  * WVMRenditions property returned from the media api call.
@@ -24,7 +223,7 @@
     
     // Checking !=NULL, !=Nil, isEqual:Nil are not sufficient for JSON or dictionary objects.
     if([json objectForKey:@"WVMRenditions"] && ![[json objectForKey:@"WVMRenditions"] isEqual:[NSNull null]]) {
-        NSArray *wvmRenditions = (NSArray *) [json objectForKey:@"WVMRenditions"];
+        NSArray *wvmRenditions = BCJSONOwnedValue(json, @"WVMRenditions");
         [properties setValue:wvmRenditions forKey:@"WVMRenditions"];
         
         if ([wvmRenditions count] > 0) {
@@ -33,13 +232,13 @@
         }
     }
     if ([json objectForKey:@"videoStillURL"] && ![[json objectForKey:@"videoStillURL"] isEqual:[NSNull null]]) {
-        [properties setValue:[NSURL URLWithString:[json objectForKey:@"videoStillURL"]] forKey:@"videoStillURL"];
+        [properties setValue:[NSURL URLWithString:BCJSONOwnedValue(json, @"videoStillURL")] forKey:@"videoStillURL"];
     }
     if ([json objectForKey:@"name"] && ![[json objectForKey:@"name"] isEqual:[NSNull null]]) {
-        [properties setValue:[json objectForKey:@"name"] forKey:@"name"];
+        [properties setValue:BCJSONOwnedValue(json, @"name") forKey:@"name"];
     }
     if ([json objectForKey:@"shortDescription"] && ![[json objectForKey:@"shortDescription"] isEqual:[NSNull null]]) {
-        [properties setValue:[json objectForKey:@"shortDescription"] forKey:@"shortDescription"];
+        [properties setValue:BCJSONOwnedValue(json, @"shortDescription") forKey:@"shortDescription"];
     }
     if ([json objectForKey:@"referenceId"] && ![[json objectForKey:@"referenceId"] isEqual:[NSNull null]]) {
         [properties setValue:[NSString stringWithFormat:@"%@", [json objectForKey:@"referenceId"]] forKey:@"referenceID"];
@@ -48,7 +247,7 @@
         [properties setValue:[NSString stringWithFormat:@"%@", [json objectForKey:@"id"]] forKey:@"videoID"];
     }
     if ([json objectForKey:@"customFields"] && ![[json objectForKey:@"customFields"] isEqual:[NSNull null]]) {
-        [properties setValue:[json objectForKey:@"customFields"] forKey:@"customFields"];
+        [properties setValue:BCJSONOwnedValue(json, @"customFields") forKey:@"customFields"];
     }
     if ([json objectForKey:@"pubID"] && ![[json objectForKey:@"pubId"] isEqual:[NSNull null]]) {
         [properties setValue:[NSString stringWithFormat:@"%@", [json objectForKey:@"pubID"]] forKey:@"pubID"];
@@ -81,16 +280,26 @@
         }
     }
     
-    BCRendition *rendition = nil;
-    BCRenditionSet *renditionSet = nil;
+    // Every Widevine rendition is kept, lowest bitrate first, for the rendition selector to choose from.
+    NSMutableArray *renditions = [NSMutableArray array];
+    for (NSDictionary *item in [properties objectForKey:@"WVMRenditions"]) {
+        BCRendition *rendition = [item isKindOfClass:[NSDictionary class]] ? BCRenditionWithWVMRendition(item) : nil;
+        if (rendition) {
+            [renditions addObject:rendition];
+        }
+    }
+    [renditions sortUsingComparator:^NSComparisonResult(BCRendition *a, BCRendition *b) {
+        // A rendition without a rate sorts as 0.
+        double rateA = [[a.properties objectForKey:@"encodingRate"] doubleValue];
+        double rateB = [[b.properties objectForKey:@"encodingRate"] doubleValue];
+        return rateA < rateB ? NSOrderedAscending : (rateA > rateB ? NSOrderedDescending : NSOrderedSame);
+    }];
     
-    if (wvmRendition) {
-        rendition = [[[BCRendition alloc] initWithURL:[NSURL URLWithString:[wvmRendition objectForKey:@"url"]]] autorelease];
-    } else {
+    if ([renditions count] == 0) {
         // if no widevine rendition is found, attempt to playback the FLVURL as a normal video.
-        rendition = [[[BCRendition alloc] initWithURL:[NSURL URLWithString:[json objectForKey:@"FLVURL"]]] autorelease];
+        [renditions addObject:[[[BCRendition alloc] initWithURL:[NSURL URLWithString:[json objectForKey:@"FLVURL"]]] autorelease]];
     }
-    renditionSet = [[[BCRenditionSet alloc] initWithRenditions:[NSArray arrayWithObject:rendition]
+    BCRenditionSet *renditionSet = [[[BCRenditionSet alloc] initWithRenditions:renditions
                                                                 deliveryMethod:[NSDictionary dictionary]] autorelease];
     
     return [[[BCVideo alloc] initWithRenditionSets: [NSArray arrayWithObject:renditionSet]
@@ -0,0 +1,283 @@
+//
+//  BCNetworkActivityScheduler.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <mach/mach_time.h>
+
+#import "BCNetworkActivityScheduler.h"
+
+// A run this long after its deadline counts as late; less is timer slop.
+#define BCNetworkActivitySchedulerLateness 1.0
+
+/**
+ * Returns a monotonic time in seconds.
+ */
+static NSTimeInterval BCNetworkActivitySchedulerNow(void)
+{
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    return (double)mach_absolute_time() * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+/**
+ * A scheduled piece of work and its window.
+ */
+@interface BCNetworkActivityTask : NSObject
+
+@property (nonatomic, retain) NSString *name;
+@property (nonatomic, copy) BCNetworkActivityBlock block;
+@property (nonatomic) NSTimeInterval startTime;
+@property (nonatomic) NSTimeInterval deadline;
+@property (nonatomic) NSTimeInterval period;
+@property (nonatomic) NSTimeInterval tolerance;
+
+@end
+
+@implementation BCNetworkActivityTask
+
+@synthesize name;
+@synthesize block;
+@synthesize startTime;
+@synthesize deadline;
+@synthesize period;
+@synthesize tolerance;
+
+- (void)dealloc
+{
+    self.name = nil;
+    self.block = nil;
+
+    [super dealloc];
+}
+
+- (NSString *)description
+{
+    return [NSString stringWithFormat:@"<%@ %@ %.1f-%.1f>", [self class], self.name, self.startTime, self.deadline];
+}
+
+@end
+
+@interface BCNetworkActivityScheduler ()
+
+@property (nonatomic, retain) NSMutableArray *tasks;
+@property (nonatomic, retain) NSTimer *timer;
+@property (nonatomic) BOOL simulated;
+@property (nonatomic) NSTimeInterval simulatedTime;
+@property (nonatomic) NSTimeInterval creationTime;
+@property (nonatomic, readwrite) NSUInteger wakeUpCount;
+@property (nonatomic, readwrite) NSUInteger taskRunCount;
+@property (nonatomic, readwrite) NSUInteger lateRunCount;
+
+@end
+
+@implementation BCNetworkActivityScheduler
+
+@synthesize tasks;
+@synthesize timer;
+@synthesize simulated;
+@synthesize simulatedTime;
+@synthesize creationTime;
+@synthesize wakeUpCount;
+@synthesize taskRunCount;
+@synthesize lateRunCount;
+
++ (BCNetworkActivityScheduler *)sharedScheduler
+{
+    static BCNetworkActivityScheduler *sharedScheduler = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedScheduler = [[BCNetworkActivityScheduler alloc] init];
+    });
+    return sharedScheduler;
+}
+
+- (id)init
+{
+    if (self = [super init]) {
+        self.tasks = [NSMutableArray array];
+        self.creationTime = [self now];
+    }
+
+    return self;
+}
+
+- (id)initWithSimulatedClock
+{
+    if (self = [self init]) {
+        self.simulated = YES;
+        self.creationTime = 0;
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    [self.timer invalidate];
+    self.timer = nil;
+    self.tasks = nil;
+
+    [super dealloc];
+}
+
+- (NSTimeInterval)now
+{
+    return self.simulated ? self.simulatedTime : BCNetworkActivitySchedulerNow();
+}
+
+#pragma mark - Tasks
+
+- (id)addTaskNamed:(NSString *)name startTime:(NSTimeInterval)startTime deadline:(NSTimeInterval)deadline
+            period:(NSTimeInterval)period tolerance:(NSTimeInterval)tolerance block:(BCNetworkActivityBlock)block
+{
+    BCNetworkActivityTask *task = [[[BCNetworkActivityTask alloc] init] autorelease];
+    task.name = name;
+    task.block = block;
+    task.startTime = startTime;
+    task.deadline = MAX(deadline, startTime);
+    task.period = period;
+    task.tolerance = tolerance;
+    [self.tasks addObject:task];
+
+    [self scheduleTimer];
+    return task;
+}
+
+- (id)scheduleTaskNamed:(NSString *)name afterDelay:(NSTimeInterval)delay deadline:(NSTimeInterval)deadline block:(BCNetworkActivityBlock)block
+{
+    NSTimeInterval now = [self now];
+    return [self addTaskNamed:name startTime:now + delay deadline:now + deadline period:0 tolerance:0 block:block];
+}
+
+- (id)schedulePeriodicTaskNamed:(NSString *)name period:(NSTimeInterval)period tolerance:(NSTimeInterval)tolerance block:(BCNetworkActivityBlock)block
+{
+    if (period <= 0) {
+        return nil;
+    }
+    NSTimeInterval deadline = [self now] + period;
+    tolerance = MIN(tolerance, period);
+    return [self addTaskNamed:name startTime:deadline - tolerance deadline:deadline period:period tolerance:tolerance block:block];
+}
+
+- (void)cancelTask:(id)task
+{
+    if (task && [self.tasks indexOfObjectIdenticalTo:task] != NSNotFound) {
+        [self.tasks removeObjectIdenticalTo:task];
+        [self scheduleTimer];
+    }
+}
+
+/**
+ * Returns the task with the earliest deadline, or nil if there are none.
+ */
+- (BCNetworkActivityTask *)nextTask
+{
+    BCNetworkActivityTask *next = nil;
+    for (BCNetworkActivityTask *task in self.tasks) {
+        if (!next || task.deadline < next.deadline) {
+            next = task;
+        }
+    }
+    return next;
+}
+
+- (void)scheduleTimer
+{
+    [self.timer invalidate];
+    self.timer = nil;
+
+    BCNetworkActivityTask *next = [self nextTask];
+    if (!next || self.simulated) {
+        return;
+    }
+    self.timer = [NSTimer timerWithTimeInterval:MAX(next.deadline - [self now], 0)
+                                         target:self
+                                       selector:@selector(deadlineDidArrive)
+                                       userInfo:nil
+                                        repeats:NO];
+    // Common modes, so deadlines are kept while the user scrolls or scrubs.
+    [[NSRunLoop mainRunLoop] addTimer:self.timer forMode:NSRunLoopCommonModes];
+}
+
+- (void)deadlineDidArrive
+{
+    self.timer = nil;
+    self.wakeUpCount++;
+    [self runTasksAtTime:[self now]];
+}
+
+- (void)networkWasUsed
+{
+    [self runTasksAtTime:[self now]];
+}
+
+/**
+ * Runs every task whose window has opened at time, then sets the timer for the next deadline.
+ */
+- (void)runTasksAtTime:(NSTimeInterval)time
+{
+    NSMutableArray *due = [NSMutableArray array];
+    for (BCNetworkActivityTask *task in self.tasks) {
+        if (task.startTime <= time) {
+            [due addObject:task];
+        }
+    }
+
+    for (BCNetworkActivityTask *task in due) {
+        if (time > task.deadline + BCNetworkActivitySchedulerLateness) {
+            self.lateRunCount++;
+            NSLog(@"%s %@ ran %.1fs late", __PRETTY_FUNCTION__, task, time - task.deadline);
+        }
+
+        if (task.period > 0) {
+            // Keep the phase of the period, skipping any runs that were missed.
+            NSTimeInterval deadline = task.deadline + task.period;
+            while (deadline <= time) {
+                deadline += task.period;
+            }
+            task.deadline = deadline;
+            task.startTime = deadline - task.tolerance;
+        } else {
+            [[task retain] autorelease];
+            [self.tasks removeObjectIdenticalTo:task];
+        }
+
+        self.taskRunCount++;
+        if (task.block) {
+            task.block();
+        }
+    }
+
+    [self scheduleTimer];
+}
+
+- (void)advanceSimulatedClockBy:(NSTimeInterval)interval
+{
+    NSTimeInterval end = self.simulatedTime + interval;
+    BCNetworkActivityTask *next;
+    while ((next = [self nextTask]) && next.deadline <= end) {
+        self.simulatedTime = MAX(self.simulatedTime, next.deadline);
+        self.wakeUpCount++;
+        [self runTasksAtTime:self.simulatedTime];
+    }
+    self.simulatedTime = end;
+}
+
+#pragma mark - Statistics
+
+- (double)wakeUpsSavedPerHour
+{
+    NSTimeInterval elapsed = [self now] - self.creationTime;
+    if (elapsed <= 0) {
+        return 0;
+    }
+    return ((double)self.taskRunCount - self.wakeUpCount) * 3600 / elapsed;
+}
+
+@end
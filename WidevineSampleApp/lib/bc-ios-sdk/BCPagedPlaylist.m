@@ -0,0 +1,212 @@
+//
+//  BCPagedPlaylist.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCPagedPlaylist.h"
+#import "BCCatalog+Widevine.h"
+#import "BCPlaylist.h"
+
+#define BCPagedPlaylistDefaultMaxResidentPages 5
+
+// Approximate memory held by a BCVideo and its properties and renditions.
+#define BCPagedPlaylistEstimatedVideoCost 2048
+
+@interface BCPagedPlaylist ()
+
+@property (nonatomic, retain) BCCatalog *catalog;
+@property (nonatomic, retain) NSDictionary *options;
+@property (nonatomic, retain) NSMutableDictionary *pages;
+@property (nonatomic, retain) NSMutableSet *loadingPages;
+@property (nonatomic) NSUInteger loadedPageCount;
+@property (nonatomic) NSUInteger lastStoredPage;
+@property (nonatomic) NSUInteger totalCount;
+@property (nonatomic, readwrite) NSUInteger pageSize;
+
+@end
+
+@implementation BCPagedPlaylist
+
+@synthesize catalog;
+@synthesize options;
+@synthesize pages;
+@synthesize loadingPages;
+@synthesize loadedPageCount;
+@synthesize lastStoredPage;
+@synthesize totalCount;
+@synthesize pageSize;
+@synthesize maxResidentPages;
+
+- (id)initWithCatalog:(BCCatalog *)pageCatalog pageSize:(NSUInteger)size options:(NSDictionary *)queryOptions
+{
+    if (self = [super init]) {
+        self.catalog = pageCatalog;
+        self.options = queryOptions;
+        self.pageSize = MAX(size, 1);
+        self.pages = [NSMutableDictionary dictionary];
+        self.loadingPages = [NSMutableSet set];
+        self.totalCount = NSUIntegerMax;
+        self.maxResidentPages = BCPagedPlaylistDefaultMaxResidentPages;
+        [[BCCacheRegistry sharedRegistry] registerCache:self];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    [[BCCacheRegistry sharedRegistry] unregisterCache:self];
+
+    self.catalog = nil;
+    self.options = nil;
+    self.pages = nil;
+    self.loadingPages = nil;
+
+    [super dealloc];
+}
+
+- (NSUInteger)count
+{
+    return MIN(self.loadedPageCount * self.pageSize, self.totalCount);
+}
+
+- (BOOL)hasMorePages
+{
+    return self.count < self.totalCount;
+}
+
+- (BOOL)loadNextPageWithCompletionBlock:(BCPagedPlaylistCompletionBlock)completionBlock
+{
+    if (![self hasMorePages]) {
+        return NO;
+    }
+
+    return [self loadPage:self.loadedPageCount completionBlock:completionBlock];
+}
+
+- (BOOL)loadPageContainingIndex:(NSUInteger)index completionBlock:(BCPagedPlaylistCompletionBlock)completionBlock
+{
+    if (index >= self.count) {
+        return NO;
+    }
+
+    return [self loadPage:index / self.pageSize completionBlock:completionBlock];
+}
+
+- (BOOL)loadPage:(NSUInteger)pageNumber completionBlock:(BCPagedPlaylistCompletionBlock)completionBlock
+{
+    NSNumber *key = [NSNumber numberWithUnsignedInteger:pageNumber];
+    if ([self.pages objectForKey:key] || [self.loadingPages containsObject:key]) {
+        return NO;
+    }
+    [self.loadingPages addObject:key];
+
+    BCPagedPlaylistCompletionBlock block = [[completionBlock copy] autorelease];
+    [self.catalog findVideoPage:pageNumber pageSize:self.pageSize options:self.options callBlock:^(BCError *error, BCPlaylist *page) {
+        [self.loadingPages removeObject:key];
+        NSRange range = NSMakeRange(pageNumber * self.pageSize, 0);
+
+        if (page) {
+            NSArray *videos = page.videos;
+            range.length = [videos count];
+            [self storePage:videos number:pageNumber];
+
+            NSNumber *reportedCount = [page.properties objectForKey:@"totalCount"];
+            if (reportedCount) {
+                self.totalCount = [reportedCount unsignedIntegerValue];
+            } else if ([videos count] < self.pageSize) {
+                // A short page is the last one.
+                self.totalCount = NSMaxRange(range);
+            }
+            self.loadedPageCount = MAX(self.loadedPageCount, pageNumber + 1);
+        }
+
+        if (block) {
+            block(error, range);
+        }
+    }];
+
+    return YES;
+}
+
+- (void)storePage:(NSArray *)videos number:(NSUInteger)pageNumber
+{
+    [self.pages setObject:videos forKey:[NSNumber numberWithUnsignedInteger:pageNumber]];
+    self.lastStoredPage = pageNumber;
+    [self evictToPageCount:MAX(self.maxResidentPages, 1)];
+    [[BCCacheRegistry sharedRegistry] cacheDidGrow:self];
+}
+
+/**
+ * Evicts the pages farthest from the one loaded last, which is where the user is.
+ */
+- (void)evictToPageCount:(NSUInteger)pageCount
+{
+    NSUInteger pageNumber = self.lastStoredPage;
+    while ([self.pages count] > pageCount) {
+        NSNumber *farthestPage = nil;
+        NSUInteger farthestDistance = 0;
+        for (NSNumber *residentPage in self.pages) {
+            NSUInteger resident = [residentPage unsignedIntegerValue];
+            NSUInteger distance = resident > pageNumber ? resident - pageNumber : pageNumber - resident;
+            if (!farthestPage || distance > farthestDistance) {
+                farthestPage = residentPage;
+                farthestDistance = distance;
+            }
+        }
+        [self.pages removeObjectForKey:farthestPage];
+    }
+}
+
+#pragma mark - BCRegisteredCache
+
+- (NSString *)cacheName
+{
+    return @"playlistPages";
+}
+
+- (BCCacheTier)cacheTier
+{
+    return BCCacheTierPlaylists;
+}
+
+- (unsigned long long)cacheCost
+{
+    unsigned long long videoCount = 0;
+    for (NSArray *videos in [self.pages objectEnumerator]) {
+        videoCount += [videos count];
+    }
+    return videoCount * BCPagedPlaylistEstimatedVideoCost;
+}
+
+- (void)trimToCost:(unsigned long long)cost
+{
+    unsigned long long pageCost = (unsigned long long)self.pageSize * BCPagedPlaylistEstimatedVideoCost;
+
+    // The page loaded last is on screen, so it is always kept.
+    [self evictToPageCount:(NSUInteger)MAX(cost / pageCost, 1)];
+}
+
+- (BCVideo *)videoAtIndex:(NSUInteger)index
+{
+    NSArray *videos = [self.pages objectForKey:[NSNumber numberWithUnsignedInteger:index / self.pageSize]];
+    NSUInteger offset = index % self.pageSize;
+    return offset < [videos count] ? [videos objectAtIndex:offset] : nil;
+}
+
+- (NSUInteger)indexOfVideo:(BCVideo *)video
+{
+    for (NSNumber *residentPage in self.pages) {
+        NSUInteger offset = [[self.pages objectForKey:residentPage] indexOfObject:video];
+        if (offset != NSNotFound) {
+            return [residentPage unsignedIntegerValue] * self.pageSize + offset;
+        }
+    }
+
+    return NSNotFound;
+}
+
+@end
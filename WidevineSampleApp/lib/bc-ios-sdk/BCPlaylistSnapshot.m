@@ -0,0 +1,336 @@
+//
+//  BCPlaylistSnapshot.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCPlaylistSnapshot.h"
+#import "BCPlaylist.h"
+#import "BCRendition.h"
+#import "BCRenditionSet.h"
+#import "BCVideo.h"
+
+/*
+ * Snapshot layout, all integers little-endian:
+ *
+ *   uint32 magic ('BCPS'), uint32 version, uint32 video count
+ *   playlist fields, BCSnapshotFieldEnd
+ *   for each video: video fields, BCSnapshotFieldEnd
+ *
+ * Each field is a uint8 tag, a uint32 length and length bytes of UTF-8 text,
+ * except BCSnapshotFieldDuration which holds an int64.
+ *
+ * BCSnapshotFieldRendition is repeated once per rendition and holds the
+ * encoding rate, frame width, frame height, codec and URL separated by tabs.
+ * BCSnapshotFieldRenditionURL still holds the first rendition's URL so that
+ * readers which skip BCSnapshotFieldRendition can play the video.
+ */
+#define BCSnapshotMagic 0x53504342
+#define BCSnapshotVersion 1
+
+typedef enum BCSnapshotField {
+    BCSnapshotFieldEnd = 0,
+    BCSnapshotFieldName,
+    BCSnapshotFieldShortDescription,
+    BCSnapshotFieldReferenceID,
+    BCSnapshotFieldVideoID,
+    BCSnapshotFieldPlaylistID,
+    BCSnapshotFieldPubID,
+    BCSnapshotFieldVideoStillURL,
+    BCSnapshotFieldThumbnailURL,
+    BCSnapshotFieldDuration,
+    BCSnapshotFieldRenditionURL,
+    BCSnapshotFieldRendition,
+} BCSnapshotField;
+
+typedef struct BCSnapshotReader {
+    const uint8_t *bytes;
+    NSUInteger length;
+    NSUInteger offset;
+} BCSnapshotReader;
+
+static void BCSnapshotAppendUInt32(NSMutableData *data, uint32_t value)
+{
+    value = CFSwapInt32HostToLittle(value);
+    [data appendBytes:&value length:sizeof(value)];
+}
+
+static void BCSnapshotAppendString(NSMutableData *data, BCSnapshotField field, NSString *string)
+{
+    if (![string isKindOfClass:[NSString class]]) {
+        return;
+    }
+
+    // Convert by length, straight into data, so embedded NULs are kept and
+    // unpaired surrogates become '?' rather than failing the conversion.
+    CFStringRef cfString = (CFStringRef)string;
+    CFIndex characterCount = CFStringGetLength(cfString);
+    CFIndex maxLength = CFStringGetMaximumSizeForEncoding(characterCount, kCFStringEncodingUTF8);
+    uint8_t tag = field;
+    [data appendBytes:&tag length:sizeof(tag)];
+    NSUInteger lengthOffset = [data length];
+    BCSnapshotAppendUInt32(data, 0);
+
+    NSUInteger textOffset = [data length];
+    [data increaseLengthBy:maxLength];
+    CFIndex usedLength = 0;
+    CFStringGetBytes(cfString, CFRangeMake(0, characterCount), kCFStringEncodingUTF8, '?', false,
+                     (uint8_t *)[data mutableBytes] + textOffset, maxLength, &usedLength);
+    [data setLength:textOffset + usedLength];
+
+    uint32_t length = CFSwapInt32HostToLittle((uint32_t)usedLength);
+    [data replaceBytesInRange:NSMakeRange(lengthOffset, sizeof(length)) withBytes:&length];
+}
+
+static BOOL BCSnapshotReadBytes(BCSnapshotReader *reader, void *value, NSUInteger length)
+{
+    if (reader->length - reader->offset < length) {
+        return NO;
+    }
+    memcpy(value, reader->bytes + reader->offset, length);
+    reader->offset += length;
+    return YES;
+}
+
+/**
+ * Returns the BCSnapshotFieldRendition text for a rendition.
+ */
+static NSString *BCSnapshotRenditionString(BCRendition *rendition)
+{
+    NSDictionary *properties = rendition.properties;
+    return [NSString stringWithFormat:@"%lld\t%d\t%d\t%@\t%@",
+            [[properties objectForKey:@"encodingRate"] longLongValue],
+            [[properties objectForKey:@"frameWidth"] intValue],
+            [[properties objectForKey:@"frameHeight"] intValue],
+            [properties objectForKey:@"videoCodec"] ?: @"",
+            [[properties objectForKey:@"url"] absoluteString] ?: @""];
+}
+
+/**
+ * Returns the rendition described by BCSnapshotFieldRendition text, or nil if
+ * the text is malformed.
+ */
+static BCRendition *BCSnapshotRenditionWithString(NSString *string)
+{
+    NSArray *parts = [string componentsSeparatedByString:@"\t"];
+    if ([parts count] != 5) {
+        return nil;
+    }
+
+    NSURL *url = [NSURL URLWithString:[parts objectAtIndex:4]];
+    if (!url) {
+        return nil;
+    }
+    NSMutableDictionary *properties = [NSMutableDictionary dictionaryWithObject:url forKey:@"url"];
+    [properties setObject:[NSNumber numberWithLongLong:[[parts objectAtIndex:0] longLongValue]] forKey:@"encodingRate"];
+    [properties setObject:[NSNumber numberWithInt:[[parts objectAtIndex:1] intValue]] forKey:@"frameWidth"];
+    [properties setObject:[NSNumber numberWithInt:[[parts objectAtIndex:2] intValue]] forKey:@"frameHeight"];
+    if ([[parts objectAtIndex:3] length]) {
+        [properties setObject:[parts objectAtIndex:3] forKey:@"videoCodec"];
+    }
+    return [BCRendition renditionWithProperties:properties];
+}
+
+/**
+ * Reads fields up to BCSnapshotFieldEnd into a properties dictionary, using
+ * the same property keys as BCMediaService (Widevine). Renditions are added to
+ * renditions in the order they were written.
+ */
+static NSMutableDictionary *BCSnapshotReadFields(BCSnapshotReader *reader, NSURL **renditionURL, NSMutableArray *renditions)
+{
+    NSMutableDictionary *properties = [NSMutableDictionary dictionary];
+
+    while (YES) {
+        uint8_t tag;
+        uint32_t length;
+        if (!BCSnapshotReadBytes(reader, &tag, sizeof(tag))) {
+            return nil;
+        }
+        if (tag == BCSnapshotFieldEnd) {
+            return properties;
+        }
+        if (!BCSnapshotReadBytes(reader, &length, sizeof(length))) {
+            return nil;
+        }
+        length = CFSwapInt32LittleToHost(length);
+        if (reader->length - reader->offset < length) {
+            return nil;
+        }
+
+        const void *value = reader->bytes + reader->offset;
+        reader->offset += length;
+
+        if (tag == BCSnapshotFieldDuration) {
+            int64_t duration;
+            if (length != sizeof(duration)) {
+                return nil;
+            }
+            memcpy(&duration, value, sizeof(duration));
+            [properties setValue:[NSNumber numberWithLongLong:CFSwapInt64LittleToHost(duration)] forKey:@"duration"];
+            continue;
+        }
+
+        NSString *string = [[[NSString alloc] initWithBytes:value length:length encoding:NSUTF8StringEncoding] autorelease];
+        switch (tag) {
+            case BCSnapshotFieldName:
+                [properties setValue:string forKey:@"name"];
+                break;
+            case BCSnapshotFieldShortDescription:
+                [properties setValue:string forKey:@"shortDescription"];
+                break;
+            case BCSnapshotFieldReferenceID:
+                [properties setValue:string forKey:@"referenceID"];
+                break;
+            case BCSnapshotFieldVideoID:
+                [properties setValue:string forKey:@"videoID"];
+                break;
+            case BCSnapshotFieldPlaylistID:
+                [properties setValue:string forKey:@"playlistID"];
+                break;
+            case BCSnapshotFieldPubID:
+                [properties setValue:string forKey:@"pubID"];
+                break;
+            case BCSnapshotFieldVideoStillURL:
+                [properties setValue:[NSURL URLWithString:string] forKey:@"videoStillURL"];
+                break;
+            case BCSnapshotFieldThumbnailURL:
+                [properties setValue:[NSURL URLWithString:string] forKey:@"thumbnailURL"];
+                break;
+            case BCSnapshotFieldRenditionURL:
+                if (renditionURL) {
+                    *renditionURL = [NSURL URLWithString:string];
+                }
+                break;
+            case BCSnapshotFieldRendition: {
+                BCRendition *rendition = BCSnapshotRenditionWithString(string);
+                if (rendition) {
+                    [renditions addObject:rendition];
+                }
+                break;
+            }
+            default:
+                // Unknown fields come from a newer writer; skip them.
+                break;
+        }
+    }
+}
+
+@implementation BCPlaylistSnapshot
+
++ (NSData *)dataWithPlaylist:(BCPlaylist *)playlist
+{
+    NSMutableData *data = [NSMutableData dataWithCapacity:256 * [playlist.videos count]];
+
+    BCSnapshotAppendUInt32(data, BCSnapshotMagic);
+    BCSnapshotAppendUInt32(data, BCSnapshotVersion);
+    BCSnapshotAppendUInt32(data, (uint32_t)[playlist.videos count]);
+
+    NSDictionary *properties = playlist.properties;
+    BCSnapshotAppendString(data, BCSnapshotFieldName, [properties objectForKey:@"name"]);
+    BCSnapshotAppendString(data, BCSnapshotFieldShortDescription, [properties objectForKey:@"shortDescription"]);
+    BCSnapshotAppendString(data, BCSnapshotFieldReferenceID, [properties objectForKey:@"referenceID"]);
+    BCSnapshotAppendString(data, BCSnapshotFieldPlaylistID, [properties objectForKey:@"playlistID"]);
+    BCSnapshotAppendString(data, BCSnapshotFieldThumbnailURL, [[properties objectForKey:@"thumbnailURL"] absoluteString]);
+    [data appendBytes:"\0" length:1];
+
+    for (BCVideo *video in playlist.videos) {
+        properties = video.properties;
+        BCSnapshotAppendString(data, BCSnapshotFieldName, [properties objectForKey:@"name"]);
+        BCSnapshotAppendString(data, BCSnapshotFieldShortDescription, [properties objectForKey:@"shortDescription"]);
+        BCSnapshotAppendString(data, BCSnapshotFieldReferenceID, [properties objectForKey:@"referenceID"]);
+        BCSnapshotAppendString(data, BCSnapshotFieldVideoID, [properties objectForKey:@"videoID"]);
+        BCSnapshotAppendString(data, BCSnapshotFieldPubID, [properties objectForKey:@"pubID"]);
+        BCSnapshotAppendString(data, BCSnapshotFieldVideoStillURL, [[properties objectForKey:@"videoStillURL"] absoluteString]);
+
+        NSNumber *duration = [properties objectForKey:@"duration"];
+        if ([duration isKindOfClass:[NSNumber class]]) {
+            uint8_t tag = BCSnapshotFieldDuration;
+            int64_t value = CFSwapInt64HostToLittle([duration longLongValue]);
+            [data appendBytes:&tag length:sizeof(tag)];
+            BCSnapshotAppendUInt32(data, sizeof(value));
+            [data appendBytes:&value length:sizeof(value)];
+        }
+
+        BCRenditionSet *renditionSet = [video.renditionSets count] ? [video.renditionSets objectAtIndex:0] : nil;
+        BCRendition *rendition = [renditionSet.renditions count] ? [renditionSet.renditions objectAtIndex:0] : nil;
+        BCSnapshotAppendString(data, BCSnapshotFieldRenditionURL, [[rendition.properties objectForKey:@"url"] absoluteString]);
+        if ([rendition.properties objectForKey:@"encodingRate"]) {
+            for (BCRendition *each in renditionSet.renditions) {
+                BCSnapshotAppendString(data, BCSnapshotFieldRendition, BCSnapshotRenditionString(each));
+            }
+        }
+        [data appendBytes:"\0" length:1];
+    }
+
+    return data;
+}
+
++ (BCPlaylist *)playlistWithData:(NSData *)data
+{
+    BCSnapshotReader reader = { [data bytes], [data length], 0 };
+    uint32_t magic, version, count;
+
+    if (!BCSnapshotReadBytes(&reader, &magic, sizeof(magic)) ||
+        !BCSnapshotReadBytes(&reader, &version, sizeof(version)) ||
+        !BCSnapshotReadBytes(&reader, &count, sizeof(count))) {
+        return nil;
+    }
+    if (CFSwapInt32LittleToHost(magic) != BCSnapshotMagic || CFSwapInt32LittleToHost(version) != BCSnapshotVersion) {
+        return nil;
+    }
+    count = CFSwapInt32LittleToHost(count);
+
+    NSDictionary *playlistProperties = BCSnapshotReadFields(&reader, NULL, nil);
+    if (!playlistProperties) {
+        return nil;
+    }
+
+    NSMutableArray *videos = [NSMutableArray arrayWithCapacity:MIN(count, 1024)];
+    for (uint32_t i = 0; i < count; i++) {
+        NSURL *renditionURL = nil;
+        NSMutableArray *renditions = [NSMutableArray array];
+        NSDictionary *properties = BCSnapshotReadFields(&reader, &renditionURL, renditions);
+        if (!properties) {
+            return nil;
+        }
+
+        if ([renditions count] == 0) {
+            [renditions addObject:[[[BCRendition alloc] initWithURL:renditionURL] autorelease]];
+        }
+        BCRenditionSet *renditionSet = [[[BCRenditionSet alloc] initWithRenditions:renditions
+                                                                    deliveryMethod:[NSDictionary dictionary]] autorelease];
+        [videos addObject:[[[BCVideo alloc] initWithRenditionSets:[NSArray arrayWithObject:renditionSet]
+                                                       properties:properties] autorelease]];
+    }
+
+    return [BCPlaylist playlistWithVideos:videos properties:playlistProperties];
+}
+
++ (BCPlaylist *)playlistWithContentsOfFile:(NSString *)path
+{
+    NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:nil];
+    return data ? [self playlistWithData:data] : nil;
+}
+
++ (void)writePlaylist:(BCPlaylist *)playlist toFile:(NSString *)path
+{
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_BACKGROUND, 0), ^{
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        [[self dataWithPlaylist:playlist] writeToFile:path atomically:YES];
+        [pool drain];
+    });
+}
+
++ (BOOL)playlist:(BCPlaylist *)playlist hasSameContentAsPlaylist:(BCPlaylist *)otherPlaylist
+{
+    if ([playlist.videos count] != [otherPlaylist.videos count]) {
+        return NO;
+    }
+
+    // The encoding holds exactly what the table and the player use, so comparing it compares them.
+    return [[self dataWithPlaylist:playlist] isEqualToData:[self dataWithPlaylist:otherPlaylist]];
+}
+
+@end
@@ -0,0 +1,362 @@
+//
+//  BCQoEMonitor.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <mach/mach_time.h>
+
+#import "BCQoEMonitor.h"
+#import "BCEvent.h"
+#import "BCRegisteringEventEmitter.h"
+#import "BCWidevinePlugin.h"
+#import "BCJSONWriter.h"
+
+#define BCQoEMonitorMaxBounds 7
+
+// Upper bound of each bucket, per metric, in the metric's units.
+static const double BCQoEMonitorBounds[BCQoEMetricCount][BCQoEMonitorMaxBounds] = {
+    { 0.25, 0.5, 1, 2, 4, 8, 16 },
+    { 0, 1, 2, 4, 8 },
+    { 0, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2 },
+    { 250, 500, 1000, 1500, 2500, 4000 },
+    { 0, 1, 2, 4, 8 },
+};
+static const NSUInteger BCQoEMonitorBoundCounts[BCQoEMetricCount] = { 7, 5, 7, 6, 5 };
+
+// Names used in exportedData.
+static NSString *const BCQoEMonitorMetricNames[BCQoEMetricCount] = {
+    @"startupTime", @"rebufferCount", @"rebufferRatio", @"averageBitrate", @"bitrateSwitches",
+};
+
+// Context of the observation of the plugin's currentBitrate.
+static void *BCQoEMonitorBitrateContext = &BCQoEMonitorBitrateContext;
+
+/**
+ * Returns a monotonic time in seconds.
+ */
+static NSTimeInterval BCQoEMonitorNow(void)
+{
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    return (double)mach_absolute_time() * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+@interface BCQoEMonitor ()
+{
+    uint32_t bucketCounts[BCQoEMetricCount][BCQoEMonitorMaxBounds + 1];
+    double sums[BCQoEMetricCount];
+
+    // The current session. Times are from BCQoEMonitorNow(); 0 means not started.
+    BOOL sessionActive;
+    BOOL paused;
+    NSTimeInterval willPlayTime;
+    NSTimeInterval startupTime;
+    NSTimeInterval playStartTime;
+    NSTimeInterval stallStartTime;
+    NSTimeInterval playDuration;
+    NSTimeInterval stallDuration;
+    NSUInteger stallCount;
+    double bitrate;
+    double bitrateTime;
+    NSTimeInterval bitrateDuration;
+    NSTimeInterval bitrateStartTime;
+    NSUInteger bitrateChangeCount;
+}
+
+@property (nonatomic, readwrite) NSUInteger sessionCount;
+
+@end
+
+@implementation BCQoEMonitor
+
+@synthesize widevinePlugin;
+@synthesize sessionCount;
+
++ (NSArray *)allowedEmits
+{
+    return [NSArray array];
+}
+
++ (NSArray *)allowedListeners
+{
+    return [NSArray arrayWithObjects:BCEventDidSetVideo, BCEventVideoWillPlay, BCEventVideoDidPlay,
+            BCEventPlayerRateChange, BCEventVideoProgress, BCEventPlay, BCEventPause, BCEventVideoDidEnd, nil];
+}
+
+- (void)dealloc
+{
+    self.widevinePlugin = nil;
+
+    [super dealloc];
+}
+
+- (void)setWidevinePlugin:(BCWidevinePlugin *)plugin
+{
+    [widevinePlugin removeObserver:self forKeyPath:@"currentBitrate" context:BCQoEMonitorBitrateContext];
+    widevinePlugin = plugin;
+    [widevinePlugin addObserver:self forKeyPath:@"currentBitrate" options:0 context:BCQoEMonitorBitrateContext];
+}
+
+- (void)observeValueForKeyPath:(NSString *)keyPath ofObject:(id)object change:(NSDictionary *)change context:(void *)context
+{
+    if (context != BCQoEMonitorBitrateContext || ![keyPath isEqualToString:@"currentBitrate"]) {
+        [super observeValueForKeyPath:keyPath ofObject:object change:change context:context];
+        return;
+    }
+
+    // The plugin updates currentBitrate from the Widevine callback thread.
+    double value = [self.widevinePlugin.currentBitrate doubleValue];
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self recordBitrate:value];
+    });
+}
+
+- (void)setupEventListeners
+{
+    __block BCQoEMonitor *weakself = self;
+
+    [self.emitter on:BCEventDidSetVideo callBlock:^(BCEvent *event) {
+        [weakself endSession];
+    }];
+    [self.emitter on:BCEventVideoDidEnd callBlock:^(BCEvent *event) {
+        [weakself endSession];
+    }];
+    [self.emitter on:BCEventVideoWillPlay callBlock:^(BCEvent *event) {
+        [weakself videoWillPlay];
+    }];
+    [self.emitter on:BCEventVideoDidPlay callBlock:^(BCEvent *event) {
+        [weakself videoDidMove];
+    }];
+    [self.emitter on:BCEventVideoProgress callBlock:^(BCEvent *event) {
+        [weakself videoDidMove];
+    }];
+    [self.emitter on:BCEventPlay callBlock:^(BCEvent *event) {
+        [weakself setPaused:NO];
+    }];
+    [self.emitter on:BCEventPause callBlock:^(BCEvent *event) {
+        [weakself setPaused:YES];
+    }];
+    [self.emitter on:BCEventPlayerRateChange callBlock:^(BCEvent *event) {
+        id rate = [event.details objectForKey:@"newRate"] ?: [event.details objectForKey:@"rate"];
+        [weakself rateDidChange:[rate floatValue]];
+    }];
+}
+
+#pragma mark - Session
+
+- (void)videoWillPlay
+{
+    if (sessionActive) {
+        return;
+    }
+    sessionActive = YES;
+    paused = NO;
+    willPlayTime = BCQoEMonitorNow();
+    startupTime = -1;
+    playStartTime = 0;
+    stallStartTime = 0;
+    playDuration = 0;
+    stallDuration = 0;
+    stallCount = 0;
+    bitrateTime = 0;
+    bitrateDuration = 0;
+    bitrateChangeCount = 0;
+    bitrate = [self.widevinePlugin.currentBitrate doubleValue];
+}
+
+/**
+ * Adds the time played at the current bitrate since the last update to the average.
+ */
+- (void)accumulateBitrateAt:(NSTimeInterval)now
+{
+    if (bitrateStartTime > 0 && bitrate > 0) {
+        bitrateTime += bitrate * (now - bitrateStartTime);
+        bitrateDuration += now - bitrateStartTime;
+    }
+    bitrateStartTime = playStartTime > 0 ? now : 0;
+}
+
+/**
+ * Called on the first progress of a session, which ends startup, and on every later one.
+ */
+- (void)videoDidMove
+{
+    if (!sessionActive) {
+        return;
+    }
+    NSTimeInterval now = BCQoEMonitorNow();
+    if (startupTime < 0) {
+        startupTime = now - willPlayTime;
+    }
+    [self resumeAt:now];
+}
+
+/**
+ * Ends any stall and starts the play clock, if it isn't running.
+ */
+- (void)resumeAt:(NSTimeInterval)now
+{
+    if (stallStartTime > 0) {
+        stallDuration += now - stallStartTime;
+        stallStartTime = 0;
+    }
+    if (playStartTime == 0) {
+        playStartTime = now;
+        bitrateStartTime = now;
+    }
+}
+
+- (void)setPaused:(BOOL)isPaused
+{
+    paused = isPaused;
+}
+
+- (void)rateDidChange:(float)rate
+{
+    if (!sessionActive) {
+        return;
+    }
+    NSTimeInterval now = BCQoEMonitorNow();
+    if (rate > 0) {
+        // The rate goes up before the first frames are buffered, so it ends a
+        // stall but not startup, which waits for the video to progress.
+        if (startupTime >= 0) {
+            [self resumeAt:now];
+        }
+    } else if (playStartTime > 0) {
+        [self accumulateBitrateAt:now];
+        playDuration += now - playStartTime;
+        playStartTime = 0;
+        bitrateStartTime = 0;
+
+        // Stopping without being asked to is a stall.
+        if (!paused) {
+            stallStartTime = now;
+            stallCount++;
+        }
+    }
+}
+
+- (void)recordBitrate:(double)bitsPerSecond
+{
+    if (bitsPerSecond == bitrate) {
+        return;
+    }
+    if (sessionActive) {
+        [self accumulateBitrateAt:BCQoEMonitorNow()];
+        if (bitrate > 0) {
+            bitrateChangeCount++;
+        }
+    }
+    bitrate = bitsPerSecond;
+}
+
+- (void)addValue:(double)value forMetric:(BCQoEMetric)metric
+{
+    NSUInteger bucket = 0;
+    while (bucket < BCQoEMonitorBoundCounts[metric] && value > BCQoEMonitorBounds[metric][bucket]) {
+        bucket++;
+    }
+    bucketCounts[metric][bucket]++;
+    sums[metric] += value;
+}
+
+- (void)endSession
+{
+    if (!sessionActive) {
+        return;
+    }
+    NSTimeInterval now = BCQoEMonitorNow();
+    sessionActive = NO;
+
+    // A session that never started moving has no startup time or quality to report.
+    if (startupTime < 0) {
+        return;
+    }
+    if (playStartTime > 0) {
+        [self accumulateBitrateAt:now];
+        playDuration += now - playStartTime;
+        playStartTime = 0;
+    }
+    if (stallStartTime > 0) {
+        stallDuration += now - stallStartTime;
+        stallStartTime = 0;
+    }
+    bitrateStartTime = 0;
+
+    NSTimeInterval total = playDuration + stallDuration;
+    [self addValue:startupTime forMetric:BCQoEMetricStartupTime];
+    [self addValue:stallCount forMetric:BCQoEMetricRebufferCount];
+    [self addValue:(total > 0 ? stallDuration / total : 0) forMetric:BCQoEMetricRebufferRatio];
+    [self addValue:(bitrateDuration > 0 ? bitrateTime / bitrateDuration : bitrate) / 1000 forMetric:BCQoEMetricAverageBitrate];
+    [self addValue:bitrateChangeCount forMetric:BCQoEMetricBitrateSwitches];
+    self.sessionCount++;
+}
+
+#pragma mark - Histograms
+
+- (NSArray *)bucketBoundsForMetric:(BCQoEMetric)metric
+{
+    NSMutableArray *bounds = [NSMutableArray arrayWithCapacity:BCQoEMonitorBoundCounts[metric]];
+    for (NSUInteger i = 0; i < BCQoEMonitorBoundCounts[metric]; i++) {
+        [bounds addObject:[NSNumber numberWithDouble:BCQoEMonitorBounds[metric][i]]];
+    }
+    return bounds;
+}
+
+- (NSArray *)bucketCountsForMetric:(BCQoEMetric)metric
+{
+    NSMutableArray *counts = [NSMutableArray arrayWithCapacity:BCQoEMonitorBoundCounts[metric] + 1];
+    for (NSUInteger i = 0; i <= BCQoEMonitorBoundCounts[metric]; i++) {
+        [counts addObject:[NSNumber numberWithUnsignedInt:bucketCounts[metric][i]]];
+    }
+    return counts;
+}
+
+- (double)meanForMetric:(BCQoEMetric)metric
+{
+    return self.sessionCount ? sums[metric] / self.sessionCount : 0;
+}
+
+- (NSData *)exportedData
+{
+    BCJSONWriter *writer = [[[BCJSONWriter alloc] init] autorelease];
+    [writer beginObject];
+    [writer writeKey:@"sessions"];
+    [writer writeInteger:self.sessionCount];
+    for (NSUInteger metric = 0; metric < BCQoEMetricCount; metric++) {
+        [writer writeKey:BCQoEMonitorMetricNames[metric]];
+        [writer beginObject];
+        [writer writeKey:@"bounds"];
+        [writer beginArray];
+        for (NSUInteger i = 0; i < BCQoEMonitorBoundCounts[metric]; i++) {
+            [writer writeDouble:BCQoEMonitorBounds[metric][i]];
+        }
+        [writer endArray];
+        [writer writeKey:@"counts"];
+        [writer beginArray];
+        for (NSUInteger i = 0; i <= BCQoEMonitorBoundCounts[metric]; i++) {
+            [writer writeInteger:bucketCounts[metric][i]];
+        }
+        [writer endArray];
+        [writer writeKey:@"sum"];
+        [writer writeDouble:sums[metric]];
+        [writer endObject];
+    }
+    [writer endObject];
+    return [writer data];
+}
+
+- (void)reset
+{
+    memset(bucketCounts, 0, sizeof(bucketCounts));
+    memset(sums, 0, sizeof(sums));
+    self.sessionCount = 0;
+}
+
+@end
@@ -7,6 +7,7 @@
 //
 
 #import <objc/runtime.h>
+#import <UIKit/UIKit.h>
 
 #import "BCRenditionSelector+Widevine.h"
 #import "BCVideo.h"
@@ -15,17 +16,67 @@
 #import "BCEvent.h"
 #import "BCRegisteringEventEmitter.h"
 #import "BCPlayerItem.h"
+#import "BCThroughputEstimator.h"
 
 #import "WViPhoneAPI.h"
 
 #define WVError_TransformerUnsupportedConfiguration 4201
 
+#define BCRenditionSelectorBandwidthHeadroom 0.8
+
 @implementation BCRenditionSelector (Widevine)
 
-- (BCRendition *)selectFirstRendition:(BCVideo *)video
+/**
+ * Returns the renditions that pass test, or all of them if none does.
+ */
+static NSArray *BCRenditionsPassingTest(NSArray *renditions, BOOL (^test)(NSDictionary *properties))
+{
+    NSMutableArray *passing = [NSMutableArray arrayWithCapacity:[renditions count]];
+    for (BCRendition *rendition in renditions) {
+        if (test(rendition.properties)) {
+            [passing addObject:rendition];
+        }
+    }
+    return [passing count] ? passing : renditions;
+}
+
+- (BCRendition *)preferredRenditionForVideo:(BCVideo *)video
 {
     BCRenditionSet *renditionSet = [video.renditionSets objectAtIndex:0];
-    BCRendition *rendition = [renditionSet.renditions objectAtIndex:0];
+    NSArray *renditions = renditionSet.renditions;
+    if ([renditions count] < 2) {
+        return [renditions objectAtIndex:0];
+    }
+
+    renditions = BCRenditionsPassingTest(renditions, ^BOOL(NSDictionary *properties) {
+        NSString *codec = [properties objectForKey:@"videoCodec"];
+        return !codec || [codec caseInsensitiveCompare:@"H264"] == NSOrderedSame;
+    });
+
+    // Frame sizes are compared to the screen's pixels in either orientation.
+    UIScreen *screen = [UIScreen mainScreen];
+    CGFloat longSide = MAX(screen.bounds.size.width, screen.bounds.size.height) * screen.scale;
+    CGFloat shortSide = MIN(screen.bounds.size.width, screen.bounds.size.height) * screen.scale;
+    renditions = BCRenditionsPassingTest(renditions, ^BOOL(NSDictionary *properties) {
+        int width = [[properties objectForKey:@"frameWidth"] intValue];
+        int height = [[properties objectForKey:@"frameHeight"] intValue];
+        return MAX(width, height) <= longSide && MIN(width, height) <= shortSide;
+    });
+
+    // Renditions are sorted by encodingRate, lowest first.
+    double budget = [[BCThroughputEstimator sharedEstimator] estimatedBandwidth] * BCRenditionSelectorBandwidthHeadroom;
+    BCRendition *preferred = [renditions objectAtIndex:0];
+    for (BCRendition *rendition in renditions) {
+        if ([[rendition.properties objectForKey:@"encodingRate"] doubleValue] <= budget) {
+            preferred = rendition;
+        }
+    }
+    return preferred;
+}
+
+- (BCRendition *)selectFirstRendition:(BCVideo *)video
+{
+    BCRendition *rendition = [self preferredRenditionForVideo:video];
     NSURL *widevineUrl = [rendition.properties objectForKey:@"url"];
     NSString *widevineUrlStr = [widevineUrl absoluteString];
     
@@ -0,0 +1,161 @@
+//
+//  BCSeekCoalescer.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <mach/mach_time.h>
+
+#import "BCSeekCoalescer.h"
+#import "BCChapterIndex.h"
+
+// Seconds after which a seek that has not reported finishing is given up on.
+#define BCSeekCoalescerTimeout 1.0
+
+/**
+ * Returns a monotonic time in seconds.
+ */
+static NSTimeInterval BCSeekCoalescerNow(void)
+{
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    return (double)mach_absolute_time() * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+@interface BCSeekCoalescer ()
+{
+    BOOL inFlight;
+    NSTimeInterval inFlightTime;
+    BOOL hasPending;
+    NSTimeInterval pendingTarget;
+    BOOL pendingExact;
+}
+
+@property (nonatomic, copy) BCSeekBlock seekBlock;
+@property (nonatomic, readwrite) NSUInteger requestCount;
+@property (nonatomic, readwrite) NSUInteger seekCount;
+@property (nonatomic, readwrite) NSUInteger droppedCount;
+
+- (void)startPendingSeek;
+
+@end
+
+@implementation BCSeekCoalescer
+
+@synthesize chapterIndex;
+@synthesize chapterSnapTolerance;
+@synthesize seekBlock;
+@synthesize requestCount;
+@synthesize seekCount;
+@synthesize droppedCount;
+
+- (id)initWithSeekBlock:(BCSeekBlock)block
+{
+    if (self = [super init]) {
+        self.seekBlock = block;
+        self.chapterSnapTolerance = 1.5;
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    self.chapterIndex = nil;
+    self.seekBlock = nil;
+
+    [super dealloc];
+}
+
+/**
+ * Returns the time seeks in flight are timed by. Tests override it.
+ */
+- (NSTimeInterval)now
+{
+    return BCSeekCoalescerNow();
+}
+
+#pragma mark - Seeking
+
+/**
+ * For a seek that need not be exact, moves time to the nearest chapter start
+ * within chapterSnapTolerance. An exact seek keeps its time.
+ */
+- (NSTimeInterval)snappedTime:(NSTimeInterval)time exact:(BOOL)exact
+{
+    if (exact) {
+        return time;
+    }
+
+    NSUInteger count = self.chapterIndex.chapterCount;
+    if (count > 0) {
+        NSUInteger chapter = [self.chapterIndex chapterAtTime:time];
+        NSUInteger first = chapter == NSNotFound ? 0 : chapter;
+        NSUInteger last = MIN(first + 1, count - 1);
+
+        NSTimeInterval best = time;
+        NSTimeInterval bestDistance = self.chapterSnapTolerance;
+        for (NSUInteger i = first; i <= last; i++) {
+            NSTimeInterval start = [self.chapterIndex timeOfChapter:i];
+            if (fabs(start - time) <= bestDistance) {
+                best = start;
+                bestDistance = fabs(start - time);
+            }
+        }
+        return best;
+    }
+    return time;
+}
+
+- (NSTimeInterval)requestSeekTo:(NSTimeInterval)time exact:(BOOL)exact
+{
+    self.requestCount++;
+    NSTimeInterval target = [self snappedTime:MAX(time, 0) exact:exact];
+
+    if (inFlight && [self now] - inFlightTime > BCSeekCoalescerTimeout) {
+        inFlight = NO;
+    }
+
+    if (hasPending) {
+        self.droppedCount++;
+    }
+    hasPending = YES;
+    pendingTarget = target;
+    pendingExact = exact;
+
+    if (!inFlight) {
+        [self startPendingSeek];
+    }
+    return target;
+}
+
+- (void)startPendingSeek
+{
+    hasPending = NO;
+    inFlight = YES;
+    inFlightTime = [self now];
+    self.seekCount++;
+    if (self.seekBlock) {
+        self.seekBlock(pendingTarget, pendingExact);
+    }
+}
+
+- (void)seekDidFinish
+{
+    inFlight = NO;
+    if (hasPending) {
+        [self startPendingSeek];
+    }
+}
+
+- (void)reset
+{
+    inFlight = NO;
+    hasPending = NO;
+}
+
+@end
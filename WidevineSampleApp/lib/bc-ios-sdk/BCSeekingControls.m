@@ -0,0 +1,149 @@
+//
+//  BCSeekingControls.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCSeekingControls.h"
+#import "BCSeekCoalescer.h"
+#import "BCChapterIndex.h"
+#import "BCTimeFormatter.h"
+#import "BCEvent.h"
+#import "BCRegisteringEventEmitter.h"
+
+@interface BCSeekingControls ()
+
+@property (nonatomic, readwrite, retain) BCSeekCoalescer *seekCoalescer;
+
+- (void)emitSeekTo:(NSTimeInterval)time exact:(BOOL)exact;
+
+@end
+
+@implementation BCSeekingControls
+
+@synthesize seekCoalescer;
+
++ (NSArray *)allowedEmits
+{
+    NSArray *emits = [super allowedEmits];
+    return [emits containsObject:BCEventSeekTo] ? emits : [emits arrayByAddingObject:BCEventSeekTo];
+}
+
++ (NSArray *)allowedListeners
+{
+    return [[super allowedListeners] arrayByAddingObjectsFromArray:
+            [NSArray arrayWithObjects:BCEventDidSeekTo, BCEventDidSetVideo, nil]];
+}
+
+- (id)initWithEventEmitter:(BCEventEmitter *)eventEmitter andView:(UIView *)viewValue
+{
+    if (self = [super initWithEventEmitter:eventEmitter andView:viewValue]) {
+        __block BCSeekingControls *weakself = self;
+        self.seekCoalescer = [[[BCSeekCoalescer alloc] initWithSeekBlock:^(NSTimeInterval time, BOOL exact) {
+            [weakself emitSeekTo:time exact:exact];
+        }] autorelease];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    self.seekCoalescer = nil;
+
+    [super dealloc];
+}
+
+- (void)setupEventListeners
+{
+    [super setupEventListeners];
+
+    // Called from init, before seekCoalescer is set, so the blocks look it up when they run.
+    __block BCSeekingControls *weakself = self;
+    [self.emitter on:BCEventDidSeekTo callBlock:^(BCEvent *event) {
+        [weakself.seekCoalescer seekDidFinish];
+    }];
+    [self.emitter on:BCEventDidSetVideo callBlock:^(BCEvent *event) {
+        [weakself.seekCoalescer reset];
+    }];
+}
+
+#pragma mark - Seeking
+
+/**
+ * Returns the time, in seconds, at a value of the slider, which spans the duration.
+ */
+- (NSTimeInterval)timeForSliderValue:(float)value
+{
+    NSTimeInterval duration = CMTIME_IS_NUMERIC(self.duration) ? CMTimeGetSeconds(self.duration) : 0;
+    float range = self.progressBar.maximumValue - self.progressBar.minimumValue;
+    if (duration <= 0 || range <= 0) {
+        return value;
+    }
+    return (value - self.progressBar.minimumValue) / range * duration;
+}
+
+- (float)sliderValueForTime:(NSTimeInterval)time
+{
+    NSTimeInterval duration = CMTIME_IS_NUMERIC(self.duration) ? CMTimeGetSeconds(self.duration) : 0;
+    float range = self.progressBar.maximumValue - self.progressBar.minimumValue;
+    if (duration <= 0 || range <= 0) {
+        return time;
+    }
+    return self.progressBar.minimumValue + time / duration * range;
+}
+
+- (void)emitSeekTo:(NSTimeInterval)time exact:(BOOL)exact
+{
+    CMTime tolerance = exact ? kCMTimeZero : kCMTimePositiveInfinity;
+    NSValue *toleranceValue = [NSValue valueWithCMTime:tolerance];
+    [self emit:BCEventSeekTo withDetails:[NSDictionary dictionaryWithObjectsAndKeys:
+                                          [NSValue valueWithCMTime:CMTimeMakeWithSeconds(time, NSEC_PER_SEC)], @"time",
+                                          toleranceValue, @"toleranceBefore",
+                                          toleranceValue, @"toleranceAfter",
+                                          nil]];
+}
+
+/**
+ * Asks the coalescer for a seek to where the slider is and moves the slider
+ * and progress label to the snapped target.
+ */
+- (void)seekToSliderExact:(BOOL)exact
+{
+    NSTimeInterval target = [self.seekCoalescer requestSeekTo:[self timeForSliderValue:self.progressBar.value] exact:exact];
+    self.progressBar.value = [self sliderValueForTime:target];
+    self.progressLabel.text = [self formatTime:target];
+}
+
+#pragma mark - Other Methods
+
+- (NSString *)formatTime:(float)time
+{
+    // Called on every progress tick; the shared formatter answers repeat seconds without allocating.
+    return [[BCTimeFormatter sharedFormatter] stringForSeconds:time style:BCTimeFormatterStyleMinutesSeconds];
+}
+
+#pragma mark - UI Event Handlers
+
+- (IBAction)onSliderBegin:(id)sender
+{
+    self.seekCoalescer.chapterIndex = [BCChapterIndex currentChapterIndex];
+    [super onSliderBegin:sender];
+}
+
+- (IBAction)onSliderChange:(id)sender
+{
+    // Replaces the seek per change BCUIControls would emit.
+    [self seekToSliderExact:NO];
+}
+
+- (IBAction)onSliderEnd:(id)sender
+{
+    [self seekToSliderExact:YES];
+    // BCUIControls only emits BCEventSliderEnd here; it does not seek again.
+    [super onSliderEnd:sender];
+}
+
+@end
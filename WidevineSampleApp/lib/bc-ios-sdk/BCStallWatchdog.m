@@ -0,0 +1,491 @@
+//
+//  BCStallWatchdog.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <dlfcn.h>
+#import <pthread.h>
+#import <libkern/OSAtomic.h>
+#import <mach/mach.h>
+#import <mach/mach_time.h>
+#import <mach-o/dyld.h>
+
+#import "BCStallWatchdog.h"
+#import "BCJSONWriter.h"
+
+// Stalls kept for exportedReport.
+#define BCStallWatchdogRingSize 32
+
+// Deepest stack walked per sample.
+#define BCStallWatchdogMaxFrames 64
+
+// Symbolized addresses kept before the cache is emptied.
+#define BCStallWatchdogMaxCachedSymbols 4096
+
+/**
+ * Returns a mach_absolute_time() in seconds.
+ */
+static NSTimeInterval BCStallWatchdogSeconds(uint64_t machTime)
+{
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    return (double)machTime * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+/**
+ * Returns a monotonic time in seconds.
+ */
+static NSTimeInterval BCStallWatchdogNow(void)
+{
+    return BCStallWatchdogSeconds(mach_absolute_time());
+}
+
+/**
+ * Suspends thread, copies its program counter and the return addresses of its
+ * frames, which must lie between stackBottom and stackTop, into frames, and
+ * resumes it. Nothing here may take a lock the suspended thread could hold, so
+ * there is no allocation or messaging until the thread is resumed.
+ *
+ * @return the number of frames copied, or 0 if the thread couldn't be sampled.
+ */
+static NSUInteger BCStallWatchdogSampleThread(thread_t thread, uintptr_t stackBottom, uintptr_t stackTop,
+                                              uintptr_t *frames, NSUInteger maxFrames)
+{
+    if (thread_suspend(thread) != KERN_SUCCESS) {
+        return 0;
+    }
+
+    uintptr_t pc = 0;
+    uintptr_t fp = 0;
+    kern_return_t result;
+#if defined(__arm64__)
+    arm_thread_state64_t state;
+    mach_msg_type_number_t stateCount = ARM_THREAD_STATE64_COUNT;
+    result = thread_get_state(thread, ARM_THREAD_STATE64, (thread_state_t)&state, &stateCount);
+    pc = (uintptr_t)state.__pc;
+    fp = (uintptr_t)state.__fp;
+#elif defined(__arm__)
+    arm_thread_state_t state;
+    mach_msg_type_number_t stateCount = ARM_THREAD_STATE_COUNT;
+    result = thread_get_state(thread, ARM_THREAD_STATE, (thread_state_t)&state, &stateCount);
+    pc = state.__pc;
+    fp = state.__r[7];
+#elif defined(__x86_64__)
+    x86_thread_state64_t state;
+    mach_msg_type_number_t stateCount = x86_THREAD_STATE64_COUNT;
+    result = thread_get_state(thread, x86_THREAD_STATE64, (thread_state_t)&state, &stateCount);
+    pc = state.__rip;
+    fp = state.__rbp;
+#elif defined(__i386__)
+    i386_thread_state_t state;
+    mach_msg_type_number_t stateCount = i386_THREAD_STATE_COUNT;
+    result = thread_get_state(thread, i386_THREAD_STATE, (thread_state_t)&state, &stateCount);
+    pc = state.__eip;
+    fp = state.__ebp;
+#else
+    result = KERN_FAILURE;
+#endif
+
+    NSUInteger count = 0;
+    if (result == KERN_SUCCESS && pc) {
+        frames[count++] = pc;
+
+        // Each frame starts with the caller's frame pointer and the return address.
+        while (count < maxFrames &&
+               fp >= stackBottom && fp + 2 * sizeof(uintptr_t) <= stackTop &&
+               fp % sizeof(uintptr_t) == 0) {
+            uintptr_t *frame = (uintptr_t *)fp;
+            if (!frame[1]) {
+                break;
+            }
+            frames[count++] = frame[1];
+            if (frame[0] <= fp) {
+                break;
+            }
+            fp = frame[0];
+        }
+    }
+
+    thread_resume(thread);
+    return count;
+}
+
+/**
+ * One stall and its samples by call site.
+ */
+@interface BCStall : NSObject
+
+@property (nonatomic) NSTimeInterval time;
+@property (nonatomic) NSTimeInterval duration;
+@property (nonatomic) NSUInteger sampleCount;
+@property (nonatomic, retain) NSMutableDictionary *callSiteCounts;
+
+@end
+
+@implementation BCStall
+
+@synthesize time;
+@synthesize duration;
+@synthesize sampleCount;
+@synthesize callSiteCounts;
+
+- (id)init
+{
+    if (self = [super init]) {
+        self.callSiteCounts = [NSMutableDictionary dictionary];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    self.callSiteCounts = nil;
+
+    [super dealloc];
+}
+
+@end
+
+@interface BCStallWatchdog ()
+{
+    // mach_absolute_time() when the current pass of the main run loop began, or
+    // 0 while it waits. Written by the run loop observer, read by the watch thread.
+    volatile int64_t activityStart;
+
+    CFRunLoopObserverRef observer;
+    thread_t mainThread;
+    uintptr_t mainStackBottom;
+    uintptr_t mainStackTop;
+
+    // Used only by the watch thread.
+    uintptr_t frames[BCStallWatchdogMaxFrames];
+}
+
+@property (retain) NSThread *watchThread;
+
+// Guarded by @synchronized(self).
+@property (nonatomic, retain) NSMutableArray *stalls;
+@property (nonatomic) NSUInteger nextStallSlot;
+@property (nonatomic, readwrite) NSUInteger stallCount;
+@property (nonatomic) NSTimeInterval watchCPUTime;
+@property (nonatomic) NSTimeInterval watchedTime;
+
+// Used only by the watch thread.
+@property (nonatomic, retain) NSMutableDictionary *symbolCache;
+
+- (void)activityDidChange:(CFRunLoopActivity)activity;
+
+@end
+
+static void BCStallWatchdogObserve(CFRunLoopObserverRef observer, CFRunLoopActivity activity, void *info)
+{
+    [(BCStallWatchdog *)info activityDidChange:activity];
+}
+
+@implementation BCStallWatchdog
+
+@synthesize threshold;
+@synthesize sampleInterval;
+@synthesize watchThread;
+@synthesize stalls;
+@synthesize nextStallSlot;
+@synthesize stallCount;
+@synthesize watchCPUTime;
+@synthesize watchedTime;
+@synthesize symbolCache;
+
++ (BCStallWatchdog *)sharedWatchdog
+{
+    static BCStallWatchdog *sharedWatchdog = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedWatchdog = [[BCStallWatchdog alloc] init];
+    });
+    return sharedWatchdog;
+}
+
+- (id)init
+{
+    if (self = [super init]) {
+        self.threshold = 0.25;
+        self.sampleInterval = 0.01;
+        self.stalls = [NSMutableArray arrayWithCapacity:BCStallWatchdogRingSize];
+        self.symbolCache = [NSMutableDictionary dictionary];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    [self stop];
+    self.stalls = nil;
+    self.symbolCache = nil;
+
+    [super dealloc];
+}
+
+#pragma mark - Watching
+
+- (void)start
+{
+    if (observer) {
+        return;
+    }
+
+    pthread_t main = pthread_self();
+    mainThread = pthread_mach_thread_np(main);
+    mainStackTop = (uintptr_t)pthread_get_stackaddr_np(main);
+    mainStackBottom = mainStackTop - pthread_get_stacksize_np(main);
+
+    CFRunLoopObserverContext context = { 0, self, NULL, NULL, NULL };
+    CFOptionFlags activities = kCFRunLoopAfterWaiting | kCFRunLoopBeforeTimers | kCFRunLoopBeforeSources | kCFRunLoopBeforeWaiting;
+    observer = CFRunLoopObserverCreate(kCFAllocatorDefault, activities, YES, 0, BCStallWatchdogObserve, &context);
+    CFRunLoopAddObserver(CFRunLoopGetMain(), observer, kCFRunLoopCommonModes);
+
+    self.watchThread = [[[NSThread alloc] initWithTarget:self selector:@selector(watch) object:nil] autorelease];
+    [self.watchThread setName:@"BCStallWatchdog"];
+    [self.watchThread start];
+}
+
+- (void)stop
+{
+    if (!observer) {
+        return;
+    }
+    CFRunLoopRemoveObserver(CFRunLoopGetMain(), observer, kCFRunLoopCommonModes);
+    CFRunLoopObserverInvalidate(observer);
+    CFRelease(observer);
+    observer = NULL;
+    [self activityDidChange:kCFRunLoopBeforeWaiting];
+
+    // The thread notices and exits at its next check.
+    self.watchThread = nil;
+}
+
+/**
+ * Called on the main thread as the run loop moves between passes. Each batch
+ * of timers or sources starts a new pass, so a stall is one long handler.
+ */
+- (void)activityDidChange:(CFRunLoopActivity)activity
+{
+    int64_t start = activity == kCFRunLoopBeforeWaiting ? 0 : (int64_t)mach_absolute_time();
+    // The only writer, so adding the difference stores start atomically, even on 32-bit ARM.
+    OSAtomicAdd64Barrier(start - activityStart, &activityStart);
+}
+
+- (void)watch
+{
+    thread_t thread = mach_thread_self();
+    NSThread *currentThread = [NSThread currentThread];
+    NSTimeInterval watchStart = BCStallWatchdogNow();
+    int64_t stallStart = 0;
+    BCStall *stall = nil;
+
+    while (self.watchThread == currentThread) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        int64_t start = OSAtomicAdd64Barrier(0, &activityStart);
+        NSTimeInterval now = BCStallWatchdogNow();
+
+        if (stall && start != stallStart) {
+            stall.duration = now - BCStallWatchdogSeconds(stallStart);
+            [self recordStall:stall];
+            [stall release];
+            stall = nil;
+        }
+        if (start && now - BCStallWatchdogSeconds(start) >= self.threshold) {
+            if (!stall) {
+                stall = [[BCStall alloc] init];
+                stall.time = [[NSDate date] timeIntervalSince1970] - (now - BCStallWatchdogSeconds(start));
+                stallStart = start;
+            }
+            [self sampleIntoStall:stall];
+        }
+        [self updateOverheadOfThread:thread watchedTime:BCStallWatchdogNow() - watchStart];
+
+        NSTimeInterval sleep = stall ? self.sampleInterval : self.threshold / 4;
+        [pool drain];
+        [NSThread sleepForTimeInterval:sleep];
+    }
+
+    if (stall) {
+        stall.duration = BCStallWatchdogNow() - BCStallWatchdogSeconds(stallStart);
+        [self recordStall:stall];
+        [stall release];
+    }
+    mach_port_deallocate(mach_task_self(), thread);
+}
+
+- (void)updateOverheadOfThread:(thread_t)thread watchedTime:(NSTimeInterval)watched
+{
+    thread_basic_info_data_t info;
+    mach_msg_type_number_t count = THREAD_BASIC_INFO_COUNT;
+    if (thread_info(thread, THREAD_BASIC_INFO, (thread_info_t)&info, &count) != KERN_SUCCESS) {
+        return;
+    }
+    NSTimeInterval cpuTime = (info.user_time.seconds + info.system_time.seconds +
+                              (info.user_time.microseconds + info.system_time.microseconds) / 1e6);
+    @synchronized(self) {
+        self.watchCPUTime = cpuTime;
+        self.watchedTime = watched;
+    }
+}
+
+- (double)overhead
+{
+    @synchronized(self) {
+        return self.watchedTime > 0 ? self.watchCPUTime / self.watchedTime : 0;
+    }
+}
+
+#pragma mark - Sampling
+
+- (void)sampleIntoStall:(BCStall *)stall
+{
+    NSUInteger count = BCStallWatchdogSampleThread(mainThread, mainStackBottom, mainStackTop, frames, BCStallWatchdogMaxFrames);
+    if (count == 0) {
+        return;
+    }
+    NSString *callSite = [self callSiteForFrames:frames count:count];
+    NSUInteger callSiteCount = [[stall.callSiteCounts objectForKey:callSite] unsignedIntegerValue];
+    [stall.callSiteCounts setObject:[NSNumber numberWithUnsignedInteger:callSiteCount + 1] forKey:callSite];
+    stall.sampleCount++;
+}
+
+/**
+ * Returns the innermost frame in the app's own image, or else the innermost
+ * frame, symbolized.
+ */
+- (NSString *)callSiteForFrames:(const uintptr_t *)frameAddresses count:(NSUInteger)count
+{
+    const struct mach_header *appHeader = _dyld_get_image_header(0);
+    for (NSUInteger i = 0; i < count; i++) {
+        // Return addresses point past the call; look up the call itself.
+        uintptr_t address = i == 0 ? frameAddresses[i] : frameAddresses[i] - 1;
+        Dl_info info;
+        if (dladdr((void *)address, &info) && info.dli_fbase == appHeader) {
+            return [self symbolForAddress:address];
+        }
+    }
+    return [self symbolForAddress:frameAddresses[0]];
+}
+
+- (NSString *)symbolForAddress:(uintptr_t)address
+{
+    NSNumber *key = [NSNumber numberWithUnsignedLong:address];
+    NSString *symbol = [self.symbolCache objectForKey:key];
+    if (symbol) {
+        return symbol;
+    }
+
+    Dl_info info;
+    if (!dladdr((void *)address, &info)) {
+        symbol = [NSString stringWithFormat:@"0x%lx", (unsigned long)address];
+    } else {
+        const char *image = info.dli_fname ? info.dli_fname : "?";
+        if (strrchr(image, '/')) {
+            image = strrchr(image, '/') + 1;
+        }
+        if (info.dli_sname) {
+            symbol = [NSString stringWithFormat:@"%s + %lu (%s)", info.dli_sname,
+                      (unsigned long)(address - (uintptr_t)info.dli_saddr), image];
+        } else {
+            symbol = [NSString stringWithFormat:@"%s + 0x%lx", image,
+                      (unsigned long)(address - (uintptr_t)info.dli_fbase)];
+        }
+    }
+
+    if ([self.symbolCache count] >= BCStallWatchdogMaxCachedSymbols) {
+        [self.symbolCache removeAllObjects];
+    }
+    [self.symbolCache setObject:symbol forKey:key];
+    return symbol;
+}
+
+#pragma mark - Report
+
+- (void)recordStall:(BCStall *)stall
+{
+    @synchronized(self) {
+        if ([self.stalls count] < BCStallWatchdogRingSize) {
+            [self.stalls addObject:stall];
+        } else {
+            [self.stalls replaceObjectAtIndex:self.nextStallSlot withObject:stall];
+        }
+        self.nextStallSlot = (self.nextStallSlot + 1) % BCStallWatchdogRingSize;
+        self.stallCount++;
+    }
+}
+
+/**
+ * Returns the stalls in the ring buffer, oldest first.
+ */
+- (NSArray *)recentStalls
+{
+    @synchronized(self) {
+        if ([self.stalls count] < BCStallWatchdogRingSize) {
+            return [NSArray arrayWithArray:self.stalls];
+        }
+        NSRange newer = NSMakeRange(0, self.nextStallSlot);
+        NSRange older = NSMakeRange(self.nextStallSlot, BCStallWatchdogRingSize - self.nextStallSlot);
+        return [[self.stalls subarrayWithRange:older] arrayByAddingObjectsFromArray:[self.stalls subarrayWithRange:newer]];
+    }
+}
+
+- (NSData *)exportedReport
+{
+    NSArray *recent = [self recentStalls];
+    NSMutableArray *stallReports = [NSMutableArray arrayWithCapacity:[recent count]];
+    NSMutableDictionary *callSites = [NSMutableDictionary dictionary];
+
+    for (BCStall *stall in recent) {
+        [stallReports addObject:[NSDictionary dictionaryWithObjectsAndKeys:
+                                 [NSNumber numberWithDouble:stall.time], @"time",
+                                 [NSNumber numberWithDouble:stall.duration], @"duration",
+                                 [NSNumber numberWithUnsignedInteger:stall.sampleCount], @"samples",
+                                 stall.callSiteCounts, @"callSites",
+                                 nil]];
+
+        // Each call site is charged the share of the stall its samples cover.
+        for (NSString *callSite in stall.callSiteCounts) {
+            NSUInteger count = [[stall.callSiteCounts objectForKey:callSite] unsignedIntegerValue];
+            NSDictionary *totals = [callSites objectForKey:callSite];
+            [callSites setObject:[NSDictionary dictionaryWithObjectsAndKeys:
+                                  callSite, @"callSite",
+                                  [NSNumber numberWithUnsignedInteger:[[totals objectForKey:@"samples"] unsignedIntegerValue] + count], @"samples",
+                                  [NSNumber numberWithUnsignedInteger:[[totals objectForKey:@"stalls"] unsignedIntegerValue] + 1], @"stalls",
+                                  [NSNumber numberWithDouble:[[totals objectForKey:@"duration"] doubleValue] +
+                                   stall.duration * count / stall.sampleCount], @"duration",
+                                  nil]
+                          forKey:callSite];
+        }
+    }
+
+    NSArray *sortedCallSites = [[callSites allValues] sortedArrayUsingComparator:^NSComparisonResult(NSDictionary *a, NSDictionary *b) {
+        return [[b objectForKey:@"samples"] compare:[a objectForKey:@"samples"]];
+    }];
+
+    return [BCJSONWriter dataWithObject:[NSDictionary dictionaryWithObjectsAndKeys:
+                                         [NSNumber numberWithDouble:self.threshold], @"threshold",
+                                         [NSNumber numberWithUnsignedInteger:self.stallCount], @"stallCount",
+                                         [NSNumber numberWithDouble:[self overhead]], @"overhead",
+                                         stallReports, @"stalls",
+                                         sortedCallSites, @"callSites",
+                                         nil]];
+}
+
+- (void)reset
+{
+    @synchronized(self) {
+        [self.stalls removeAllObjects];
+        self.nextStallSlot = 0;
+    }
+}
+
+@end
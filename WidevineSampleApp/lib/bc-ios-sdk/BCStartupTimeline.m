@@ -0,0 +1,141 @@
+//
+//  BCStartupTimeline.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <mach/mach_time.h>
+
+#import "BCStartupTimeline.h"
+
+/**
+ * Returns a monotonic time in seconds.
+ */
+static NSTimeInterval BCStartupTimelineNow(void)
+{
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    return (double)mach_absolute_time() * timebase.numer / timebase.denom / NSEC_PER_SEC;
+}
+
+@interface BCStartupTimeline ()
+
+@property (nonatomic) NSTimeInterval startTime;
+@property (nonatomic, retain) NSMutableDictionary *phaseStarts;
+@property (nonatomic, retain) NSMutableDictionary *phaseEnds;
+@property (nonatomic, retain) NSMutableDictionary *milestones;
+@property (nonatomic, readwrite) BOOL isFinished;
+
+@end
+
+@implementation BCStartupTimeline
+
+@synthesize startTime;
+@synthesize phaseStarts;
+@synthesize phaseEnds;
+@synthesize milestones;
+@synthesize isFinished;
+
++ (BCStartupTimeline *)sharedTimeline
+{
+    static BCStartupTimeline *sharedTimeline = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedTimeline = [[BCStartupTimeline alloc] init];
+    });
+    return sharedTimeline;
+}
+
+- (id)init
+{
+    if (self = [super init]) {
+        self.startTime = BCStartupTimelineNow();
+        self.phaseStarts = [NSMutableDictionary dictionary];
+        self.phaseEnds = [NSMutableDictionary dictionary];
+        self.milestones = [NSMutableDictionary dictionary];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    self.phaseStarts = nil;
+    self.phaseEnds = nil;
+    self.milestones = nil;
+
+    [super dealloc];
+}
+
+/**
+ * Records the current time for name in times, unless it was recorded before.
+ */
+- (void)recordTimeForName:(NSString *)name inTimes:(NSMutableDictionary *)times
+{
+    if (self.isFinished || [times objectForKey:name]) {
+        return;
+    }
+    [times setObject:[NSNumber numberWithDouble:BCStartupTimelineNow() - self.startTime] forKey:name];
+}
+
+- (void)beginPhase:(NSString *)name
+{
+    [self recordTimeForName:name inTimes:self.phaseStarts];
+}
+
+- (void)endPhase:(NSString *)name
+{
+    if ([self.phaseStarts objectForKey:name]) {
+        [self recordTimeForName:name inTimes:self.phaseEnds];
+    }
+}
+
+- (void)markMilestone:(NSString *)name
+{
+    [self recordTimeForName:name inTimes:self.milestones];
+}
+
+- (NSTimeInterval)durationOfPhase:(NSString *)name
+{
+    NSNumber *end = [self.phaseEnds objectForKey:name];
+    if (!end) {
+        return -1;
+    }
+    return [end doubleValue] - [[self.phaseStarts objectForKey:name] doubleValue];
+}
+
+- (NSTimeInterval)timeOfMilestone:(NSString *)name
+{
+    NSNumber *time = [self.milestones objectForKey:name];
+    return time ? [time doubleValue] : -1;
+}
+
+- (void)finishWithMilestone:(NSString *)name
+{
+    if (self.isFinished) {
+        return;
+    }
+    [self markMilestone:name];
+    self.isFinished = YES;
+
+    NSMutableDictionary *startTimes = [NSMutableDictionary dictionaryWithDictionary:self.phaseStarts];
+    [startTimes addEntriesFromDictionary:self.milestones];
+
+    NSLog(@"%s Startup took %.0f ms", __PRETTY_FUNCTION__, [self timeOfMilestone:name] * 1000);
+    for (NSString *entry in [startTimes keysSortedByValueUsingSelector:@selector(compare:)]) {
+        double start = [[startTimes objectForKey:entry] doubleValue] * 1000;
+        if ([self.milestones objectForKey:entry]) {
+            NSLog(@"    %7.0f ms  %@", start, entry);
+        } else if ([self.phaseEnds objectForKey:entry]) {
+            NSLog(@"    %7.0f ms  %@ (%.0f ms)", start, entry, [self durationOfPhase:entry] * 1000);
+        } else {
+            NSLog(@"    %7.0f ms  %@ (unfinished)", start, entry);
+        }
+    }
+}
+
+@end
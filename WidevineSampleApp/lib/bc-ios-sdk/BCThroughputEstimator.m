@@ -0,0 +1,303 @@
+//
+//  BCThroughputEstimator.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <AVFoundation/AVFoundation.h>
+#import <SystemConfiguration/SystemConfiguration.h>
+#import <netinet/in.h>
+
+#import "BCThroughputEstimator.h"
+
+#define BCThroughputEstimatorDefaultsKey @"BCThroughputEstimates"
+#define BCThroughputEstimatorDefaultWindowSize 16
+#define BCThroughputEstimatorDefaultSmoothingFactor 0.2
+#define BCThroughputEstimatorDefaultMinimumTransferSize (64 * 1024)
+#define BCThroughputEstimatorDefaultBandwidth 1000000.0
+
+// Keys of the per network type dictionaries, which are persisted as they are.
+#define BCThroughputEstimatorSamplesKey @"samples"
+#define BCThroughputEstimatorAverageKey @"average"
+
+@interface BCThroughputEstimator ()
+{
+    SCNetworkReachabilityRef reachability;
+}
+
+@property (nonatomic, retain) NSString *defaultsKey;
+@property (nonatomic, retain) NSMutableDictionary *estimates;
+
+- (void)startTrackingNetworkType;
+- (void)startObservingStreams;
+- (void)updateNetworkTypeWithFlags:(SCNetworkReachabilityFlags)flags;
+
+@end
+
+static void BCThroughputEstimatorReachabilityCallback(SCNetworkReachabilityRef target, SCNetworkReachabilityFlags flags, void *info)
+{
+    [(BCThroughputEstimator *)info updateNetworkTypeWithFlags:flags];
+}
+
+/**
+ * Returns the key under which samples for a network type are kept.
+ */
+static NSString *BCThroughputEstimatorKeyForNetworkType(BCNetworkType type)
+{
+    switch (type) {
+        case BCNetworkTypeWiFi:
+            return @"wifi";
+        case BCNetworkTypeCellular:
+            return @"cellular";
+        default:
+            return @"unknown";
+    }
+}
+
+@implementation BCThroughputEstimator
+
+@synthesize defaultsKey;
+@synthesize estimates;
+@synthesize networkType;
+@synthesize windowSize;
+@synthesize smoothingFactor;
+@synthesize minimumTransferSize;
+@synthesize defaultBandwidth;
+
++ (BCThroughputEstimator *)sharedEstimator
+{
+    static BCThroughputEstimator *sharedEstimator = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedEstimator = [[BCThroughputEstimator alloc] initWithDefaultsKey:BCThroughputEstimatorDefaultsKey];
+        [sharedEstimator startTrackingNetworkType];
+        [sharedEstimator startObservingStreams];
+    });
+    return sharedEstimator;
+}
+
+- (id)init
+{
+    return [self initWithDefaultsKey:nil];
+}
+
+- (id)initWithDefaultsKey:(NSString *)key
+{
+    if (self = [super init]) {
+        self.defaultsKey = key;
+        self.estimates = [NSMutableDictionary dictionary];
+        self.windowSize = BCThroughputEstimatorDefaultWindowSize;
+        self.smoothingFactor = BCThroughputEstimatorDefaultSmoothingFactor;
+        self.minimumTransferSize = BCThroughputEstimatorDefaultMinimumTransferSize;
+        self.defaultBandwidth = BCThroughputEstimatorDefaultBandwidth;
+
+        NSDictionary *persisted = key ? [[NSUserDefaults standardUserDefaults] dictionaryForKey:key] : nil;
+        for (NSString *typeKey in persisted) {
+            NSDictionary *estimate = [persisted objectForKey:typeKey];
+            NSArray *samples = [estimate objectForKey:BCThroughputEstimatorSamplesKey];
+            NSNumber *average = [estimate objectForKey:BCThroughputEstimatorAverageKey];
+            if ([samples isKindOfClass:[NSArray class]] && [average isKindOfClass:[NSNumber class]]) {
+                [self.estimates setObject:[NSMutableDictionary dictionaryWithObjectsAndKeys:
+                                           [[samples mutableCopy] autorelease], BCThroughputEstimatorSamplesKey,
+                                           average, BCThroughputEstimatorAverageKey, nil]
+                                   forKey:typeKey];
+            }
+        }
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    [[NSNotificationCenter defaultCenter] removeObserver:self];
+    if (reachability) {
+        SCNetworkReachabilitySetCallback(reachability, NULL, NULL);
+        SCNetworkReachabilityUnscheduleFromRunLoop(reachability, CFRunLoopGetMain(), kCFRunLoopCommonModes);
+        CFRelease(reachability);
+    }
+    self.defaultsKey = nil;
+    self.estimates = nil;
+
+    [super dealloc];
+}
+
+#pragma mark - Network type
+
+- (void)startTrackingNetworkType
+{
+    struct sockaddr_in address;
+    bzero(&address, sizeof(address));
+    address.sin_len = sizeof(address);
+    address.sin_family = AF_INET;
+
+    reachability = SCNetworkReachabilityCreateWithAddress(kCFAllocatorDefault, (const struct sockaddr *)&address);
+    if (!reachability) {
+        return;
+    }
+
+    SCNetworkReachabilityFlags flags;
+    if (SCNetworkReachabilityGetFlags(reachability, &flags)) {
+        [self updateNetworkTypeWithFlags:flags];
+    }
+
+    SCNetworkReachabilityContext context = { 0, self, NULL, NULL, NULL };
+    SCNetworkReachabilitySetCallback(reachability, BCThroughputEstimatorReachabilityCallback, &context);
+    SCNetworkReachabilityScheduleWithRunLoop(reachability, CFRunLoopGetMain(), kCFRunLoopCommonModes);
+}
+
+- (void)updateNetworkTypeWithFlags:(SCNetworkReachabilityFlags)flags
+{
+    if (!(flags & kSCNetworkReachabilityFlagsReachable)) {
+        self.networkType = BCNetworkTypeUnknown;
+    } else if (flags & kSCNetworkReachabilityFlagsIsWWAN) {
+        self.networkType = BCNetworkTypeCellular;
+    } else {
+        self.networkType = BCNetworkTypeWiFi;
+    }
+}
+
+#pragma mark - Streams
+
+- (void)startObservingStreams
+{
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(playerItemNewAccessLogEntry:)
+                                                 name:AVPlayerItemNewAccessLogEntryNotification
+                                               object:nil];
+    [[NSNotificationCenter defaultCenter] addObserver:self
+                                             selector:@selector(playerItemDidPlayToEnd:)
+                                                 name:AVPlayerItemDidPlayToEndTimeNotification
+                                               object:nil];
+}
+
+/**
+ * Records an access log event of the stream as one transfer.
+ */
+- (void)recordAccessLogEvent:(AVPlayerItemAccessLogEvent *)event
+{
+    [self recordStreamTransferOfBytes:event.numberOfBytesTransferred observedBitrate:event.observedBitrate];
+}
+
+- (void)playerItemNewAccessLogEntry:(NSNotification *)notification
+{
+    // A new entry closes the one before it, whose totals are now final.
+    NSArray *events = [[(AVPlayerItem *)notification.object accessLog] events];
+    if ([events count] < 2) {
+        return;
+    }
+    AVPlayerItemAccessLogEvent *event = [events objectAtIndex:[events count] - 2];
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self recordAccessLogEvent:event];
+    });
+}
+
+- (void)playerItemDidPlayToEnd:(NSNotification *)notification
+{
+    AVPlayerItemAccessLogEvent *event = [[[(AVPlayerItem *)notification.object accessLog] events] lastObject];
+    if (!event) {
+        return;
+    }
+    dispatch_async(dispatch_get_main_queue(), ^{
+        [self recordAccessLogEvent:event];
+    });
+}
+
+- (void)recordStreamTransferOfBytes:(long long)bytes observedBitrate:(double)bitsPerSecond
+{
+    if (bitsPerSecond <= 0) {
+        return;
+    }
+    [self recordTransferOfBytes:bytes duration:bytes * 8 / bitsPerSecond];
+}
+
+#pragma mark - Samples
+
+- (void)recordTransferOfBytes:(long long)bytes duration:(NSTimeInterval)duration
+{
+    [self recordTransferOfBytes:bytes duration:duration networkType:self.networkType];
+}
+
+- (void)recordTransferOfBytes:(long long)bytes duration:(NSTimeInterval)duration networkType:(BCNetworkType)type
+{
+    if (bytes < self.minimumTransferSize || duration <= 0) {
+        return;
+    }
+
+    NSString *typeKey = BCThroughputEstimatorKeyForNetworkType(type);
+    NSMutableDictionary *estimate = [self.estimates objectForKey:typeKey];
+    double bitsPerSecond = bytes * 8 / duration;
+    double average = bitsPerSecond;
+
+    if (estimate) {
+        average = [[estimate objectForKey:BCThroughputEstimatorAverageKey] doubleValue];
+        average += self.smoothingFactor * (bitsPerSecond - average);
+    } else {
+        estimate = [NSMutableDictionary dictionaryWithObject:[NSMutableArray array] forKey:BCThroughputEstimatorSamplesKey];
+        [self.estimates setObject:estimate forKey:typeKey];
+    }
+    [estimate setObject:[NSNumber numberWithDouble:average] forKey:BCThroughputEstimatorAverageKey];
+
+    NSMutableArray *samples = [estimate objectForKey:BCThroughputEstimatorSamplesKey];
+    [samples addObject:[NSArray arrayWithObjects:[NSNumber numberWithLongLong:bytes], [NSNumber numberWithDouble:duration], nil]];
+    if ([samples count] > self.windowSize) {
+        [samples removeObjectsInRange:NSMakeRange(0, [samples count] - self.windowSize)];
+    }
+
+    if (self.defaultsKey) {
+        [[NSUserDefaults standardUserDefaults] setObject:self.estimates forKey:self.defaultsKey];
+    }
+}
+
+- (void)reset
+{
+    [self.estimates removeAllObjects];
+    if (self.defaultsKey) {
+        [[NSUserDefaults standardUserDefaults] removeObjectForKey:self.defaultsKey];
+    }
+}
+
+#pragma mark - Estimates
+
+- (double)windowBandwidthForNetworkType:(BCNetworkType)type
+{
+    NSDictionary *estimate = [self.estimates objectForKey:BCThroughputEstimatorKeyForNetworkType(type)];
+    long long bytes = 0;
+    NSTimeInterval duration = 0;
+
+    for (NSArray *sample in [estimate objectForKey:BCThroughputEstimatorSamplesKey]) {
+        bytes += [[sample objectAtIndex:0] longLongValue];
+        duration += [[sample objectAtIndex:1] doubleValue];
+    }
+    return duration > 0 ? bytes * 8 / duration : 0;
+}
+
+- (double)averageBandwidthForNetworkType:(BCNetworkType)type
+{
+    NSDictionary *estimate = [self.estimates objectForKey:BCThroughputEstimatorKeyForNetworkType(type)];
+    return [[estimate objectForKey:BCThroughputEstimatorAverageKey] doubleValue];
+}
+
+- (double)estimatedBandwidthForNetworkType:(BCNetworkType)type
+{
+    double window = [self windowBandwidthForNetworkType:type];
+    double average = [self averageBandwidthForNetworkType:type];
+    if (window <= 0 || average <= 0) {
+        return self.defaultBandwidth;
+    }
+    return MIN(window, average);
+}
+
+- (double)estimatedBandwidth
+{
+    return [self estimatedBandwidthForNetworkType:self.networkType];
+}
+
+- (NSTimeInterval)estimatedDurationForBytes:(long long)bytes
+{
+    return bytes * 8 / [self estimatedBandwidth];
+}
+
+@end
@@ -0,0 +1,115 @@
+//
+//  BCTimeFormatter.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCTimeFormatter.h"
+
+// Strings cached per style; a power of two, so a second's slot is a mask away.
+#define BCTimeFormatterCacheSize 128
+
+// Long enough for the hours of any NSUInteger and the minutes and seconds.
+#define BCTimeFormatterBufferSize 32
+
+/**
+ * Writes value in decimal, zero padded to at least width digits, and returns
+ * the position after the last digit.
+ */
+static char *BCTimeFormatterWriteDigits(char *position, NSUInteger value, NSUInteger width)
+{
+    char digits[BCTimeFormatterBufferSize];
+    NSUInteger count = 0;
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    while (count < width) {
+        digits[count++] = '0';
+    }
+    while (count > 0) {
+        *position++ = digits[--count];
+    }
+    return position;
+}
+
+/**
+ * Writes seconds in style and returns the number of characters written.
+ */
+static NSUInteger BCTimeFormatterWrite(char *buffer, NSUInteger seconds, BCTimeFormatterStyle style)
+{
+    char *position = buffer;
+    if (style == BCTimeFormatterStyleHoursMinutesSeconds) {
+        position = BCTimeFormatterWriteDigits(position, seconds / 3600, 1);
+        *position++ = ':';
+        position = BCTimeFormatterWriteDigits(position, (seconds / 60) % 60, 2);
+    } else {
+        position = BCTimeFormatterWriteDigits(position, seconds / 60, 2);
+    }
+    *position++ = ':';
+    position = BCTimeFormatterWriteDigits(position, seconds % 60, 2);
+    return position - buffer;
+}
+
+@interface BCTimeFormatter ()
+{
+    NSUInteger cachedSeconds[BCTimeFormatterStyleCount][BCTimeFormatterCacheSize];
+    NSString *cachedStrings[BCTimeFormatterStyleCount][BCTimeFormatterCacheSize];
+}
+
+@property (nonatomic, readwrite) NSUInteger hitCount;
+@property (nonatomic, readwrite) NSUInteger missCount;
+
+@end
+
+@implementation BCTimeFormatter
+
+@synthesize hitCount;
+@synthesize missCount;
+
++ (BCTimeFormatter *)sharedFormatter
+{
+    static BCTimeFormatter *sharedFormatter = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedFormatter = [[BCTimeFormatter alloc] init];
+    });
+    return sharedFormatter;
+}
+
+- (void)dealloc
+{
+    for (NSUInteger style = 0; style < BCTimeFormatterStyleCount; style++) {
+        for (NSUInteger slot = 0; slot < BCTimeFormatterCacheSize; slot++) {
+            [cachedStrings[style][slot] release];
+        }
+    }
+
+    [super dealloc];
+}
+
+- (NSString *)stringForSeconds:(NSTimeInterval)time style:(BCTimeFormatterStyle)style
+{
+    NSUInteger seconds = isfinite(time) && time > 0 ? (NSUInteger)time : 0;
+    NSUInteger slot = seconds & (BCTimeFormatterCacheSize - 1);
+
+    NSString *string = cachedStrings[style][slot];
+    if (string && cachedSeconds[style][slot] == seconds) {
+        self.hitCount++;
+        return string;
+    }
+
+    char buffer[BCTimeFormatterBufferSize];
+    NSUInteger length = BCTimeFormatterWrite(buffer, seconds, style);
+    string = [[NSString alloc] initWithBytes:buffer length:length encoding:NSASCIIStringEncoding];
+
+    [cachedStrings[style][slot] release];
+    cachedStrings[style][slot] = string;
+    cachedSeconds[style][slot] = seconds;
+    self.missCount++;
+    return string;
+}
+
+@end
@@ -0,0 +1,272 @@
+//
+//  BCWidevineConfiguration.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <fcntl.h>
+
+#import "BCWidevineConfiguration.h"
+#import "WViPhoneAPI.h"
+
+NSString *const BCWidevineConfigurationDidChangeNotification = @"BCWidevineConfigurationDidChangeNotification";
+NSString *const BCWidevineConfigurationErrorDomain = @"BCWidevineConfigurationErrorDomain";
+
+static BCWidevineConfiguration *sharedConfiguration = nil;
+static dispatch_source_t configurationFileSource = NULL;
+
+/**
+ * Returns an error describing an invalid value.
+ */
+static NSError *BCConfigurationError(NSString *format, NSString *key)
+{
+    NSString *message = [NSString stringWithFormat:format, key];
+    return [NSError errorWithDomain:BCWidevineConfigurationErrorDomain
+                               code:0
+                           userInfo:[NSDictionary dictionaryWithObject:message forKey:NSLocalizedDescriptionKey]];
+}
+
+/**
+ * Returns YES if value is an http or https URL.
+ */
+static BOOL BCConfigurationIsHTTPURL(id value)
+{
+    if (![value isKindOfClass:[NSString class]]) {
+        return NO;
+    }
+    NSURL *url = [NSURL URLWithString:value];
+    NSString *scheme = [[url scheme] lowercaseString];
+    return [url host] && ([scheme isEqualToString:@"http"] || [scheme isEqualToString:@"https"]);
+}
+
+@interface BCWidevineConfiguration ()
+
+@property (nonatomic, readwrite, copy) NSString *mediaApiToken;
+@property (nonatomic, readwrite, copy) NSString *playlistReferenceID;
+@property (nonatomic, readwrite, copy) NSString *mediaApiBaseURL;
+@property (nonatomic, readwrite) NSUInteger pagedSearchPageSize;
+@property (nonatomic, readwrite, copy) NSString *pagedSearchQuery;
+@property (nonatomic, readwrite, copy) NSString *drmServerURL;
+@property (nonatomic, readwrite, copy) NSString *analyticsBatchURL;
+@property (nonatomic, readwrite, copy) NSDictionary *widevineSettings;
+
+@end
+
+@implementation BCWidevineConfiguration
+
+@synthesize mediaApiToken;
+@synthesize playlistReferenceID;
+@synthesize mediaApiBaseURL;
+@synthesize pagedSearchPageSize;
+@synthesize pagedSearchQuery;
+@synthesize drmServerURL;
+@synthesize analyticsBatchURL;
+@synthesize widevineSettings;
+
++ (BCWidevineConfiguration *)sharedConfiguration
+{
+    @synchronized(self) {
+        return [[sharedConfiguration retain] autorelease];
+    }
+}
+
++ (void)setSharedConfiguration:(BCWidevineConfiguration *)configuration
+{
+    @synchronized(self) {
+        if (sharedConfiguration != configuration) {
+            [sharedConfiguration release];
+            sharedConfiguration = [configuration retain];
+        }
+    }
+}
+
++ (BOOL)loadSharedConfigurationWithContentsOfFile:(NSString *)path error:(NSError **)error
+{
+    BCWidevineConfiguration *configuration = [self configurationWithContentsOfFile:path error:error];
+    if (!configuration) {
+        return NO;
+    }
+
+    [self setSharedConfiguration:configuration];
+    [self watchFile:path];
+    return YES;
+}
+
+/**
+ * Reloads the shared configuration whenever the file at path changes.
+ */
++ (void)watchFile:(NSString *)path
+{
+    static dispatch_queue_t queue = NULL;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        queue = dispatch_queue_create("com.brightcove.widevine.configuration", DISPATCH_QUEUE_SERIAL);
+    });
+
+    dispatch_async(queue, ^{
+        if (configurationFileSource) {
+            dispatch_source_cancel(configurationFileSource);
+            dispatch_release(configurationFileSource);
+            configurationFileSource = NULL;
+        }
+
+        int fd = open([path fileSystemRepresentation], O_EVTONLY);
+        if (fd < 0) {
+            return;
+        }
+
+        dispatch_source_t source = dispatch_source_create(DISPATCH_SOURCE_TYPE_VNODE, fd,
+                                                          DISPATCH_VNODE_WRITE | DISPATCH_VNODE_EXTEND |
+                                                          DISPATCH_VNODE_DELETE | DISPATCH_VNODE_RENAME,
+                                                          queue);
+        configurationFileSource = source;
+        dispatch_source_set_cancel_handler(source, ^{
+            close(fd);
+        });
+        dispatch_source_set_event_handler(source, ^{
+            NSError *error = nil;
+            BCWidevineConfiguration *configuration = [BCWidevineConfiguration configurationWithContentsOfFile:path error:&error];
+            if (configuration) {
+                [BCWidevineConfiguration setSharedConfiguration:configuration];
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    [[NSNotificationCenter defaultCenter] postNotificationName:BCWidevineConfigurationDidChangeNotification
+                                                                        object:configuration];
+                });
+            } else {
+                NSLog(@"%s Keeping the current configuration: %@", __PRETTY_FUNCTION__, [error localizedDescription]);
+            }
+
+            // Editors save by replacing the file, which leaves this source watching the old one.
+            if (dispatch_source_get_data(source) & (DISPATCH_VNODE_DELETE | DISPATCH_VNODE_RENAME)) {
+                [BCWidevineConfiguration watchFile:path];
+            }
+        });
+        dispatch_resume(source);
+    });
+}
+
++ (BCWidevineConfiguration *)configurationWithContentsOfFile:(NSString *)path error:(NSError **)error
+{
+    NSDictionary *dictionary = path ? [NSDictionary dictionaryWithContentsOfFile:path] : nil;
+    if (!dictionary) {
+        if (error) {
+            *error = BCConfigurationError(@"Could not read the configuration file '%@'.", [path lastPathComponent]);
+        }
+        return nil;
+    }
+    return [[[self alloc] initWithDictionary:dictionary error:error] autorelease];
+}
+
+- (id)initWithDictionary:(NSDictionary *)dictionary error:(NSError **)error
+{
+    if (self = [super init]) {
+        NSError *validationError = [self readDictionary:dictionary];
+        if (validationError) {
+            if (error) {
+                *error = validationError;
+            }
+            [self release];
+            return nil;
+        }
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    self.mediaApiToken = nil;
+    self.playlistReferenceID = nil;
+    self.mediaApiBaseURL = nil;
+    self.pagedSearchQuery = nil;
+    self.drmServerURL = nil;
+    self.analyticsBatchURL = nil;
+    self.widevineSettings = nil;
+
+    [super dealloc];
+}
+
+/**
+ * Reads and validates the settings.
+ *
+ * @return the first problem found, or nil.
+ */
+- (NSError *)readDictionary:(NSDictionary *)dictionary
+{
+    id token = [dictionary objectForKey:@"mediaApiToken"];
+    if (![token isKindOfClass:[NSString class]] || [token length] == 0) {
+        return BCConfigurationError(@"'%@' must be a Media API token.", @"mediaApiToken");
+    }
+    self.mediaApiToken = token;
+
+    id baseURL = [dictionary objectForKey:@"mediaApiBaseUrl"];
+    if (baseURL && !BCConfigurationIsHTTPURL(baseURL)) {
+        return BCConfigurationError(@"'%@' must be an http or https URL.", @"mediaApiBaseUrl");
+    }
+    self.mediaApiBaseURL = baseURL;
+
+    id pageSize = [dictionary objectForKey:@"pagedSearchPageSize"];
+    if (pageSize && (![pageSize isKindOfClass:[NSNumber class]] || [pageSize integerValue] <= 0)) {
+        return BCConfigurationError(@"'%@' must be a positive number.", @"pagedSearchPageSize");
+    }
+    self.pagedSearchPageSize = [pageSize unsignedIntegerValue];
+
+    id query = [dictionary objectForKey:@"pagedSearchQuery"];
+    if (query && ![query isKindOfClass:[NSString class]]) {
+        return BCConfigurationError(@"'%@' must be a string.", @"pagedSearchQuery");
+    }
+    self.pagedSearchQuery = query;
+
+    id referenceID = [dictionary objectForKey:@"iosPlaylistReferenceId"];
+    if (referenceID && (![referenceID isKindOfClass:[NSString class]] || [referenceID length] == 0)) {
+        return BCConfigurationError(@"'%@' must be a playlist reference ID.", @"iosPlaylistReferenceId");
+    }
+    if (!referenceID && self.pagedSearchPageSize == 0) {
+        return BCConfigurationError(@"'%@' is required unless pagedSearchPageSize is set.", @"iosPlaylistReferenceId");
+    }
+    self.playlistReferenceID = referenceID;
+
+    id batchURL = [dictionary objectForKey:@"analyticsBatchUrl"];
+    if (batchURL && !BCConfigurationIsHTTPURL(batchURL)) {
+        return BCConfigurationError(@"'%@' must be an http or https URL.", @"analyticsBatchUrl");
+    }
+    self.analyticsBatchURL = batchURL;
+
+    NSMutableDictionary *settings = [NSMutableDictionary dictionary];
+    NSArray *urlKeys = [NSArray arrayWithObjects:WVDRMServerKey, WVDRMAckUrlKey, WVHeartbeatUrlKey, nil];
+    NSArray *intervalKeys = [NSArray arrayWithObjects:WVHeartbeatPeriodKey, WVPreloadTimeoutKey, nil];
+    NSArray *stringKeys = [NSArray arrayWithObjects:WVPortalKey, WVClientIdKey, WVCAUserDataKey, nil];
+
+    for (NSString *key in urlKeys) {
+        id value = [dictionary objectForKey:key];
+        if ([key isEqualToString:WVDRMServerKey] && !value) {
+            value = [dictionary objectForKey:@"drmServerUrl"];
+        }
+        if (value && !BCConfigurationIsHTTPURL(value)) {
+            return BCConfigurationError(@"'%@' must be an http or https URL.", key);
+        }
+        [settings setValue:value forKey:key];
+    }
+    for (NSString *key in intervalKeys) {
+        id value = [dictionary objectForKey:key];
+        if (value && (![value isKindOfClass:[NSNumber class]] || [value doubleValue] <= 0)) {
+            return BCConfigurationError(@"'%@' must be a positive number.", key);
+        }
+        [settings setValue:value forKey:key];
+    }
+    for (NSString *key in stringKeys) {
+        id value = [dictionary objectForKey:key];
+        if (value && ![value isKindOfClass:[NSString class]]) {
+            return BCConfigurationError(@"'%@' must be a string.", key);
+        }
+        [settings setValue:value forKey:key];
+    }
+    self.widevineSettings = settings;
+    self.drmServerURL = [settings objectForKey:WVDRMServerKey];
+
+    return nil;
+}
+
+@end
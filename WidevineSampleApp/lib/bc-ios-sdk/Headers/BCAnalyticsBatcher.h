@@ -0,0 +1,131 @@
+//
+//  BCAnalyticsBatcher.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Collects the beacons BCAnalytics sends and posts them in batches, so the
+ * radio wakes once per batch rather than once per playback event.
+ *
+ * Beacons are only collected while batchURL is set; otherwise they go out one
+ * by one as before, since metrics.brightcove.com takes a single beacon per
+ * GET. While it is set, requests to beaconHosts are answered locally with an
+ * empty 204 response and their URLs are queued. A batch is sealed when it
+ * reaches maxBatchCount beacons or maxBatchBytes of URLs, or when the shared
+ * BCNetworkActivityScheduler next wakes the radio, at most flushInterval after
+ * its first beacon. Sealed batches are gzipped JSON written to the caches
+ * directory, so they survive the app being killed, and each is sent as one
+ * POST to batchURL.
+ *
+ * Batches are also sent early whenever a Media API response shows the radio
+ * is already up, and sealed when the app moves to the background. A batch
+ * that fails with a network error, a 408, a 429 or a 5xx stays on disk and is
+ * retried with the next flush; one rejected with any other status is dropped.
+ * The oldest batches are dropped once there are more than maxStoredBatches or
+ * maxStoredBytes of them, and any batch older than maxBatchAge.
+ *
+ * The batcher is only used from the main thread.
+ */
+@interface BCAnalyticsBatcher : NSObject
+
+/**
+ * Returns the batcher shared by the app.
+ */
++ (BCAnalyticsBatcher *)sharedBatcher;
+
+/**
+ * Starts intercepting beacons whenever batchURL is set, and queues any
+ * batches left from earlier launches.
+ */
+- (void)install;
+
+/**
+ * Queues a beacon.
+ */
+- (void)addBeaconWithURL:(NSURL *)url;
+
+/**
+ * Seals the batch being collected and sends every sealed batch.
+ */
+- (void)flush;
+
+/**
+ * Sends sealed batches if any are waiting; called when a connection has just
+ * been used, so sending costs little extra radio time.
+ */
+- (void)networkWasUsed;
+
+/**
+ * Host names whose requests are treated as analytics beacons. Defaults to
+ * metrics.brightcove.com.
+ */
+@property (retain) NSSet *beaconHosts;
+
+/**
+ * Endpoint accepting a gzipped JSON batch, or nil to leave beacons alone. The
+ * body is {"beacons": [{"url": ..., "time": ...}, ...]}, with times in
+ * milliseconds since 1970. Batches sealed while it was set are kept until it
+ * is set again or they expire.
+ */
+@property (retain) NSURL *batchURL;
+
+/**
+ * Largest number of beacons in a batch. Defaults to 50.
+ */
+@property (nonatomic) NSUInteger maxBatchCount;
+
+/**
+ * Largest total length of beacon URLs in a batch. Defaults to 32KB.
+ */
+@property (nonatomic) NSUInteger maxBatchBytes;
+
+/**
+ * Longest time a beacon waits before its batch is sealed and sent. Defaults
+ * to 60 seconds.
+ */
+@property (nonatomic) NSTimeInterval flushInterval;
+
+/**
+ * Most batches kept on disk waiting to be sent. Defaults to 100.
+ */
+@property (nonatomic) NSUInteger maxStoredBatches;
+
+/**
+ * Most compressed bytes of batches kept on disk. Defaults to 1MB.
+ */
+@property (nonatomic) unsigned long long maxStoredBytes;
+
+/**
+ * Longest time a sealed batch is kept waiting to be sent. Defaults to 7 days.
+ */
+@property (nonatomic) NSTimeInterval maxBatchAge;
+
+/**
+ * Number of beacons intercepted.
+ */
+@property (nonatomic, readonly) NSUInteger beaconCount;
+
+/**
+ * Number of HTTP requests made to deliver them. Compare with beaconCount to
+ * see the requests saved.
+ */
+@property (nonatomic, readonly) NSUInteger requestCount;
+
+/**
+ * Number of batches dropped unsent, because they were rejected or exceeded
+ * the storage limits.
+ */
+@property (nonatomic, readonly) NSUInteger droppedBatchCount;
+
+/**
+ * Bytes of batch JSON before and after compression.
+ */
+@property (nonatomic, readonly) unsigned long long uncompressedBytes;
+@property (nonatomic, readonly) unsigned long long compressedBytes;
+
+@end
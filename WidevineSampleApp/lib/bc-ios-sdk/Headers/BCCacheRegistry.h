@@ -0,0 +1,107 @@
+//
+//  BCCacheRegistry.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ * How costly a cache's contents are to bring back. Under memory pressure the
+ * lowest tiers are trimmed first.
+ */
+typedef enum BCCacheTier {
+    /** Bytes that can be refetched or reparsed at little cost, such as Media API responses. */
+    BCCacheTierResponses = 0,
+    /** Decoded images, which cost a download and a decode to bring back. */
+    BCCacheTierImages,
+    /** Playlist pages the user is browsing; trimming them reloads rows. */
+    BCCacheTierPlaylists,
+    BCCacheTierCount
+} BCCacheTier;
+
+/**
+ * A cache whose memory the registry accounts for and can reclaim.
+ */
+@protocol BCRegisteredCache <NSObject>
+
+/**
+ * Name used when reporting the cache.
+ */
+- (NSString *)cacheName;
+
+- (BCCacheTier)cacheTier;
+
+/**
+ * Approximate bytes held by the cache.
+ */
+- (unsigned long long)cacheCost;
+
+/**
+ * Evicts contents, least valuable first, until cacheCost is at most cost.
+ * Caches may keep contents that are in use even if that leaves them above cost.
+ */
+- (void)trimToCost:(unsigned long long)cost;
+
+@end
+
+/**
+ * Tracks the memory held by the caches in the plugin and keeps it within
+ * costLimit, and within memoryWarningCostLimit after a memory warning.
+ *
+ * When over a limit, the registry trims tier by tier from the lowest: each
+ * cache in a tier is emptied before any cache in the next tier is touched, and
+ * the last tier needed is trimmed only as far as necessary.
+ *
+ * Caches don't retain or get retained by the registry; they register when
+ * created, unregister in dealloc and call cacheDidGrow: after adding contents.
+ * The registry is only used from the main thread.
+ */
+@interface BCCacheRegistry : NSObject
+
+/**
+ * Returns the registry shared by all caches.
+ */
++ (BCCacheRegistry *)sharedRegistry;
+
+- (void)registerCache:(id<BCRegisteredCache>)cache;
+- (void)unregisterCache:(id<BCRegisteredCache>)cache;
+
+/**
+ * Enforces costLimit after cache added contents.
+ */
+- (void)cacheDidGrow:(id<BCRegisteredCache>)cache;
+
+/**
+ * Trims the lowest tiers until the caches hold at most cost bytes.
+ */
+- (void)trimToCost:(unsigned long long)cost;
+
+/**
+ * Returns the bytes held by the caches in a tier.
+ */
+- (unsigned long long)costOfTier:(BCCacheTier)tier;
+
+/**
+ * Returns the bytes held by each registered cache, keyed by cache name.
+ */
+- (NSDictionary *)costsByCacheName;
+
+/**
+ * Bytes held by all registered caches.
+ */
+@property (nonatomic, readonly) unsigned long long totalCost;
+
+/**
+ * Most bytes the caches may hold. Defaults to 24MB.
+ */
+@property (nonatomic) unsigned long long costLimit;
+
+/**
+ * Bytes the caches are trimmed to on a memory warning. Defaults to 4MB.
+ */
+@property (nonatomic) unsigned long long memoryWarningCostLimit;
+
+@end
@@ -0,0 +1,62 @@
+//
+//  BCCatalog+Widevine.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCCatalog.h"
+
+/**
+ * The type of callback blocks for catalog methods which find several videos.
+ * @param errors BCError objects keyed by each requested ID that could not be
+ * found, or nil if every video was found.
+ * @param videos one object per requested ID, in the order requested: the BCVideo
+ * if it was found, or NSNull if it was not.
+ */
+typedef void (^BCVideoListResponseBlock)(NSDictionary *errors, NSArray *videos);
+
+@interface BCCatalog (Widevine)
+
+/**
+ * Retrieves several BCVideos from the Media API service by their video IDs.
+ *
+ * The IDs are packed into as few find_videos_by_ids requests as the Media API's
+ * limits allow and the requests are sent concurrently. Duplicate IDs are only
+ * requested once.
+ *
+ * @param videoIDs array of strings containing the IDs of the videos to find.
+ * @param options Additional NSString query parameters to add to the Media API
+ * requests.
+ * @param responseBlock block which will be invoked once every request finishes.
+ */
+- (void)findVideosByIDs:(NSArray *)videoIDs options:(NSDictionary *)options callBlock:(BCVideoListResponseBlock)responseBlock;
+
+/**
+ * Retrieves several BCVideos from the Media API service by their reference IDs.
+ * See findVideosByIDs:options:callBlock:.
+ *
+ * @param referenceIDs array of strings containing the reference IDs of the videos
+ * to find.
+ * @param options Additional NSString query parameters to add to the Media API
+ * requests.
+ * @param responseBlock block which will be invoked once every request finishes.
+ */
+- (void)findVideosByReferenceIDs:(NSArray *)referenceIDs options:(NSDictionary *)options callBlock:(BCVideoListResponseBlock)responseBlock;
+
+/**
+ * Retrieves one page of a paged Media API video query. The page is returned as a
+ * BCPlaylist whose properties hold pageNumber, pageSize and, if the Media API
+ * reported it, totalCount.
+ *
+ * @param pageNumber the zero-based page to find.
+ * @param pageSize the number of videos per page, at most 100.
+ * @param options Additional NSString query parameters to add to the Media API
+ * requests. The command defaults to search_videos; set "command" to use another
+ * paged command such as find_all_videos.
+ * @param responseBlock block which will be invoked when the request finishes.
+ */
+- (void)findVideoPage:(NSUInteger)pageNumber pageSize:(NSUInteger)pageSize options:(NSDictionary *)options callBlock:(BCPlaylistResponseBlock)responseBlock;
+
+@end
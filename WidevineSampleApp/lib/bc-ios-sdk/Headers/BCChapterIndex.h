@@ -0,0 +1,108 @@
+//
+//  BCChapterIndex.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <UIKit/UIKit.h>
+#import "WViPhoneAPI.h"
+
+/**
+ * Block invoked with a chapter image, or nil if the chapter has none.
+ */
+typedef void (^BCChapterImageBlock)(UIImage *image, NSUInteger chapter);
+
+/**
+ * The chapters of one Widevine asset, built from the ChapterSetup,
+ * ChapterTitle and ChapterImage events.
+ *
+ * Chapter start times are kept in a sorted C array, so chapterAtTime: is a
+ * binary search. Chapter images are kept as the library delivered them and
+ * only decoded, at the size asked for, when one is requested; decoded images
+ * live in BCImageCache chapterImageCache, which the cache registry trims.
+ *
+ * Indexes are cached by asset ID, so replaying an asset reuses its index
+ * rather than rebuilding it from the events the library sends again.
+ *
+ * Chapter indexes are only used from the main thread.
+ */
+@interface BCChapterIndex : NSObject
+
+/**
+ * Returns the index for an asset, creating an empty one if none is cached.
+ */
++ (BCChapterIndex *)chapterIndexForAssetID:(NSString *)assetID;
+
+/**
+ * Returns the index of the asset Widevine is playing, or nil before any
+ * chapter event has arrived.
+ */
++ (BCChapterIndex *)currentChapterIndex;
+
+/**
+ * Sets the asset chapter events apply to when they don't carry WVAssetIDKey.
+ * The view controller sets it to the ID of each video as it is set.
+ */
++ (void)setCurrentAssetID:(NSString *)assetID;
+
+/**
+ * Adds a Widevine event to the current asset's index. Events other than the
+ * chapter events are ignored, as are chapter events for an index that is
+ * already complete.
+ */
++ (void)handleWidevineEvent:(WViOsApiEvent)event attributes:(NSDictionary *)attributes;
+
+/**
+ * Adds the event described by the details of a BCEventWidevine, whose
+ * widevineStatus holds the WViOsApiEvent, as a number or as its name, and
+ * whose remaining entries are the event's attributes.
+ */
++ (void)handleWidevineEventDetails:(NSDictionary *)details;
+
+/**
+ * Number of chapters, sorted by start time.
+ */
+@property (nonatomic, readonly) NSUInteger chapterCount;
+
+/**
+ * The asset the index describes.
+ */
+@property (nonatomic, readonly, retain) NSString *assetID;
+
+/**
+ * YES once every chapter announced by ChapterSetup has a start time.
+ */
+@property (nonatomic, readonly) BOOL isComplete;
+
+/**
+ * Returns the chapter playing at time, in seconds: the last one starting at
+ * or before it. Returns NSNotFound if there are no chapters or time is before
+ * the first.
+ */
+- (NSUInteger)chapterAtTime:(NSTimeInterval)time;
+
+/**
+ * Returns the start time of a chapter, in seconds.
+ */
+- (NSTimeInterval)timeOfChapter:(NSUInteger)chapter;
+
+/**
+ * Returns the title of a chapter, or nil if it has none.
+ */
+- (NSString *)titleOfChapter:(NSUInteger)chapter;
+
+/**
+ * Returns the image of a chapter at most maxPixelSize pixels on a side if it
+ * has already been decoded at that size, or nil.
+ */
+- (UIImage *)cachedImageForChapter:(NSUInteger)chapter maxPixelSize:(CGFloat)maxPixelSize;
+
+/**
+ * Invokes block on the main thread with the image of a chapter at most
+ * maxPixelSize pixels on a side, decoding it off the main thread if needed.
+ */
+- (void)loadImageForChapter:(NSUInteger)chapter maxPixelSize:(CGFloat)maxPixelSize block:(BCChapterImageBlock)block;
+
+@end
@@ -0,0 +1,57 @@
+//
+//  BCConnectionWarmer.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Opens connections to hosts ahead of the first real request to them.
+ *
+ * Warming a host sends a HEAD request to its root, which resolves the host
+ * name and completes the TCP and TLS handshakes. The URL loading system keeps
+ * the connection open afterwards and reuses it for later requests to the same
+ * scheme, host and port, so the first Media API call or license request finds
+ * the setup already done. Any HTTP response counts as a successful warm-up.
+ *
+ * The warmer is only used from the main thread.
+ */
+@interface BCConnectionWarmer : NSObject
+
+/**
+ * Returns the warmer shared by the plugin and the media services.
+ */
++ (BCConnectionWarmer *)sharedWarmer;
+
+/**
+ * Warms the host of url. Does nothing if the host is already being warmed, or
+ * was warmed or used less than keepAliveInterval ago.
+ */
+- (void)warmConnectionToURL:(NSURL *)url;
+
+/**
+ * Records that a request to url was sent or answered, so the host's
+ * connection is open or opening and needn't be warmed for keepAliveInterval.
+ */
+- (void)connectionToURLWasUsed:(NSURL *)url;
+
+/**
+ * Returns how long warming the host of url took, or a negative value if it
+ * hasn't been warmed.
+ */
+- (NSTimeInterval)warmUpDurationForURL:(NSURL *)url;
+
+/**
+ * How long an idle connection is assumed to stay open. Defaults to 30 seconds.
+ */
+@property (nonatomic) NSTimeInterval keepAliveInterval;
+
+/**
+ * Timeout of warm-up requests. Defaults to 10 seconds.
+ */
+@property (nonatomic) NSTimeInterval timeoutInterval;
+
+@end
@@ -0,0 +1,85 @@
+//
+//  BCImageCache.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <UIKit/UIKit.h>
+#import "BCCacheRegistry.h"
+
+/**
+ * The type of blocks receiving a loaded image.
+ * @param image the decoded image, or nil if it could not be loaded.
+ * @param url the URL the image was loaded from.
+ */
+typedef void (^BCImageCacheCompletionBlock)(UIImage *image, NSURL *url);
+
+/**
+ * A least-recently-used cache of decoded images, such as video stills and
+ * Widevine chapter images.
+ *
+ * Images are downloaded and decoded off the main thread, so showing a cached
+ * image never decodes on the main thread; simultaneous loads of one URL share
+ * a download. Each cache registers in the BCCacheTierImages tier of the shared
+ * BCCacheRegistry, with the decoded bitmap sizes as its cost.
+ *
+ * The cache is only used from the main thread.
+ */
+@interface BCImageCache : NSObject <BCRegisteredCache>
+
+/**
+ * Returns the cache for video still images.
+ */
++ (BCImageCache *)stillImageCache;
+
+/**
+ * Returns the cache for Widevine chapter images.
+ */
++ (BCImageCache *)chapterImageCache;
+
+/**
+ * Designated initializer.
+ *
+ * @param name the name reported to the registry.
+ */
+- (id)initWithName:(NSString *)name;
+
+/**
+ * Returns the image stored for key, or nil.
+ */
+- (UIImage *)imageForKey:(NSString *)key;
+
+/**
+ * Stores image under key.
+ */
+- (void)setImage:(UIImage *)image forKey:(NSString *)key;
+
+/**
+ * Returns the cached image for url, or nil.
+ */
+- (UIImage *)imageForURL:(NSURL *)url;
+
+/**
+ * Invokes completionBlock on the main thread with the image at url, loading
+ * it first if it isn't cached.
+ */
+- (void)loadImageWithURL:(NSURL *)url completionBlock:(BCImageCacheCompletionBlock)completionBlock;
+
+/**
+ * Returns a copy of image whose bitmap is already decoded, so drawing it
+ * doesn't decode on the main thread.
+ */
++ (UIImage *)decodedImageWithImage:(UIImage *)image;
+
+/**
+ * Returns a decoded copy of image scaled down, keeping its aspect ratio, so
+ * that neither side exceeds maxPixelSize pixels. Images that already fit are
+ * decoded at their own size.
+ */
++ (UIImage *)decodedImageWithImage:(UIImage *)image maxPixelSize:(CGFloat)maxPixelSize;
+
+- (void)removeAllImages;
+
+@end
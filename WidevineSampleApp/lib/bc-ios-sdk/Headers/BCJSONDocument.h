@@ -0,0 +1,56 @@
+//
+//  BCJSONDocument.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+@class BCJSONKeyCache;
+
+/**
+ * A parsed JSON document: the response bytes plus a BCJSONTape indexing them.
+ *
+ * rootViewWithKeyCache: returns the document as views: NSDictionary, NSArray and NSString
+ * subclasses that read straight from the bytes and create objects for values
+ * only when they are accessed. ASCII strings without escapes, which covers the
+ * URLs and IDs in a Media API response, are returned as views too and are not
+ * copied out of the response until something copies them. Copying any view
+ * returns ordinary Foundation objects that no longer reference the document.
+ *
+ * Views cache the values they have returned, so they must only be used from
+ * one thread at a time.
+ */
+@interface BCJSONDocument : NSObject
+
+/**
+ * Parses data, which is retained rather than copied.
+ *
+ * @param error set to an error in BCJSONReaderErrorDomain if data is not valid JSON.
+ * @return the document, or nil if an error occurred.
+ */
++ (id)documentWithData:(NSData *)data error:(NSError **)error;
+
+/**
+ * The root value, with objects, arrays and ASCII strings returned as views.
+ *
+ * @param keyCache cache for the keys created when a view is copied or its keys
+ * are enumerated. Optional; it must belong to the thread the views are used on.
+ */
+- (id)rootViewWithKeyCache:(BCJSONKeyCache *)keyCache;
+
+/**
+ * The root value as ordinary Foundation objects, created all at once.
+ *
+ * @param keyCache cache for object keys. Optional.
+ */
+- (id)rootObjectWithKeyCache:(BCJSONKeyCache *)keyCache;
+
+/**
+ * The bytes the document was parsed from.
+ */
+@property (nonatomic, readonly) NSData *data;
+
+@end
@@ -0,0 +1,62 @@
+//
+//  BCJSONKeyCache.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ * A fixed-size cache of the strings created for JSON object keys, so that the
+ * keys repeated in every Media API response (name, id, referenceId,
+ * WVMRenditions, customFields and so on) are created once and then shared.
+ *
+ * The cache is direct-mapped: each key hashes to one slot and replaces whatever
+ * was there, so it never holds more than capacity strings. It is not thread
+ * safe; BCJSONReader keeps one per thread.
+ */
+@interface BCJSONKeyCache : NSObject
+
+/**
+ * Designated initializer.
+ *
+ * @param capacity the number of slots, rounded up to a power of two.
+ */
+- (id)initWithCapacity:(NSUInteger)capacity;
+
+/**
+ * Returns a retained string for the UTF-8 bytes of a key, from the cache if
+ * possible. Keys longer than maxKeyLength are created but not cached.
+ */
+- (NSString *)newStringWithBytes:(const uint8_t *)bytes length:(NSUInteger)length;
+
+/**
+ * Empties the cache and resets the counters.
+ */
+- (void)removeAllStrings;
+
+@property (nonatomic, readonly) NSUInteger capacity;
+
+/**
+ * The longest key, in bytes, that is cached.
+ */
+@property (nonatomic, readonly) NSUInteger maxKeyLength;
+
+/**
+ * Number of lookups answered from the cache.
+ */
+@property (nonatomic, readonly) NSUInteger hits;
+
+/**
+ * Number of lookups that created a string.
+ */
+@property (nonatomic, readonly) NSUInteger misses;
+
+/**
+ * hits / (hits + misses), or 0 before the first lookup.
+ */
+@property (nonatomic, readonly) double hitRate;
+
+@end
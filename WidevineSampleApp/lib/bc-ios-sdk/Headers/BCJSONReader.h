@@ -0,0 +1,66 @@
+//
+//  BCJSONReader.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+@class BCJSONKeyCache;
+
+extern NSString * const BCJSONReaderErrorDomain;
+
+/**
+ * A JSON parser for Media API responses.
+ *
+ * Strings, whitespace and UTF-8 are scanned with the vector routines in
+ * BCJSONScan.h instead of byte by byte, which matters for responses that are
+ * mostly long URLs and descriptions. Objects and arrays are returned as
+ * NSDictionary and NSArray, numbers as NSNumber and null as NSNull, the same
+ * as BCJSONDecoder.
+ *
+ * See BCJSONDocument for the view mode used by viewWithData:error:.
+ *
+ * Each reader has a key cache that stays warm across documents, so the keys
+ * every response repeats are only created once. Use readerForCurrentThread
+ * rather than creating readers per response.
+ */
+@interface BCJSONReader : NSObject
+
+/**
+ * Returns a new reader.
+ */
++ (id)reader;
+
+/**
+ * Returns the reader for the calling thread, creating it on first use. It is
+ * released when the thread exits.
+ */
++ (BCJSONReader *)readerForCurrentThread;
+
+/**
+ * Parses data, which must hold a single UTF-8 encoded JSON value.
+ *
+ * @param data the JSON text.
+ * @param error set to an error in BCJSONReaderErrorDomain, with the byte offset of
+ * the problem in its description, if data is not valid JSON.
+ * @return the parsed value, or nil if an error occurred.
+ */
+- (id)objectWithData:(NSData *)data error:(NSError **)error;
+
+/**
+ * Parses data like objectWithData:error:, but returns views that read from data
+ * and only create objects for the values that are accessed. Copy any value that
+ * needs to outlive data.
+ */
+- (id)viewWithData:(NSData *)data error:(NSError **)error;
+
+/**
+ * The cache used for object keys. Its hit rate shows whether its capacity
+ * suits the responses being parsed.
+ */
+@property (nonatomic, retain, readonly) BCJSONKeyCache *keyCache;
+
+@end
@@ -0,0 +1,51 @@
+//
+//  BCJSONScan.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#ifndef WidevinePlugin_BCJSONScan_h
+#define WidevinePlugin_BCJSONScan_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Byte scanning primitives used by BCJSONReader. Each function has a scalar
+ * version and vector versions for SSE2 and AVX2 (x86) and NEON (ARM); the
+ * fastest one the CPU supports is chosen the first time any of them is called.
+ * All of them are safe to call from any thread.
+ */
+
+/**
+ * Returns a pointer to the first '"', '\' or control character (below 0x20) in
+ * [p, end), or end if there is none.
+ */
+const uint8_t *BCJSONScanString(const uint8_t *p, const uint8_t *end);
+
+/**
+ * Returns a pointer to the first byte in [p, end) that is not JSON whitespace
+ * (space, tab, line feed or carriage return), or end if there is none.
+ */
+const uint8_t *BCJSONSkipWhitespace(const uint8_t *p, const uint8_t *end);
+
+/**
+ * Returns true if every byte in [p, end) is ASCII.
+ */
+bool BCJSONIsASCII(const uint8_t *p, const uint8_t *end);
+
+/**
+ * Returns true if [p, end) is well-formed UTF-8: no overlong forms, surrogates
+ * or code points above U+10FFFF.
+ */
+bool BCJSONValidateUTF8(const uint8_t *p, const uint8_t *end);
+
+/**
+ * Returns the name of the implementation in use: "avx2", "sse2", "neon" or
+ * "scalar".
+ */
+const char *BCJSONScanImplementation(void);
+
+#endif
@@ -0,0 +1,92 @@
+//
+//  BCJSONTape.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#ifndef WidevinePlugin_BCJSONTape_h
+#define WidevinePlugin_BCJSONTape_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * A structural index of a JSON document: one entry per value, in document
+ * order, pointing back into the original bytes. Building the tape validates the
+ * whole document but allocates nothing per value, so values can be decoded
+ * later, and only if they are needed.
+ *
+ * An array entry is followed by the entries of its elements. An object entry is
+ * followed by a string entry for each key, each followed by the entries of its
+ * value.
+ */
+
+typedef enum BCJSONTapeType {
+    BCJSONTapeTypeNull = 0,
+    BCJSONTapeTypeTrue,
+    BCJSONTapeTypeFalse,
+    BCJSONTapeTypeNumber,
+    BCJSONTapeTypeString,
+    BCJSONTapeTypeArray,
+    BCJSONTapeTypeObject,
+} BCJSONTapeType;
+
+enum {
+    /** The string contains escape sequences and must be decoded. */
+    BCJSONTapeFlagEscaped = 1 << 0,
+    /** The string is entirely ASCII. */
+    BCJSONTapeFlagASCII = 1 << 1,
+    /** The number is an integer that fits in a long long. */
+    BCJSONTapeFlagInteger = 1 << 2,
+};
+
+typedef struct BCJSONTapeEntry {
+    uint8_t type;
+    uint8_t flags;
+    /** Byte offset of a number, or of the contents of a string after its opening quote. */
+    uint32_t offset;
+    /** Length in bytes of a number or string, or the number of elements or members of a container. */
+    uint32_t length;
+    /** Index of the entry following this value and everything it contains. */
+    uint32_t next;
+} BCJSONTapeEntry;
+
+typedef struct BCJSONTape {
+    BCJSONTapeEntry *entries;
+    uint32_t count;
+    uint32_t capacity;
+} BCJSONTape;
+
+/**
+ * Builds the tape for a UTF-8 JSON document. The root value is entry 0.
+ *
+ * @return false if the document is not valid JSON, with a static message and
+ * the byte offset of the problem stored in errorMessage and errorOffset.
+ */
+bool BCJSONTapeParse(BCJSONTape *tape, const uint8_t *bytes, size_t length, const char **errorMessage, size_t *errorOffset);
+
+/**
+ * Frees the entries of a tape built by BCJSONTapeParse.
+ */
+void BCJSONTapeFree(BCJSONTape *tape);
+
+/**
+ * Decodes a string entry into buffer, which must hold at least entry->length
+ * bytes; decoding never makes a string longer. Returns the decoded length.
+ */
+size_t BCJSONTapeDecodeString(const BCJSONTapeEntry *entry, const uint8_t *bytes, uint8_t *buffer);
+
+/**
+ * Returns the value of a number entry with BCJSONTapeFlagInteger set.
+ */
+long long BCJSONTapeIntegerValue(const BCJSONTapeEntry *entry, const uint8_t *bytes);
+
+/**
+ * Returns the value of any number entry.
+ */
+double BCJSONTapeDoubleValue(const BCJSONTapeEntry *entry, const uint8_t *bytes);
+
+#endif
@@ -0,0 +1,96 @@
+//
+//  BCJSONWriter.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+@class BCPlaylist;
+@class BCVideo;
+
+extern NSString * const BCJSONWriterErrorDomain;
+
+enum {
+    /** Containers were nested more than 64 deep. */
+    BCJSONWriterErrorTooDeep = 1
+};
+
+/**
+ * A streaming JSON serializer that writes UTF-8 straight into a growable byte
+ * buffer, or through one to a file descriptor.
+ *
+ * Values are written with the begin/end and write methods, and commas and
+ * colons are inserted automatically. Strings are copied out of NSString in one
+ * call and scanned for characters that need escaping with the vector routines
+ * in BCJSONScan.h; strings that need none, which is nearly all of them, are
+ * written without further work. BCVideo and BCPlaylist are written directly,
+ * using Media API field names so the output can be read back with
+ * makeVideoWithJSON: and makePlaylistWithJSON:.
+ */
+@interface BCJSONWriter : NSObject
+
+/**
+ * Initializes a writer that collects its output in memory; see data.
+ */
+- (id)init;
+
+/**
+ * Initializes a writer that writes its output to fd whenever the buffer
+ * fills, and on flush. The descriptor is not closed by the writer.
+ */
+- (id)initWithFileDescriptor:(int)fd;
+
+- (void)beginObject;
+- (void)endObject;
+- (void)beginArray;
+- (void)endArray;
+
+/**
+ * Writes an object key. The next value written is its value.
+ */
+- (void)writeKey:(NSString *)key;
+
+- (void)writeString:(NSString *)string;
+- (void)writeInteger:(long long)value;
+- (void)writeDouble:(double)value;
+- (void)writeBool:(BOOL)value;
+- (void)writeNull;
+
+/**
+ * Writes an NSDictionary, NSArray, NSString, NSNumber, NSNull, NSURL, BCVideo
+ * or BCPlaylist, recursively. Other objects are written as their description.
+ */
+- (void)writeObject:(id)object;
+
+- (void)writeVideo:(BCVideo *)video;
+- (void)writePlaylist:(BCPlaylist *)playlist;
+
+/**
+ * Writes any buffered output to the file descriptor.
+ *
+ * @return NO if a write failed; see error.
+ */
+- (BOOL)flush;
+
+/**
+ * The output so far, for writers without a file descriptor, or nil after an
+ * error.
+ */
+@property (nonatomic, readonly) NSData *data;
+
+/**
+ * The first error: containers nested too deeply, or a failed write to the file
+ * descriptor. Output after an error is discarded.
+ */
+@property (nonatomic, readonly, retain) NSError *error;
+
+/**
+ * Returns the JSON for a Foundation object, BCVideo or BCPlaylist, or nil if
+ * it is nested too deeply.
+ */
++ (NSData *)dataWithObject:(id)object;
+
+@end
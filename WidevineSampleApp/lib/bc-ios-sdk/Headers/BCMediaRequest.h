@@ -0,0 +1,79 @@
+//
+//  BCMediaRequest.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+@class BCMediaRequest;
+@class BCMediaRequestManager;
+@class BCMediaResponseCacheEntry;
+
+/**
+ * The type of blocks waiting on a BCMediaRequest.
+ * @param error the connection or HTTP error, or nil if successful.
+ * @param entry the entry holding the response body, or nil if an error occurred.
+ */
+typedef void (^BCMediaRequestCompletionBlock)(NSError *error, BCMediaResponseCacheEntry *entry);
+
+/**
+ * Connection state for a single Media API request.
+ *
+ * Each request owns its connections, responses and bodies, so any number of
+ * requests can be in flight at once. A request turns itself into a conditional
+ * request when a cached response exists, answers fresh cache hits without
+ * touching the network, and resolves a 304 Not Modified to the cached entry.
+ * Every completion block added before the request finishes receives the same
+ * entry.
+ *
+ * Each attempt is bounded by the manager's attemptTimeout. Attempts that time
+ * out, lose their connection or get a 5xx or 429 response are retried after
+ * the manager's backoff delay, up to maxAttempts and while the manager's retry
+ * budget lasts. An attempt that runs longer than the manager's hedgeDelay gets
+ * a second, concurrent copy; whichever finishes first answers the request and
+ * the other is cancelled.
+ */
+@interface BCMediaRequest : NSObject
+
+/**
+ * Designated initializer.
+ *
+ * @param request the Media API request.
+ */
+- (id)initWithRequest:(NSURLRequest *)request;
+
+/**
+ * Adds a block to be invoked when the request finishes.
+ */
+- (void)addCompletionBlock:(BCMediaRequestCompletionBlock)completionBlock;
+
+/**
+ * Starts the request. Fresh cache hits complete on the next run loop pass
+ * without a connection being made.
+ */
+- (void)start;
+
+/**
+ * The URL of the original, unconditional request.
+ */
+@property (nonatomic, readonly) NSURL *URL;
+
+/**
+ * The normalized form of URL, used to recognize identical requests.
+ */
+@property (nonatomic, readonly) NSString *key;
+
+/**
+ * YES if the request can complete from the cache without a connection.
+ */
+@property (nonatomic, readonly) BOOL isCacheHit;
+
+/**
+ * The manager that scheduled the request and is told when it finishes.
+ */
+@property (nonatomic, assign) BCMediaRequestManager *manager;
+
+@end
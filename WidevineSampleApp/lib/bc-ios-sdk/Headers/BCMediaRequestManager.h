@@ -0,0 +1,128 @@
+//
+//  BCMediaRequestManager.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+#import "BCMediaRequest.h"
+
+/**
+ * Schedules Media API requests for BCMediaService.
+ *
+ * Requests for the same normalized query (parameters sorted, token removed)
+ * are coalesced: while one is pending or in flight, later callers wait on it
+ * and all of them receive the same response. At most maxConcurrentRequests
+ * requests are in flight at once; the rest wait in FIFO order.
+ *
+ * The manager also sets the retry policy its requests follow. Retries wait an
+ * exponentially growing, randomly jittered delay so that clients that failed
+ * together don't retry together. Retries and hedged copies both draw on a
+ * shared budget that refills as requests succeed, so a struggling server sees
+ * a bounded amount of extra traffic rather than a retry storm.
+ *
+ * The manager is only used from the main thread.
+ */
+@interface BCMediaRequestManager : NSObject
+
+/**
+ * Returns the manager shared by all media services.
+ */
++ (BCMediaRequestManager *)sharedManager;
+
+/**
+ * Sends request, or joins an identical request that is already pending or in
+ * flight, and invokes completionBlock when it finishes.
+ */
+- (void)sendRequest:(NSURLRequest *)request completionBlock:(BCMediaRequestCompletionBlock)completionBlock;
+
+/**
+ * Called by a BCMediaRequest when it finishes, before its completion blocks run.
+ */
+- (void)mediaRequestDidFinish:(BCMediaRequest *)request;
+
+/**
+ * Maximum number of requests in flight. Defaults to 4.
+ */
+@property (nonatomic) NSUInteger maxConcurrentRequests;
+
+/**
+ * Maximum number of attempts per request, including the first and any hedged
+ * copy. Defaults to 3.
+ */
+@property (nonatomic) NSUInteger maxAttempts;
+
+/**
+ * Time after which an attempt is abandoned. Defaults to 15 seconds.
+ */
+@property (nonatomic) NSTimeInterval attemptTimeout;
+
+/**
+ * Upper bound of the delay before the first retry; each later retry doubles it,
+ * up to maxRetryDelay. The actual delay is chosen at random below the bound.
+ * Defaults to 0.5 seconds.
+ */
+@property (nonatomic) NSTimeInterval baseRetryDelay;
+
+/**
+ * Largest upper bound for a retry delay. Defaults to 8 seconds.
+ */
+@property (nonatomic) NSTimeInterval maxRetryDelay;
+
+/**
+ * Number of retries and hedged copies that can be made back to back. Each
+ * successful request returns retryBudgetRefill of one. Lowering it drops
+ * any retries saved above the new budget, so 0 turns retries off at once.
+ * Defaults to 10.
+ */
+@property (nonatomic) double retryBudget;
+
+/**
+ * Share of a retry returned to the budget by each successful request.
+ * Defaults to 0.2, so sustained retries stay below a fifth of requests.
+ */
+@property (nonatomic) double retryBudgetRefill;
+
+/**
+ * YES to send a second copy of requests that run longer than hedgeDelay.
+ * Defaults to YES.
+ */
+@property (nonatomic) BOOL hedgingEnabled;
+
+/**
+ * Number of retries and hedged copies sent.
+ */
+@property (nonatomic, readonly) NSUInteger retryCount;
+
+/**
+ * Returns the delay before retrying after the given number of attempts.
+ */
+- (NSTimeInterval)retryDelayForAttempt:(NSUInteger)attempt;
+
+/**
+ * Returns how long an attempt may run before it is hedged: the 95th percentile
+ * of recent request latencies. Returns 0, meaning don't hedge, if hedging is
+ * disabled or too few requests have completed to know.
+ */
+- (NSTimeInterval)hedgeDelay;
+
+/**
+ * Records the latency of a successful attempt, and refills the retry budget.
+ */
+- (void)recordLatency:(NSTimeInterval)latency;
+
+/**
+ * Takes one retry from the budget.
+ *
+ * @return NO if the budget is spent and the retry or hedge should not be sent.
+ */
+- (BOOL)requestRetryToken;
+
+/**
+ * Number of requests that joined an identical request instead of being sent.
+ */
+@property (nonatomic, readonly) NSUInteger coalescedRequestCount;
+
+@end
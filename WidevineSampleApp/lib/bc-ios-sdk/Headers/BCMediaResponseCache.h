@@ -0,0 +1,121 @@
+//
+//  BCMediaResponseCache.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+#import "BCCacheRegistry.h"
+
+/**
+ * A raw Media API response along with the HTTP validators needed to revalidate
+ * it and the objects that were built from it.
+ */
+@interface BCMediaResponseCacheEntry : NSObject
+
+/**
+ * The response body as it was received from the server.
+ */
+@property (nonatomic, retain) NSData *data;
+
+/**
+ * Value of the ETag response header, sent back as If-None-Match.
+ */
+@property (nonatomic, retain) NSString *etag;
+
+/**
+ * Value of the Last-Modified response header, sent back as If-Modified-Since.
+ */
+@property (nonatomic, retain) NSString *lastModified;
+
+/**
+ * Time after which the entry must be revalidated with the server, as computed
+ * from the Cache-Control max-age directive.
+ */
+@property (nonatomic, retain) NSDate *expirationDate;
+
+/**
+ * The parsed JSON for data, set the first time the body is parsed.
+ */
+@property (nonatomic, retain) id json;
+
+/**
+ * The BCPlaylist or BCVideo built from json.
+ */
+@property (nonatomic, retain) id object;
+
+/**
+ * YES if the entry can be used without contacting the server.
+ */
+@property (nonatomic, readonly) BOOL isFresh;
+
+/**
+ * YES if the server sent a validator, so the entry can be revalidated with a
+ * conditional request.
+ */
+@property (nonatomic, readonly) BOOL canRevalidate;
+
+@end
+
+/**
+ * An in-memory cache of Media API responses keyed by request URL, with the
+ * API token removed from the key. The cache honors the Cache-Control and ETag
+ * headers sent by the server and builds conditional requests for stale entries.
+ *
+ * The cache is only accessed from the main thread, which is where the media
+ * service receives its NSURLConnection callbacks. It registers in the
+ * BCCacheTierResponses tier of the shared BCCacheRegistry, with the response
+ * bodies as its cost.
+ */
+@interface BCMediaResponseCache : NSObject <BCRegisteredCache>
+
+/**
+ * Returns the cache shared by all media services.
+ */
++ (BCMediaResponseCache *)sharedCache;
+
+/**
+ * Returns the key used for a request URL: the URL with its query parameters
+ * sorted, so equivalent queries share a key, and the value of the token
+ * parameter redacted so keys can be logged safely.
+ */
++ (NSString *)cacheKeyForURL:(NSURL *)url;
+
+/**
+ * Returns the entry for a request URL, or nil if there is none.
+ */
+- (BCMediaResponseCacheEntry *)entryForURL:(NSURL *)url;
+
+/**
+ * Returns a copy of request with If-None-Match and If-Modified-Since set from
+ * the cached entry. Returns request unchanged if there is nothing to revalidate.
+ */
+- (NSURLRequest *)conditionalRequestForRequest:(NSURLRequest *)request;
+
+/**
+ * Stores a 200 response. If the body is identical to the one already cached,
+ * the existing entry is kept along with its parsed objects.
+ *
+ * @return the entry for the response, or nil if the response may not be cached.
+ */
+- (BCMediaResponseCacheEntry *)storeResponse:(NSHTTPURLResponse *)response data:(NSData *)data forURL:(NSURL *)url;
+
+/**
+ * Updates the entry for url from a 304 response and returns it.
+ */
+- (BCMediaResponseCacheEntry *)revalidateWithResponse:(NSHTTPURLResponse *)response forURL:(NSURL *)url;
+
+/**
+ * Removes all cached responses.
+ */
+- (void)removeAllEntries;
+
+/**
+ * Maximum number of responses kept; the least recently used are evicted
+ * first. Defaults to 32.
+ */
+@property (nonatomic) NSUInteger countLimit;
+
+@end
@@ -8,6 +8,41 @@
 
 #import "BCMediaService.h"
 
+@class BCError;
+@class BCMediaResponseCacheEntry;
+
+/**
+ * The type of blocks receiving Media API responses.
+ * @param error instance of BCError if the request failed or the Media API returned an error.
+ * @param json the parsed response, or nil if an error occurred.
+ * @param entry the entry holding the response. Objects built from json can be kept in
+ * entry.object so that requests sharing the response don't rebuild them.
+ */
+typedef void (^BCMediaServiceResponseBlock)(BCError *error, id json, BCMediaResponseCacheEntry *entry);
+
 @interface BCMediaService (Widevine)
 
+/**
+ * Starts opening a connection to the Media API host, so the first request
+ * doesn't wait for DNS, TCP and TLS setup. Requests made afterwards reuse it.
+ *
+ * @param baseURL the base URL the media service will use, or nil for the default.
+ */
++ (void)warmConnectionWithBaseURL:(NSString *)baseURL;
+
+/**
+ * Returns the Media API request for the given query parameters. Only string and number
+ * values are sent; parameters are sorted and the service's token is appended.
+ */
+- (NSURLRequest *)requestWithParams:(NSDictionary *)params;
+
+/**
+ * Sends a Media API request through the shared BCMediaRequestManager, so that it is
+ * coalesced with identical requests and answered from the response cache when possible.
+ *
+ * @param params the query parameters, including the command.
+ * @param responseBlock invoked on the main thread with the parsed response.
+ */
+- (void)sendRequestWithParams:(NSDictionary *)params responseBlock:(BCMediaServiceResponseBlock)responseBlock;
+
 @end
@@ -0,0 +1,100 @@
+//
+//  BCNetworkActivityScheduler.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+typedef void (^BCNetworkActivityBlock)(void);
+
+/**
+ * Lines up deferrable network work so that it shares radio wake-ups.
+ *
+ * Each task has a window: it may run from its start time and must run by its
+ * deadline. The scheduler sets one timer, for the earliest deadline. When it
+ * fires, or when networkWasUsed reports that something else has woken the
+ * radio, every task whose window has opened runs as well. A task never runs
+ * after its deadline, except by the timer's own slop.
+ *
+ * Periodic tasks are due once per period and may run up to their tolerance
+ * early.
+ *
+ * The Widevine heartbeat and EMM renewals are sent by libWViPhoneAPI on timers
+ * the app can't see or move, and the plugin reports neither, so the scheduler
+ * does not line work up with them. Alignment with the heartbeat is only
+ * simulated, by BCNetworkActivitySchedulerTests, to size the windows of the
+ * tasks that are scheduled here.
+ *
+ * The scheduler is only used from the main thread.
+ */
+@interface BCNetworkActivityScheduler : NSObject
+
+/**
+ * Returns the scheduler shared by the app.
+ */
++ (BCNetworkActivityScheduler *)sharedScheduler;
+
+/**
+ * Returns a scheduler whose clock only moves when advanceSimulatedClockBy: is
+ * called, for measuring a schedule without waiting for it.
+ */
+- (id)initWithSimulatedClock;
+
+/**
+ * Schedules block to run once, no sooner than delay seconds from now and no
+ * later than deadline seconds from now.
+ *
+ * @return a task to pass to cancelTask:.
+ */
+- (id)scheduleTaskNamed:(NSString *)name afterDelay:(NSTimeInterval)delay deadline:(NSTimeInterval)deadline block:(BCNetworkActivityBlock)block;
+
+/**
+ * Schedules block to run every period seconds, first period seconds from now.
+ * Each run may happen up to tolerance seconds early to share a wake-up.
+ *
+ * @return a task to pass to cancelTask:.
+ */
+- (id)schedulePeriodicTaskNamed:(NSString *)name period:(NSTimeInterval)period tolerance:(NSTimeInterval)tolerance block:(BCNetworkActivityBlock)block;
+
+/**
+ * Removes a task returned by one of the schedule methods. Does nothing if the
+ * task has already run.
+ */
+- (void)cancelTask:(id)task;
+
+/**
+ * Reports that the radio is awake because of other traffic, such as a Media
+ * API response, and runs every task whose window has opened.
+ */
+- (void)networkWasUsed;
+
+/**
+ * Moves a simulated clock forward by interval, firing deadlines on the way.
+ */
+- (void)advanceSimulatedClockBy:(NSTimeInterval)interval;
+
+/**
+ * Number of times the scheduler woke the radio itself, at a deadline.
+ */
+@property (nonatomic, readonly) NSUInteger wakeUpCount;
+
+/**
+ * Number of task runs. Without the scheduler each would be a wake-up of its own.
+ */
+@property (nonatomic, readonly) NSUInteger taskRunCount;
+
+/**
+ * Number of task runs that happened more than a second after their deadline.
+ */
+@property (nonatomic, readonly) NSUInteger lateRunCount;
+
+/**
+ * Returns the wake-ups saved per hour since the scheduler was created: task
+ * runs that shared a wake-up rather than causing one.
+ */
+- (double)wakeUpsSavedPerHour;
+
+@end
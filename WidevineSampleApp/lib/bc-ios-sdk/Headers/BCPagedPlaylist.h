@@ -0,0 +1,91 @@
+//
+//  BCPagedPlaylist.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+#import "BCCacheRegistry.h"
+
+@class BCCatalog;
+@class BCError;
+@class BCVideo;
+
+/**
+ * The type of blocks invoked when a page finishes loading.
+ * @param error instance of BCError if the page could not be loaded, or nil if successful.
+ * @param range the indexes of the videos in the page.
+ */
+typedef void (^BCPagedPlaylistCompletionBlock)(BCError *error, NSRange range);
+
+/**
+ * A list of videos loaded one page at a time from a paged Media API query.
+ *
+ * Pages are loaded in order by loadNextPageWithCompletionBlock:. Only
+ * maxResidentPages pages are kept; when another one is loaded, the page farthest
+ * from it is evicted. videoAtIndex: returns nil for an evicted page and
+ * loadPageContainingIndex:completionBlock: brings it back, so memory use stays
+ * the same however far the list is scrolled.
+ *
+ * Resident pages are accounted for in the BCCacheTierPlaylists tier of the
+ * shared BCCacheRegistry, which may evict all but the most recently loaded
+ * page under memory pressure.
+ */
+@interface BCPagedPlaylist : NSObject <BCRegisteredCache>
+
+/**
+ * Designated initializer.
+ *
+ * @param catalog the catalog used to load pages.
+ * @param pageSize the number of videos per page.
+ * @param options query parameters sent with every page; see
+ * BCCatalog findVideoPage:pageSize:options:callBlock:.
+ */
+- (id)initWithCatalog:(BCCatalog *)catalog pageSize:(NSUInteger)pageSize options:(NSDictionary *)options;
+
+/**
+ * Loads the page after the last one loaded.
+ *
+ * @return NO if there are no more pages or the next page is already loading, in
+ * which case completionBlock is not invoked.
+ */
+- (BOOL)loadNextPageWithCompletionBlock:(BCPagedPlaylistCompletionBlock)completionBlock;
+
+/**
+ * Loads the page holding index if it was evicted.
+ *
+ * @return NO if the page is resident or already loading, in which case
+ * completionBlock is not invoked.
+ */
+- (BOOL)loadPageContainingIndex:(NSUInteger)index completionBlock:(BCPagedPlaylistCompletionBlock)completionBlock;
+
+/**
+ * Returns the video at index, or nil if its page is not resident.
+ */
+- (BCVideo *)videoAtIndex:(NSUInteger)index;
+
+/**
+ * Returns the index of video among the resident pages, or NSNotFound.
+ */
+- (NSUInteger)indexOfVideo:(BCVideo *)video;
+
+/**
+ * Number of videos in the pages loaded so far, including evicted ones.
+ */
+@property (nonatomic, readonly) NSUInteger count;
+
+/**
+ * YES until the last page of the query has been loaded.
+ */
+@property (nonatomic, readonly) BOOL hasMorePages;
+
+@property (nonatomic, readonly) NSUInteger pageSize;
+
+/**
+ * Maximum number of pages kept in memory. Defaults to 5.
+ */
+@property (nonatomic) NSUInteger maxResidentPages;
+
+@end
@@ -0,0 +1,51 @@
+//
+//  BCPlaylistSnapshot.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+@class BCPlaylist;
+
+/**
+ * Reads and writes a compact binary snapshot of a BCPlaylist, so the last
+ * playlist fetched from the Media API can be shown at launch before the
+ * network request completes.
+ *
+ * A snapshot keeps the properties the player and the playlist table use (name,
+ * description, IDs, duration, still URL and rendition URL); raw JSON
+ * properties such as customFields are not kept.
+ */
+@interface BCPlaylistSnapshot : NSObject
+
+/**
+ * Returns the snapshot encoding of playlist.
+ */
++ (NSData *)dataWithPlaylist:(BCPlaylist *)playlist;
+
+/**
+ * Decodes a snapshot. Returns nil if data is not a valid snapshot.
+ */
++ (BCPlaylist *)playlistWithData:(NSData *)data;
+
+/**
+ * Memory-maps the snapshot at path and decodes it. Returns nil if the file
+ * does not exist or is not a valid snapshot.
+ */
++ (BCPlaylist *)playlistWithContentsOfFile:(NSString *)path;
+
+/**
+ * Encodes playlist and writes it atomically to path on a background queue.
+ */
++ (void)writePlaylist:(BCPlaylist *)playlist toFile:(NSString *)path;
+
+/**
+ * Returns YES if both playlists have the same snapshot: the same videos in the
+ * same order, with the same names, stills and rendition URLs.
+ */
++ (BOOL)playlist:(BCPlaylist *)playlist hasSameContentAsPlaylist:(BCPlaylist *)otherPlaylist;
+
+@end
@@ -0,0 +1,96 @@
+//
+//  BCQoEMonitor.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCComponent.h"
+
+@class BCWidevinePlugin;
+
+/**
+ * The quality of experience measures kept for each playback session.
+ */
+typedef enum BCQoEMetric {
+    /** Seconds from BCEventVideoWillPlay until the first BCEventVideoDidPlay or BCEventVideoProgress. */
+    BCQoEMetricStartupTime = 0,
+    /** Number of times playback stalled without being paused. */
+    BCQoEMetricRebufferCount,
+    /** Time spent stalled as a share of the time spent playing or stalled. */
+    BCQoEMetricRebufferRatio,
+    /** Average Widevine bitrate over the time spent playing, in kbps. */
+    BCQoEMetricAverageBitrate,
+    /** Number of times Widevine changed bitrate after the first. */
+    BCQoEMetricBitrateSwitches,
+    BCQoEMetricCount
+} BCQoEMetric;
+
+/**
+ * Measures playback quality of experience so that releases can be compared.
+ *
+ * A session runs from BCEventVideoWillPlay until the video ends or another is
+ * set. During a session the monitor tracks startup time from the first
+ * BCEventVideoDidPlay or BCEventVideoProgress, stalls from
+ * BCEventPlayerRateChange, and bitrate changes from the Widevine plugin's
+ * currentBitrate, which follows the SetCurrentBitrate callbacks. When the
+ * session ends, each BCQoEMetric is added to a histogram with fixed buckets
+ * along with a running sum, so memory use doesn't grow with the number or
+ * length of sessions.
+ *
+ * The monitor is only used from the main thread.
+ */
+@interface BCQoEMonitor : BCComponent
+
+/**
+ * The plugin whose currentBitrate is observed. Not retained, so set it to nil
+ * before the plugin is released.
+ */
+@property (nonatomic, assign) BCWidevinePlugin *widevinePlugin;
+
+/**
+ * Number of sessions recorded in the histograms.
+ */
+@property (nonatomic, readonly) NSUInteger sessionCount;
+
+/**
+ * Records a bitrate change, in bits per second, for the current session. Called
+ * when widevinePlugin's currentBitrate changes.
+ */
+- (void)recordBitrate:(double)bitsPerSecond;
+
+/**
+ * Ends the current session, if any, and adds it to the histograms.
+ */
+- (void)endSession;
+
+/**
+ * Returns the upper bounds of the buckets of metric's histogram. Values above
+ * the last bound are counted in one more, overflow bucket.
+ */
+- (NSArray *)bucketBoundsForMetric:(BCQoEMetric)metric;
+
+/**
+ * Returns the number of sessions in each bucket of metric's histogram,
+ * including the overflow bucket.
+ */
+- (NSArray *)bucketCountsForMetric:(BCQoEMetric)metric;
+
+/**
+ * Returns the mean of metric over all recorded sessions, or 0 if there are none.
+ */
+- (double)meanForMetric:(BCQoEMetric)metric;
+
+/**
+ * Returns the histograms as compact JSON: the session count, and for each
+ * metric its bucket bounds, bucket counts and sum.
+ */
+- (NSData *)exportedData;
+
+/**
+ * Clears the histograms. The current session, if any, carries on.
+ */
+- (void)reset;
+
+@end
@@ -8,6 +8,19 @@
 
 #import "BCRenditionSelector.h"
 
+/**
+ * Chooses which of a video's Widevine renditions to play, then hands it to WV_Play.
+ *
+ * Renditions the device can't decode are skipped: non-H.264 renditions are used only
+ * when there is nothing else, and renditions larger than the screen only when nothing
+ * smaller exists. Of the rest, the selector picks the highest encodingRate that fits
+ * within 80% of the shared BCThroughputEstimator's estimate, or the lowest if none does.
+ */
 @interface BCRenditionSelector (Widevine)
 
+/**
+ * Returns the rendition of video that selectFirstRendition: will play.
+ */
+- (BCRendition *)preferredRenditionForVideo:(BCVideo *)video;
+
 @end
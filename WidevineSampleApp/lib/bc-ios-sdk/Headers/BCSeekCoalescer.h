@@ -0,0 +1,85 @@
+//
+//  BCSeekCoalescer.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+@class BCChapterIndex;
+
+/**
+ * Block that starts a seek to time, in seconds. An exact seek must land on
+ * time; any other may land on the nearest keyframe.
+ */
+typedef void (^BCSeekBlock)(NSTimeInterval time, BOOL exact);
+
+/**
+ * Keeps at most one seek in flight.
+ *
+ * A seek asked for while another is in flight is held until seekDidFinish is
+ * called, and replaces any seek already held, so scrubbing only ever seeks to
+ * the latest position once the player catches up. A seek that has not
+ * finished within a second is given up on, so a lost completion never stalls
+ * scrubbing.
+ *
+ * Seeks that are not exact snap to a chapter start of chapterIndex near their
+ * target, and otherwise leave the player free to land on a nearby keyframe.
+ * Exact seeks go where they are asked to.
+ *
+ * Coalescers are only used from the main thread.
+ */
+@interface BCSeekCoalescer : NSObject
+
+/**
+ * Designated initializer. block is called for each seek that is started.
+ */
+- (id)initWithSeekBlock:(BCSeekBlock)block;
+
+/**
+ * Chapters whose start times seeks that are not exact snap to, or nil.
+ */
+@property (nonatomic, retain) BCChapterIndex *chapterIndex;
+
+/**
+ * Largest distance, in seconds, a target moves to reach a chapter start.
+ * Defaults to 1.5.
+ */
+@property (nonatomic) NSTimeInterval chapterSnapTolerance;
+
+/**
+ * Asks for a seek to time, in seconds, starting it now if no seek is in
+ * flight.
+ *
+ * @return the snapped target the seek will go to.
+ */
+- (NSTimeInterval)requestSeekTo:(NSTimeInterval)time exact:(BOOL)exact;
+
+/**
+ * Reports that the seek in flight has finished and starts the one held, if any.
+ */
+- (void)seekDidFinish;
+
+/**
+ * Drops the seek held and forgets the one in flight, such as when the video changes.
+ */
+- (void)reset;
+
+/**
+ * Number of seeks asked for.
+ */
+@property (nonatomic, readonly) NSUInteger requestCount;
+
+/**
+ * Number of seeks started.
+ */
+@property (nonatomic, readonly) NSUInteger seekCount;
+
+/**
+ * Number of seeks replaced by a later one before they started.
+ */
+@property (nonatomic, readonly) NSUInteger droppedCount;
+
+@end
@@ -0,0 +1,47 @@
+//
+//  BCSeekingControls.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCUIControls.h"
+
+@class BCSeekCoalescer;
+
+/**
+ * Playback controls whose scrubbing seeks through a BCSeekCoalescer.
+ *
+ * BCUIControls emits a BCEventSeekTo for every slider change, each of which
+ * the player starts at once, so a fast scrub queues up seeks to positions the
+ * slider has already left. These controls keep one seek in flight, until the
+ * player emits BCEventDidSeekTo, and then seek to wherever the slider is.
+ * Seeks while the slider moves snap to chapter starts of the video playing,
+ * from BCChapterIndex currentChapterIndex, or else to the nearest keyframe;
+ * the seek when it is released is exact, to wherever the slider was let go.
+ *
+ * Times on the control bar are formatted by BCTimeFormatter sharedFormatter.
+ *
+ * ### Allowed to Emit
+ *
+ * In addition to those of BCUIControls:
+ *
+ *  - BCEventSeekTo - with a time and tolerances, as a CMTime in an NSValue
+ *
+ * ### Allowed Listeners
+ *
+ * In addition to those of BCUIControls:
+ *
+ *  - BCEventDidSeekTo - to start the latest seek asked for
+ *  - BCEventDidSetVideo - to drop seeks meant for the previous video
+ */
+@interface BCSeekingControls : BCUIControls
+
+/**
+ * The coalescer scrubbing seeks through. Its chapterIndex is set to the
+ * current video's chapters when scrubbing begins.
+ */
+@property (nonatomic, readonly, retain) BCSeekCoalescer *seekCoalescer;
+
+@end
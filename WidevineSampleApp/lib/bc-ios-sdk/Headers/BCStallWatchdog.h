@@ -0,0 +1,80 @@
+//
+//  BCStallWatchdog.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Watches for passes of the main run loop that take longer than a threshold,
+ * such as a WV_Play or a plist read done on the main thread, and samples the
+ * main thread's stack while they last.
+ *
+ * A run loop observer records when each pass of the main run loop begins. A
+ * thread of the watchdog's own checks it every quarter of the threshold. Once
+ * a pass runs past the threshold, the thread suspends the main thread every
+ * sampleInterval, walks its frame pointers into a fixed buffer and resumes it,
+ * and only then symbolizes the frames with dladdr. Each sample is credited to
+ * its call site: the innermost frame in the app's own image, or the innermost
+ * frame if none is. Call sites are symbol names where the binary keeps them.
+ *
+ * The last stalls are kept in a ring buffer, each with its samples counted by
+ * call site, and exportedReport adds them up by call site. Between stalls the
+ * thread only wakes to compare two times; overhead reports what it costs.
+ *
+ * start and stop are called on the main thread; the rest may be called on any.
+ */
+@interface BCStallWatchdog : NSObject
+
+/**
+ * Returns the watchdog shared by the app.
+ */
++ (BCStallWatchdog *)sharedWatchdog;
+
+/**
+ * Shortest pass of the run loop reported as a stall, in seconds. Defaults to 0.25.
+ */
+@property (nonatomic) NSTimeInterval threshold;
+
+/**
+ * Seconds between stack samples during a stall. Defaults to 0.01.
+ */
+@property (nonatomic) NSTimeInterval sampleInterval;
+
+/**
+ * Starts watching the main run loop. Does nothing if already watching.
+ */
+- (void)start;
+
+/**
+ * Stops watching. Stalls already recorded are kept.
+ */
+- (void)stop;
+
+/**
+ * Number of stalls since the watchdog was created, including those the ring
+ * buffer no longer holds.
+ */
+@property (nonatomic, readonly) NSUInteger stallCount;
+
+/**
+ * Returns the CPU time the watchdog thread has used as a fraction of the time
+ * it has been watching.
+ */
+- (double)overhead;
+
+/**
+ * Returns the recent stalls, oldest first, and their samples added up by call
+ * site, most sampled first, as JSON.
+ */
+- (NSData *)exportedReport;
+
+/**
+ * Forgets the stalls recorded so far.
+ */
+- (void)reset;
+
+@end
@@ -0,0 +1,65 @@
+//
+//  BCStartupTimeline.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Records how long each phase of startup takes, relative to when the timeline
+ * was created, so changes to the startup sequence can be measured.
+ *
+ * Phases may overlap. Each phase and milestone is recorded the first time it
+ * happens; after finish, the timeline stops recording, so later refreshes
+ * don't distort the launch numbers.
+ *
+ * The timeline is only used from the main thread.
+ */
+@interface BCStartupTimeline : NSObject
+
+/**
+ * Returns the timeline for this launch. The first call starts the clock.
+ */
++ (BCStartupTimeline *)sharedTimeline;
+
+/**
+ * Marks the start of the named phase.
+ */
+- (void)beginPhase:(NSString *)name;
+
+/**
+ * Marks the end of the named phase.
+ */
+- (void)endPhase:(NSString *)name;
+
+/**
+ * Marks a point in time, such as the first video being queued.
+ */
+- (void)markMilestone:(NSString *)name;
+
+/**
+ * Returns the duration of a phase that has ended, or a negative value.
+ */
+- (NSTimeInterval)durationOfPhase:(NSString *)name;
+
+/**
+ * Returns the time from the start of the timeline to a milestone, or a
+ * negative value if it hasn't happened.
+ */
+- (NSTimeInterval)timeOfMilestone:(NSString *)name;
+
+/**
+ * Marks the named milestone as the end of startup, logs every phase and
+ * milestone in order of start time, and stops recording.
+ */
+- (void)finishWithMilestone:(NSString *)name;
+
+/**
+ * YES once finishWithMilestone: has been called.
+ */
+@property (nonatomic, readonly) BOOL isFinished;
+
+@end
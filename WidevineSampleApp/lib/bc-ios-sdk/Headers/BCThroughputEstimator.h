@@ -0,0 +1,134 @@
+//
+//  BCThroughputEstimator.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+typedef enum BCNetworkType {
+    BCNetworkTypeUnknown = 0,
+    BCNetworkTypeWiFi,
+    BCNetworkTypeCellular,
+} BCNetworkType;
+
+/**
+ * Estimates network throughput from the transfers the app makes: the video
+ * stream, from the access log of each AVPlayerItem, and Media API responses
+ * and video stills, each timed from its response to its last byte. The stream
+ * moves far more data than anything else, so it dominates the estimate once a
+ * video has played; the smaller transfers fill in before that.
+ *
+ * Samples are kept separately for each network type, since a WiFi estimate
+ * says little about a cellular connection. For each type the estimator keeps
+ * a sliding window of recent transfers, whose throughput is their total bytes
+ * over their total time, and an exponentially weighted moving average of each
+ * transfer's throughput. The estimate is the lower of the two, so one fast
+ * transfer doesn't raise it before the window agrees, and a sudden slowdown
+ * lowers it straight away.
+ *
+ * Rendition selection, prefetch depth and download scheduling all read the
+ * shared estimator, which persists its samples in NSUserDefaults so that the
+ * first decisions after a launch are based on the last session.
+ *
+ * The estimator is only used from the main thread.
+ */
+@interface BCThroughputEstimator : NSObject
+
+/**
+ * Returns the estimator shared by the app. It tracks the current network type
+ * with SCNetworkReachability and records the streams AVPlayer plays.
+ */
++ (BCThroughputEstimator *)sharedEstimator;
+
+/**
+ * Returns an estimator whose samples are persisted in the standard user
+ * defaults under key, or not persisted at all if key is nil. The network type
+ * isn't tracked; set networkType or record samples for an explicit type.
+ */
+- (id)initWithDefaultsKey:(NSString *)key;
+
+/**
+ * The type of the network transfers are currently made over.
+ */
+@property (nonatomic) BCNetworkType networkType;
+
+/**
+ * Records that bytes were received in duration over the current network.
+ * Transfers smaller than minimumTransferSize are ignored.
+ */
+- (void)recordTransferOfBytes:(long long)bytes duration:(NSTimeInterval)duration;
+
+/**
+ * Records that bytes were received in duration over a network of the given type.
+ */
+- (void)recordTransferOfBytes:(long long)bytes duration:(NSTimeInterval)duration networkType:(BCNetworkType)type;
+
+/**
+ * Records part of a stream, bytes long, received at bitsPerSecond over the
+ * current network. The shared estimator calls this with each finished
+ * AVPlayerItemAccessLogEvent, so segments fetched by the player count as
+ * transfers; the Widevine proxy fetches them as the player reads, so the
+ * observed bitrate follows the network.
+ */
+- (void)recordStreamTransferOfBytes:(long long)bytes observedBitrate:(double)bitsPerSecond;
+
+/**
+ * Returns the estimated throughput of the current network, in bits per second.
+ */
+- (double)estimatedBandwidth;
+
+/**
+ * Returns the estimated throughput of a network type, in bits per second, or
+ * defaultBandwidth if nothing has been recorded for it.
+ */
+- (double)estimatedBandwidthForNetworkType:(BCNetworkType)type;
+
+/**
+ * Returns the throughput over the sliding window for a network type, in bits
+ * per second, or 0 if nothing has been recorded for it.
+ */
+- (double)windowBandwidthForNetworkType:(BCNetworkType)type;
+
+/**
+ * Returns the moving average throughput for a network type, in bits per
+ * second, or 0 if nothing has been recorded for it.
+ */
+- (double)averageBandwidthForNetworkType:(BCNetworkType)type;
+
+/**
+ * Returns how long receiving bytes is expected to take on the current network.
+ */
+- (NSTimeInterval)estimatedDurationForBytes:(long long)bytes;
+
+/**
+ * Discards all samples, including persisted ones.
+ */
+- (void)reset;
+
+/**
+ * Number of transfers in the sliding window. Defaults to 16.
+ */
+@property (nonatomic) NSUInteger windowSize;
+
+/**
+ * Weight of the newest transfer in the moving average. Defaults to 0.2.
+ */
+@property (nonatomic) double smoothingFactor;
+
+/**
+ * Transfers smaller than this many bytes are dominated by latency and TCP slow
+ * start rather than throughput, and are ignored. Defaults to 64KB, so small
+ * API responses and thumbnails don't hold the estimate below the link rate.
+ */
+@property (nonatomic) long long minimumTransferSize;
+
+/**
+ * Estimate for a network type with no samples, in bits per second. Defaults
+ * to 1 Mbps.
+ */
+@property (nonatomic) double defaultBandwidth;
+
+@end
@@ -0,0 +1,53 @@
+//
+//  BCTimeFormatter.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+typedef enum BCTimeFormatterStyle {
+    /** Minutes and seconds, such as 07:05, as on the control bar. */
+    BCTimeFormatterStyleMinutesSeconds = 0,
+    /** Hours, minutes and seconds, such as 1:07:05, as in the playlist. */
+    BCTimeFormatterStyleHoursMinutesSeconds,
+    BCTimeFormatterStyleCount
+} BCTimeFormatterStyle;
+
+/**
+ * Formats whole seconds as times without stringWithFormat:.
+ *
+ * Digits are written into a fixed buffer, and the strings made from it are
+ * kept in a small cache per style, indexed by the second they show. Progress
+ * ticks land on the same second several times and playlist durations repeat
+ * as rows scroll back into view, so most calls return a cached string and
+ * allocate nothing.
+ *
+ * The formatter is only used from the main thread.
+ */
+@interface BCTimeFormatter : NSObject
+
+/**
+ * Returns the formatter shared by the table and the control bar.
+ */
++ (BCTimeFormatter *)sharedFormatter;
+
+/**
+ * Returns time, in seconds, truncated to a whole second and formatted in
+ * style. Negative and non-finite times format as zero.
+ */
+- (NSString *)stringForSeconds:(NSTimeInterval)time style:(BCTimeFormatterStyle)style;
+
+/**
+ * Number of calls answered from the cache.
+ */
+@property (nonatomic, readonly) NSUInteger hitCount;
+
+/**
+ * Number of calls that made a new string.
+ */
+@property (nonatomic, readonly) NSUInteger missCount;
+
+@end
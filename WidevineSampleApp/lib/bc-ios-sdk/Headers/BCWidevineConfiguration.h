@@ -0,0 +1,109 @@
+//
+//  BCWidevineConfiguration.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ * Posted on the main thread when the shared configuration is replaced after
+ * its file changed. The object is the new configuration.
+ */
+FOUNDATION_EXPORT NSString *const BCWidevineConfigurationDidChangeNotification;
+
+/**
+ * Domain of the errors describing invalid configurations.
+ */
+FOUNDATION_EXPORT NSString *const BCWidevineConfigurationErrorDomain;
+
+/**
+ * The settings from widevine.plist, parsed and validated once.
+ *
+ * Configurations are immutable, so they can be read from any thread. The
+ * shared configuration is loaded with loadSharedConfigurationWithContentsOfFile:
+ * error:, after which its file is watched: when it is rewritten, the file is
+ * parsed again off the main thread and, if it is still valid, replaces the
+ * shared configuration and BCWidevineConfigurationDidChangeNotification is
+ * posted. An invalid edit is logged and the previous configuration is kept.
+ *
+ * Recognized keys:
+ *
+ * - mediaApiToken: Media API read token with URL access. Required.
+ * - iosPlaylistReferenceId: reference ID of the playlist to show. Required
+ *   unless pagedSearchPageSize is set.
+ * - mediaApiBaseUrl: Media API base URL. Optional.
+ * - pagedSearchPageSize, pagedSearchQuery: page through search_videos results
+ *   instead of loading a playlist. Optional.
+ * - analyticsBatchUrl: endpoint taking batches of analytics beacons; see
+ *   BCAnalyticsBatcher. Optional.
+ * - WVDRMServerKey, WVDRMAckUrlKey, WVHeartbeatUrlKey, WVHeartbeatPeriodKey,
+ *   WVPreloadTimeoutKey, WVPortalKey, WVClientIdKey, WVCAUserDataKey: Widevine
+ *   setup values, collected in widevineSettings. Optional. drmServerUrl is
+ *   accepted in place of WVDRMServerKey.
+ */
+@interface BCWidevineConfiguration : NSObject
+
+/**
+ * Returns the shared configuration, or nil if none was loaded.
+ */
++ (BCWidevineConfiguration *)sharedConfiguration;
+
+/**
+ * Loads the configuration at path, makes it the shared configuration and
+ * starts watching the file for changes.
+ *
+ * @return NO, leaving the shared configuration unchanged, if the file is
+ * missing or invalid.
+ */
++ (BOOL)loadSharedConfigurationWithContentsOfFile:(NSString *)path error:(NSError **)error;
+
+/**
+ * Returns the configuration in a property list file, or nil if it is missing
+ * or invalid.
+ */
++ (BCWidevineConfiguration *)configurationWithContentsOfFile:(NSString *)path error:(NSError **)error;
+
+/**
+ * Designated initializer. Returns nil if dictionary is invalid.
+ */
+- (id)initWithDictionary:(NSDictionary *)dictionary error:(NSError **)error;
+
+@property (nonatomic, readonly, copy) NSString *mediaApiToken;
+@property (nonatomic, readonly, copy) NSString *playlistReferenceID;
+
+/**
+ * The Media API base URL, or nil for the default.
+ */
+@property (nonatomic, readonly, copy) NSString *mediaApiBaseURL;
+
+/**
+ * Results per page when paging through a search, or 0 to load the playlist.
+ */
+@property (nonatomic, readonly) NSUInteger pagedSearchPageSize;
+
+/**
+ * The search_videos 'all' criteria for paged search, or nil.
+ */
+@property (nonatomic, readonly, copy) NSString *pagedSearchQuery;
+
+/**
+ * The license server URL, or nil.
+ */
+@property (nonatomic, readonly, copy) NSString *drmServerURL;
+
+/**
+ * The endpoint analytics beacons are posted to in batches, or nil to send
+ * each beacon as it happens.
+ */
+@property (nonatomic, readonly, copy) NSString *analyticsBatchURL;
+
+/**
+ * The Widevine setup values present in the file, keyed by WViPhoneAPI.h
+ * setting names, ready to pass to WV_Initialize.
+ */
+@property (nonatomic, readonly, copy) NSDictionary *widevineSettings;
+
+@end
@@ -0,0 +1,128 @@
+//
+//  WViPhoneAPISimulator.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+#import "WViPhoneAPI.h"
+
+/**
+ * The simulator replaces libWViPhoneAPI when building for the iOS Simulator, or
+ * anywhere WV_SIMULATOR is defined, such as a Foundation-only build on a build box.
+ */
+#if TARGET_IPHONE_SIMULATOR || defined(WV_SIMULATOR)
+#define WV_SIMULATOR_ENABLED 1
+#else
+#define WV_SIMULATOR_ENABLED 0
+#endif
+
+/**
+ * Keys of a script step. See WVSimulator script.
+ */
+#define WVSimulatorStepEventKey @"event"
+#define WVSimulatorStepDelayKey @"delay"
+#define WVSimulatorStepAttributesKey @"attributes"
+
+/**
+ * Configures the simulated Widevine library behind the WV_* functions.
+ *
+ * The simulator implements the same C interface as libWViPhoneAPI: WV_Initialize
+ * reports Initialized through the status callback, WV_QueryAssetStatus reports
+ * QueryStatus, and WV_Play blocks for playLatency and then returns the URL of a
+ * local HTTP proxy for the asset, reporting Playing, Bitrates and
+ * SetCurrentBitrate followed by the steps of script. Every call and every
+ * proxied request takes its configured latency and fails at failureRate, so
+ * startup, switching and ABR code can be measured without a device or a DRM
+ * server.
+ *
+ * Callbacks are made on a private serial queue, as the library makes them on its
+ * own thread. The simulator may be configured from any thread, but changes made
+ * while a video is playing apply from the next call.
+ *
+ * The shared simulator reads its initial configuration from the plist named by
+ * the WV_SIMULATOR_CONFIG environment variable, or WVSimulator.plist in the
+ * main bundle, whose keys are the property names below.
+ *
+ * The simulator is only compiled when WV_SIMULATOR_ENABLED is 1.
+ */
+@interface WVSimulator : NSObject
+
+/**
+ * Returns the simulator used by the WV_* functions.
+ */
++ (WVSimulator *)sharedSimulator;
+
+/**
+ * Sets the properties named by the keys of configuration.
+ */
+- (void)configureWithDictionary:(NSDictionary *)configuration;
+
+/**
+ * Loads script from a plist holding an array of steps.
+ *
+ * @return NO if the file can't be read or isn't an array.
+ */
+- (BOOL)loadScriptWithContentsOfFile:(NSString *)path;
+
+/**
+ * Time between WV_Initialize and the Initialized event. Defaults to 0.5 seconds.
+ */
+@property (nonatomic) NSTimeInterval initializeLatency;
+
+/**
+ * Time between WV_QueryAssetStatus and the QueryStatus event. Defaults to 0.2 seconds.
+ */
+@property (nonatomic) NSTimeInterval queryLatency;
+
+/**
+ * Time WV_Play blocks before returning the proxy URL. Defaults to 1 second.
+ */
+@property (nonatomic) NSTimeInterval playLatency;
+
+/**
+ * Time between WV_SelectBitrateTrack and the SetCurrentBitrate event.
+ * Defaults to 2 seconds, about one segment.
+ */
+@property (nonatomic) NSTimeInterval bitrateSwitchLatency;
+
+/**
+ * Time the proxy waits before answering each request. Defaults to 0.05 seconds.
+ */
+@property (nonatomic) NSTimeInterval proxyLatency;
+
+/**
+ * Probability, from 0 to 1, that an initialization, query, play or proxied
+ * request fails. Defaults to 0.
+ */
+@property (nonatomic) double failureRate;
+
+/**
+ * Bitrate of each track, in bits per second, reported by the Bitrates event and
+ * selected by WV_SelectBitrateTrack. Defaults to 400, 800 and 1500 kbps.
+ */
+@property (nonatomic, copy) NSArray *bitrates;
+
+/**
+ * URL the proxy redirects players to, such as an unencrypted HLS stream of the
+ * same content. If nil, the asset URL passed to WV_Play is used.
+ */
+@property (nonatomic, retain) NSURL *playbackURL;
+
+/**
+ * Steps replayed, in order, after WV_Play succeeds. Each step is a dictionary
+ * with the event, either a WViOsApiEvent number or its name as returned by
+ * NSStringFromWViOsApiEvent (WVSimulatorStepEventKey), the delay after the
+ * previous step in seconds (WVSimulatorStepDelayKey) and the attributes to
+ * report (WVSimulatorStepAttributesKey). WV_Stop cancels the remaining steps.
+ */
+@property (nonatomic, copy) NSArray *script;
+
+/**
+ * Number of requests the proxy has answered.
+ */
+@property (nonatomic, readonly) NSUInteger proxiedRequestCount;
+
+@end
@@ -0,0 +1,594 @@
+//
+//  WViPhoneAPISimulator.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "WViPhoneAPISimulator.h"
+
+#if WV_SIMULATOR_ENABLED
+
+#import <arpa/inet.h>
+#import <netinet/in.h>
+#import <sys/socket.h>
+#import <unistd.h>
+
+#define WVSimulatorDefaultInitializeLatency 0.5
+#define WVSimulatorDefaultQueryLatency 0.2
+#define WVSimulatorDefaultPlayLatency 1.0
+#define WVSimulatorDefaultBitrateSwitchLatency 2.0
+#define WVSimulatorDefaultProxyLatency 0.05
+
+// Largest request head the proxy reads; players send far less.
+#define WVSimulatorMaxRequestLength 8192
+
+@interface WVSimulator ()
+{
+    int listenSocket;
+}
+
+@property (nonatomic) WViOsApiStatusCallback callback;
+@property (nonatomic) BOOL initialized;
+@property (nonatomic) BOOL playing;
+@property (nonatomic) NSUInteger generation;
+@property (nonatomic, retain) NSURL *upstreamURL;
+@property (nonatomic) dispatch_queue_t queue;
+@property (nonatomic) dispatch_queue_t callbackQueue;
+@property (nonatomic) dispatch_source_t acceptSource;
+@property (nonatomic) uint16_t proxyPort;
+@property (nonatomic, readwrite) NSUInteger proxiedRequestCount;
+
+- (void)serveClient:(int)client;
+
+@end
+
+@implementation WVSimulator
+
+@synthesize initializeLatency;
+@synthesize queryLatency;
+@synthesize playLatency;
+@synthesize bitrateSwitchLatency;
+@synthesize proxyLatency;
+@synthesize failureRate;
+@synthesize bitrates;
+@synthesize playbackURL;
+@synthesize script;
+@synthesize proxiedRequestCount;
+@synthesize callback;
+@synthesize initialized;
+@synthesize playing;
+@synthesize generation;
+@synthesize upstreamURL;
+@synthesize queue;
+@synthesize callbackQueue;
+@synthesize acceptSource;
+@synthesize proxyPort;
+
++ (WVSimulator *)sharedSimulator
+{
+    static WVSimulator *sharedSimulator = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedSimulator = [[WVSimulator alloc] init];
+
+        NSString *path = [[[NSProcessInfo processInfo] environment] objectForKey:@"WV_SIMULATOR_CONFIG"];
+        if (!path) {
+            path = [[NSBundle mainBundle] pathForResource:@"WVSimulator" ofType:@"plist"];
+        }
+        NSDictionary *configuration = path ? [NSDictionary dictionaryWithContentsOfFile:path] : nil;
+        if (configuration) {
+            [sharedSimulator configureWithDictionary:configuration];
+        }
+    });
+    return sharedSimulator;
+}
+
+- (id)init
+{
+    if (self = [super init]) {
+        listenSocket = -1;
+        self.queue = dispatch_queue_create("com.brightcove.widevine.simulator", DISPATCH_QUEUE_SERIAL);
+        self.callbackQueue = dispatch_queue_create("com.brightcove.widevine.simulator.callback", DISPATCH_QUEUE_SERIAL);
+        self.initializeLatency = WVSimulatorDefaultInitializeLatency;
+        self.queryLatency = WVSimulatorDefaultQueryLatency;
+        self.playLatency = WVSimulatorDefaultPlayLatency;
+        self.bitrateSwitchLatency = WVSimulatorDefaultBitrateSwitchLatency;
+        self.proxyLatency = WVSimulatorDefaultProxyLatency;
+        self.bitrates = [NSArray arrayWithObjects:
+                         [NSNumber numberWithInt:400000],
+                         [NSNumber numberWithInt:800000],
+                         [NSNumber numberWithInt:1500000], nil];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    if (self.acceptSource) {
+        dispatch_source_cancel(self.acceptSource);
+        dispatch_release(self.acceptSource);
+    }
+    dispatch_release(self.queue);
+    dispatch_release(self.callbackQueue);
+    self.bitrates = nil;
+    self.playbackURL = nil;
+    self.script = nil;
+    self.upstreamURL = nil;
+
+    [super dealloc];
+}
+
+- (void)configureWithDictionary:(NSDictionary *)configuration
+{
+    NSSet *numberKeys = [NSSet setWithObjects:@"initializeLatency", @"queryLatency", @"playLatency",
+                         @"bitrateSwitchLatency", @"proxyLatency", @"failureRate", nil];
+    NSSet *arrayKeys = [NSSet setWithObjects:@"bitrates", @"script", nil];
+
+    for (NSString *key in configuration) {
+        id value = [configuration objectForKey:key];
+        if ([numberKeys containsObject:key] && [value isKindOfClass:[NSNumber class]]) {
+            [self setValue:value forKey:key];
+        } else if ([arrayKeys containsObject:key] && [value isKindOfClass:[NSArray class]]) {
+            [self setValue:value forKey:key];
+        } else if ([key isEqualToString:@"playbackURL"] && [value isKindOfClass:[NSString class]]) {
+            self.playbackURL = [NSURL URLWithString:value];
+        } else {
+            NSLog(@"%s Ignoring setting '%@'", __PRETTY_FUNCTION__, key);
+        }
+    }
+}
+
+- (BOOL)loadScriptWithContentsOfFile:(NSString *)path
+{
+    NSArray *steps = [NSArray arrayWithContentsOfFile:path];
+    if (!steps) {
+        return NO;
+    }
+    self.script = steps;
+    return YES;
+}
+
+#pragma mark - Events
+
+- (BOOL)shouldFail
+{
+    return self.failureRate > 0 && arc4random_uniform(1000000) < self.failureRate * 1000000;
+}
+
+/**
+ * Reports event after delay, unless a video started or stopped since, when
+ * generation no longer matches. Pass NSNotFound to report it regardless.
+ *
+ * The callback runs on callbackQueue rather than queue, so that it may call
+ * the WV_* functions, as callbacks to the real library do.
+ */
+- (void)emitEvent:(WViOsApiEvent)event attributes:(NSDictionary *)attributes afterDelay:(NSTimeInterval)delay generation:(NSUInteger)eventGeneration
+{
+    [attributes retain];
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delay * NSEC_PER_SEC)), self.callbackQueue, ^{
+        __block WViOsApiStatusCallback eventCallback = NULL;
+        dispatch_sync(self.queue, ^{
+            if (eventGeneration == NSNotFound || eventGeneration == self.generation) {
+                eventCallback = self.callback;
+            }
+        });
+        if (eventCallback) {
+            eventCallback(event, attributes);
+        }
+        [attributes release];
+    });
+}
+
+- (void)emitEvent:(WViOsApiEvent)event attributes:(NSDictionary *)attributes afterDelay:(NSTimeInterval)delay
+{
+    [self emitEvent:event attributes:attributes afterDelay:delay generation:NSNotFound];
+}
+
+/**
+ * Returns the event a script step names, or WViOsApiEvent_NullEvent.
+ */
++ (WViOsApiEvent)eventForStepValue:(id)value
+{
+    if ([value isKindOfClass:[NSNumber class]]) {
+        return [value intValue];
+    }
+    if ([value isKindOfClass:[NSString class]]) {
+        for (int event = WViOsApiEvent_NullEvent; event <= WViOsApiEvent_AudioParams; event++) {
+            NSString *name = NSStringFromWViOsApiEvent(event);
+            if ([value isEqualToString:name] || [value isEqualToString:[name substringFromIndex:[@"WViOsApiEvent_" length]]]) {
+                return event;
+            }
+        }
+    }
+    return WViOsApiEvent_NullEvent;
+}
+
+/**
+ * Schedules the script for the video that just started. Must be called on queue.
+ */
+- (void)scheduleScript
+{
+    NSTimeInterval delay = 0;
+    for (NSDictionary *step in self.script) {
+        if (![step isKindOfClass:[NSDictionary class]]) {
+            continue;
+        }
+        delay += [[step objectForKey:WVSimulatorStepDelayKey] doubleValue];
+        WViOsApiEvent event = [WVSimulator eventForStepValue:[step objectForKey:WVSimulatorStepEventKey]];
+        if (event != WViOsApiEvent_NullEvent) {
+            NSDictionary *attributes = [step objectForKey:WVSimulatorStepAttributesKey];
+            [self emitEvent:event
+                 attributes:[attributes isKindOfClass:[NSDictionary class]] ? attributes : [NSDictionary dictionary]
+                 afterDelay:delay
+                 generation:self.generation];
+        }
+    }
+}
+
+#pragma mark - Proxy
+
+/**
+ * Starts listening on a loopback port if the proxy isn't running yet.
+ * Must be called on queue.
+ */
+- (BOOL)startProxy
+{
+    if (self.acceptSource) {
+        return YES;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return NO;
+    }
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    struct sockaddr_in address;
+    socklen_t length = sizeof(address);
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+        listen(fd, 16) != 0 ||
+        getsockname(fd, (struct sockaddr *)&address, &length) != 0) {
+        NSLog(@"%s Unable to start the proxy: %s", __PRETTY_FUNCTION__, strerror(errno));
+        close(fd);
+        return NO;
+    }
+    listenSocket = fd;
+    self.proxyPort = ntohs(address.sin_port);
+
+    self.acceptSource = dispatch_source_create(DISPATCH_SOURCE_TYPE_READ, fd, 0, self.queue);
+    dispatch_source_set_event_handler(self.acceptSource, ^{
+        int client = accept(listenSocket, NULL, NULL);
+        if (client >= 0) {
+            dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+                [self serveClient:client];
+            });
+        }
+    });
+    dispatch_source_set_cancel_handler(self.acceptSource, ^{
+        close(fd);
+    });
+    dispatch_resume(self.acceptSource);
+    return YES;
+}
+
+/**
+ * Answers one request: a redirect to the upstream URL if the path belongs to
+ * the video that is playing, 404 if it doesn't, or 503 if it is chosen to fail.
+ */
+- (void)serveClient:(int)client
+{
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    char buffer[WVSimulatorMaxRequestLength];
+    size_t length = 0;
+    while (length < sizeof(buffer) - 1) {
+        ssize_t count = read(client, buffer + length, sizeof(buffer) - 1 - length);
+        if (count <= 0) {
+            break;
+        }
+        length += count;
+        buffer[length] = '\0';
+        if (strstr(buffer, "\r\n\r\n")) {
+            break;
+        }
+    }
+    buffer[length] = '\0';
+
+    // "GET /<generation>/<name> HTTP/1.1"
+    unsigned long requestGeneration = 0;
+    BOOL parsed = sscanf(buffer, "GET /%lu/", &requestGeneration) == 1;
+
+    [NSThread sleepForTimeInterval:self.proxyLatency];
+
+    __block NSURL *location = nil;
+    dispatch_sync(self.queue, ^{
+        self.proxiedRequestCount++;
+        if (parsed && self.playing && requestGeneration == self.generation) {
+            location = [self.upstreamURL retain];
+        }
+    });
+    [location autorelease];
+
+    NSString *response;
+    if ([self shouldFail]) {
+        response = @"HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    } else if (location) {
+        response = [NSString stringWithFormat:@"HTTP/1.1 302 Found\r\nLocation: %@\r\nContent-Length: 0\r\nConnection: close\r\n\r\n",
+                    [location absoluteString]];
+    } else {
+        response = @"HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    }
+
+    const char *bytes = [response UTF8String];
+    size_t remaining = strlen(bytes);
+    while (remaining > 0) {
+        ssize_t count = write(client, bytes, remaining);
+        if (count <= 0) {
+            break;
+        }
+        bytes += count;
+        remaining -= count;
+    }
+    close(client);
+    [pool drain];
+}
+
+@end
+
+#pragma mark - WViPhoneAPI
+
+/**
+ * Runs block on the simulator's queue and returns its status.
+ */
+static WViOsApiStatus WVSimulatorSync(WViOsApiStatus (^block)(WVSimulator *simulator))
+{
+    WVSimulator *simulator = [WVSimulator sharedSimulator];
+    __block WViOsApiStatus status;
+    dispatch_sync(simulator.queue, ^{
+        status = block(simulator);
+    });
+    return status;
+}
+
+WViOsApiStatus WV_Initialize(const WViOsApiStatusCallback callback, NSDictionary *settings)
+{
+    return WVSimulatorSync(^WViOsApiStatus(WVSimulator *simulator) {
+        if (simulator.initialized) {
+            return WViOsApiStatus_AlreadyInitialized;
+        }
+        simulator.callback = callback;
+        if ([simulator shouldFail]) {
+            [simulator emitEvent:WViOsApiEvent_InitializeFailed
+                      attributes:[NSDictionary dictionaryWithObject:[NSNumber numberWithInt:WViOsApiStatus_CantConnectToDrmServer]
+                                                             forKey:WViOsApiStatusKey]
+                      afterDelay:simulator.initializeLatency];
+            return WViOsApiStatus_OK;
+        }
+        simulator.initialized = YES;
+        [simulator emitEvent:WViOsApiEvent_Initialized
+                  attributes:[NSDictionary dictionaryWithObject:@"simulator" forKey:WVVersionKey]
+                  afterDelay:simulator.initializeLatency];
+        return WViOsApiStatus_OK;
+    });
+}
+
+WViOsApiStatus WV_Terminate()
+{
+    return WVSimulatorSync(^WViOsApiStatus(WVSimulator *simulator) {
+        if (!simulator.initialized) {
+            return WViOsApiStatus_NotInitialized;
+        }
+        simulator.initialized = NO;
+        simulator.playing = NO;
+        simulator.generation++;
+        [simulator emitEvent:WViOsApiEvent_Terminated attributes:[NSDictionary dictionary] afterDelay:0];
+        return WViOsApiStatus_OK;
+    });
+}
+
+/**
+ * Returns OK if the simulator is initialized, for calls that have nothing to simulate.
+ */
+static WViOsApiStatus WVSimulatorCheckInitialized()
+{
+    return WVSimulatorSync(^WViOsApiStatus(WVSimulator *simulator) {
+        return simulator.initialized ? WViOsApiStatus_OK : WViOsApiStatus_NotInitialized;
+    });
+}
+
+WViOsApiStatus WV_SetUserData(NSString *userData)
+{
+    return WVSimulatorCheckInitialized();
+}
+
+WViOsApiStatus WV_SetCredentials(NSDictionary *settings)
+{
+    return WVSimulatorCheckInitialized();
+}
+
+WViOsApiStatus WV_RegisterAsset(NSString *asset)
+{
+    return WVSimulatorCheckInitialized();
+}
+
+WViOsApiStatus WV_UnregisterAsset(NSString *asset)
+{
+    return WVSimulatorCheckInitialized();
+}
+
+WViOsApiStatus WV_NowOnline()
+{
+    return WVSimulatorCheckInitialized();
+}
+
+WViOsApiStatus WV_QueryAssetsStatus()
+{
+    return WVSimulatorSync(^WViOsApiStatus(WVSimulator *simulator) {
+        if (!simulator.initialized) {
+            return WViOsApiStatus_NotInitialized;
+        }
+        [simulator emitEvent:WViOsApiEvent_EndOfList attributes:[NSDictionary dictionary] afterDelay:simulator.queryLatency];
+        return WViOsApiStatus_OK;
+    });
+}
+
+WViOsApiStatus WV_QueryAssetStatus(NSString *asset)
+{
+    return WVSimulatorSync(^WViOsApiStatus(WVSimulator *simulator) {
+        if (!simulator.initialized) {
+            return WViOsApiStatus_NotInitialized;
+        }
+        if (![asset length]) {
+            return WViOsApiStatus_BadUrl;
+        }
+        WViOsApiStatus assetStatus = [simulator shouldFail] ? WViOsApiStatus_CantConnectToDrmServer : WViOsApiStatus_OK;
+        NSDictionary *attributes = [NSDictionary dictionaryWithObjectsAndKeys:
+                                    asset, WVAssetPathKey,
+                                    [NSNumber numberWithInt:assetStatus], WViOsApiStatusKey,
+                                    [NSNumber numberWithBool:YES], WVIsEncryptedKey,
+                                    [NSNumber numberWithInt:WVAssetType_HTTPStream], WVAssetTypeKey,
+                                    [NSNumber numberWithLong:86400], WVEMMTimeRemainingKey, nil];
+        [simulator emitEvent:WViOsApiEvent_QueryStatus attributes:attributes afterDelay:simulator.queryLatency];
+        return WViOsApiStatus_OK;
+    });
+}
+
+WViOsApiStatus WV_Play(NSString *asset, NSMutableString *url, NSData *authentication)
+{
+    NSURL *assetURL = [asset length] ? [NSURL URLWithString:asset] : nil;
+    __block NSUInteger playGeneration = 0;
+    WViOsApiStatus status = WVSimulatorSync(^WViOsApiStatus(WVSimulator *simulator) {
+        if (!simulator.initialized) {
+            return WViOsApiStatus_NotInitialized;
+        }
+        if (simulator.playing) {
+            return WViOsApiStatus_AlreadyPlaying;
+        }
+        if (!assetURL) {
+            return WViOsApiStatus_BadUrl;
+        }
+        // Claim playback before blocking so that a concurrent call sees AlreadyPlaying.
+        simulator.playing = YES;
+        simulator.generation++;
+        playGeneration = simulator.generation;
+        return WViOsApiStatus_OK;
+    });
+    if (status != WViOsApiStatus_OK) {
+        return status;
+    }
+
+    // The library blocks until the license is acquired and the stream is ready.
+    WVSimulator *sharedSimulator = [WVSimulator sharedSimulator];
+    [NSThread sleepForTimeInterval:sharedSimulator.playLatency];
+
+    return WVSimulatorSync(^WViOsApiStatus(WVSimulator *simulator) {
+        NSDictionary *assetAttributes = [NSDictionary dictionaryWithObject:asset forKey:WVAssetPathKey];
+        if (!simulator.playing || simulator.generation != playGeneration) {
+            // Stopped or terminated while starting, and perhaps another video started since.
+            return WViOsApiStatus_NotPlaying;
+        }
+        if ([simulator shouldFail] || ![simulator startProxy]) {
+            simulator.playing = NO;
+            [simulator emitEvent:WViOsApiEvent_PlayFailed attributes:assetAttributes afterDelay:0];
+            return WViOsApiStatus_CantConnectToMediaServer;
+        }
+
+        simulator.upstreamURL = simulator.playbackURL ?: assetURL;
+        NSString *name = [[simulator.upstreamURL path] lastPathComponent];
+        [url setString:[NSString stringWithFormat:@"http://127.0.0.1:%u/%lu/%@",
+                        simulator.proxyPort, (unsigned long)simulator.generation, [name length] ? name : @"index.m3u8"]];
+
+        NSNumber *currentBitrate = [simulator.bitrates count] ? [simulator.bitrates objectAtIndex:0] : [NSNumber numberWithInt:0];
+        [simulator emitEvent:WViOsApiEvent_EMMReceived attributes:assetAttributes afterDelay:0 generation:simulator.generation];
+        [simulator emitEvent:WViOsApiEvent_Playing attributes:assetAttributes afterDelay:0 generation:simulator.generation];
+        [simulator emitEvent:WViOsApiEvent_Bitrates
+                  attributes:[NSDictionary dictionaryWithObject:simulator.bitrates forKey:WVBitratesKey]
+                  afterDelay:0
+                  generation:simulator.generation];
+        [simulator emitEvent:WViOsApiEvent_SetCurrentBitrate
+                  attributes:[NSDictionary dictionaryWithObject:currentBitrate forKey:WVCurrentBitrateKey]
+                  afterDelay:0
+                  generation:simulator.generation];
+        [simulator scheduleScript];
+        return WViOsApiStatus_OK;
+    });
+}
+
+WViOsApiStatus WV_Stop()
+{
+    return WVSimulatorSync(^WViOsApiStatus(WVSimulator *simulator) {
+        if (!simulator.playing) {
+            return WViOsApiStatus_NotPlaying;
+        }
+        simulator.playing = NO;
+        simulator.generation++;
+        simulator.upstreamURL = nil;
+        [simulator emitEvent:WViOsApiEvent_Stopped attributes:[NSDictionary dictionary] afterDelay:0];
+        return WViOsApiStatus_OK;
+    });
+}
+
+WViOsApiStatus WV_SelectBitrateTrack(int trackNumber)
+{
+    return WVSimulatorSync(^WViOsApiStatus(WVSimulator *simulator) {
+        if (!simulator.playing) {
+            return WViOsApiStatus_NotPlaying;
+        }
+        NSUInteger count = [simulator.bitrates count];
+        if (trackNumber >= (int)count || count == 0) {
+            return WViOsApiStatus_BadMedia;
+        }
+        // A negative track returns to adaptive playback, which starts from the lowest bitrate.
+        NSNumber *bitrate = [simulator.bitrates objectAtIndex:(trackNumber < 0 ? 0 : trackNumber)];
+        [simulator emitEvent:WViOsApiEvent_SetCurrentBitrate
+                  attributes:[NSDictionary dictionaryWithObject:bitrate forKey:WVCurrentBitrateKey]
+                  afterDelay:simulator.bitrateSwitchLatency
+                  generation:simulator.generation];
+        return WViOsApiStatus_OK;
+    });
+}
+
+NSString *WV_GetDeviceId()
+{
+    return @"WVSimulator";
+}
+
+NSString *NSStringFromWViOsApiEvent(WViOsApiEvent event)
+{
+    static NSString *names[] = {
+        @"WViOsApiEvent_NullEvent",
+        @"WViOsApiEvent_EMMReceived",
+        @"WViOsApiEvent_EMMFailed",
+        @"WViOsApiEvent_Playing",
+        @"WViOsApiEvent_PlayFailed",
+        @"WViOsApiEvent_Stopped",
+        @"WViOsApiEvent_QueryStatus",
+        @"WViOsApiEvent_EndOfList",
+        @"WViOsApiEvent_Initialized",
+        @"WViOsApiEvent_InitializeFailed",
+        @"WViOsApiEvent_Terminated",
+        @"WViOsApiEvent_EMMRemoved",
+        @"WViOsApiEvent_Registered",
+        @"WViOsApiEvent_Unregistered",
+        @"WViOsApiEvent_SetCurrentBitrate",
+        @"WViOsApiEvent_Bitrates",
+        @"WViOsApiEvent_ChapterTitle",
+        @"WViOsApiEvent_ChapterImage",
+        @"WViOsApiEvent_ChapterSetup",
+        @"WViOsApiEvent_StoppingOnError",
+        @"WViOsApiEvent_VideoParams",
+        @"WViOsApiEvent_AudioParams",
+    };
+    if ((unsigned)event < sizeof(names) / sizeof(names[0])) {
+        return names[event];
+    }
+    return [NSString stringWithFormat:@"WViOsApiEvent_%d", event];
+}
+
+#endif
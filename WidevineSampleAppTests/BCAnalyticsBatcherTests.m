@@ -0,0 +1,135 @@
+//
+//  BCAnalyticsBatcherTests.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+
+#import "BCAnalyticsBatcher.h"
+#import "BCStubMediaServer.h"
+
+// A ten minute session: view start events, then an engagement beacon every ten seconds.
+#define BCAnalyticsBatcherTestsSessionMinutes 10
+#define BCAnalyticsBatcherTestsEngagementInterval 10
+
+@interface BCAnalyticsBatcher (Testing)
+
++ (NSString *)batchDirectory;
+
+@end
+
+@interface BCAnalyticsBatcherTests : SenTestCase
+
+@property (nonatomic) NSUInteger finishedBeaconCount;
+
+@end
+
+@implementation BCAnalyticsBatcherTests
+
+@synthesize finishedBeaconCount;
+
+- (void)setUp
+{
+    [super setUp];
+    [[BCStubMediaServer sharedServer] start];
+    [BCStubMediaServer sharedServer].responder = ^BCStubResponse *(NSURLRequest *request, NSUInteger requestNumber) {
+        return [BCStubResponse responseWithStatusCode:204 headers:nil body:nil];
+    };
+
+    BCAnalyticsBatcher *batcher = [BCAnalyticsBatcher sharedBatcher];
+    [batcher install];
+    batcher.batchURL = [BCStubMediaServer URLWithQuery:@"command=analytics_batch"];
+
+    // Send anything left from earlier runs, then count from an empty queue.
+    [batcher flush];
+    STAssertTrue([[BCStubMediaServer sharedServer] waitUntil:^BOOL {
+        NSArray *names = [[NSFileManager defaultManager] contentsOfDirectoryAtPath:[BCAnalyticsBatcher batchDirectory] error:NULL];
+        return [names count] == 0;
+    } timeout:5], @"Earlier batches were not sent");
+    [[BCStubMediaServer sharedServer] start];
+    self.finishedBeaconCount = 0;
+}
+
+- (void)tearDown
+{
+    [BCAnalyticsBatcher sharedBatcher].batchURL = nil;
+    [[BCStubMediaServer sharedServer] stop];
+    [super tearDown];
+}
+
+/**
+ * Returns the beacon URLs a session of playback sends, in order.
+ */
+- (NSArray *)playbackSessionBeaconURLs
+{
+    NSMutableArray *urls = [NSMutableArray array];
+    NSString *base = @"http://metrics.brightcove.com/tracker?domain=videocloud&account=1&video=2264590867001";
+    for (NSString *event in [NSArray arrayWithObjects:@"player_load", @"catalog_request", @"video_impression",
+                             @"play_request", @"video_view", nil]) {
+        [urls addObject:[NSURL URLWithString:[NSString stringWithFormat:@"%@&event=%@", base, event]]];
+    }
+    NSUInteger seconds = BCAnalyticsBatcherTestsSessionMinutes * 60;
+    for (NSUInteger second = BCAnalyticsBatcherTestsEngagementInterval; second <= seconds; second += BCAnalyticsBatcherTestsEngagementInterval) {
+        [urls addObject:[NSURL URLWithString:[NSString stringWithFormat:@"%@&event=video_engagement&range=%u..%u",
+                                              base, (unsigned int)(second - BCAnalyticsBatcherTestsEngagementInterval), (unsigned int)second]]];
+    }
+    return urls;
+}
+
+- (void)testPlaybackSessionBeaconsAreBatched
+{
+    BCAnalyticsBatcher *batcher = [BCAnalyticsBatcher sharedBatcher];
+    NSUInteger beaconsBefore = batcher.beaconCount;
+    NSUInteger requestsBefore = batcher.requestCount;
+    NSArray *urls = [self playbackSessionBeaconURLs];
+
+    // Sent the way BCAnalytics sends them: one GET each, answered locally.
+    __block BCAnalyticsBatcherTests *weakself = self;
+    for (NSURL *url in urls) {
+        [NSURLConnection sendAsynchronousRequest:[NSURLRequest requestWithURL:url]
+                                           queue:[NSOperationQueue mainQueue]
+                               completionHandler:^(NSURLResponse *response, NSData *data, NSError *error) {
+                                   STAssertEquals([(NSHTTPURLResponse *)response statusCode], (NSInteger)204, @"%@", error);
+                                   weakself.finishedBeaconCount++;
+                               }];
+    }
+    STAssertTrue([[BCStubMediaServer sharedServer] waitUntil:^BOOL {
+        return weakself.finishedBeaconCount == [urls count] && batcher.beaconCount - beaconsBefore == [urls count];
+    } timeout:5], @"The beacons were not all queued");
+
+    // The session ends with the app going to the background.
+    [batcher flush];
+    NSUInteger expectedRequests = ([urls count] + batcher.maxBatchCount - 1) / batcher.maxBatchCount;
+    STAssertTrue([[BCStubMediaServer sharedServer] waitUntil:^BOOL {
+        return [BCStubMediaServer sharedServer].requestCount >= expectedRequests && batcher.requestCount - requestsBefore >= expectedRequests;
+    } timeout:5], @"The batches were not sent");
+
+    NSLog(@"%s %u-minute session: %.1f requests per minute beacon by beacon, %.1f batched",
+          __PRETTY_FUNCTION__, BCAnalyticsBatcherTestsSessionMinutes,
+          (double)[urls count] / BCAnalyticsBatcherTestsSessionMinutes,
+          (double)(batcher.requestCount - requestsBefore) / BCAnalyticsBatcherTestsSessionMinutes);
+
+    // No beacon reached the network on its own; only the batches did.
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, expectedRequests, nil);
+    STAssertEquals(batcher.requestCount - requestsBefore, expectedRequests, nil);
+    for (NSURLRequest *request in [BCStubMediaServer sharedServer].requests) {
+        STAssertEqualObjects([request HTTPMethod], @"POST", nil);
+        STAssertEqualObjects([request valueForHTTPHeaderField:@"Content-Encoding"], @"gzip", nil);
+    }
+}
+
+- (void)testBeaconsPassThroughWithoutBatchURL
+{
+    BCAnalyticsBatcher *batcher = [BCAnalyticsBatcher sharedBatcher];
+    batcher.batchURL = nil;
+    NSUInteger beaconsBefore = batcher.beaconCount;
+
+    NSURLRequest *request = [NSURLRequest requestWithURL:[[self playbackSessionBeaconURLs] objectAtIndex:0]];
+    STAssertFalse([NSClassFromString(@"BCAnalyticsBeaconProtocol") canInitWithRequest:request], nil);
+    STAssertEquals(batcher.beaconCount, beaconsBefore, nil);
+}
+
+@end
@@ -0,0 +1,165 @@
+//
+//  BCJSONReaderTests.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <malloc/malloc.h>
+#import <SenTestingKit/SenTestingKit.h>
+
+#import "BCEventEmitter.h"
+#import "BCJSONKeyCache.h"
+#import "BCJSONReader.h"
+#import "BCMediaService.h"
+#import "BCPlaylist.h"
+
+#define BCJSONReaderTestsParseCount 1000
+
+@interface BCJSONReaderTests : SenTestCase
+
+@property (nonatomic, retain) NSData *playlistData;
+
+@end
+
+@implementation BCJSONReaderTests
+
+@synthesize playlistData;
+
+- (void)setUp
+{
+    [super setUp];
+    NSString *path = [[NSBundle bundleForClass:[self class]] pathForResource:@"find_playlist_by_reference_id" ofType:@"json"];
+    self.playlistData = [NSData dataWithContentsOfFile:path];
+    STAssertNotNil(self.playlistData, @"Missing corpus response at %@", path);
+}
+
+- (void)tearDown
+{
+    self.playlistData = nil;
+    [super tearDown];
+}
+
+/**
+ * Parses the playlist response count times, each time from a new buffer as a
+ * new response would be, with a reader from readerBlock.
+ *
+ * @return the seconds taken.
+ */
+- (NSTimeInterval)parseResponses:(NSUInteger)count withReader:(BCJSONReader *(^)(void))readerBlock
+{
+    NSDate *start = [NSDate date];
+    for (NSUInteger i = 0; i < count; i++) {
+        NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+        NSData *response = [NSData dataWithBytes:[self.playlistData bytes] length:[self.playlistData length]];
+        NSError *error = nil;
+        id playlist = [readerBlock() objectWithData:response error:&error];
+        STAssertNotNil(playlist, @"%@", error);
+        [pool drain];
+    }
+    return -[start timeIntervalSinceNow];
+}
+
+/**
+ * Returns the number of heap blocks allocated and not yet freed, in all zones.
+ */
+static size_t BCJSONReaderTestsBlocksInUse(void)
+{
+    malloc_statistics_t statistics;
+    malloc_zone_statistics(NULL, &statistics);
+    return statistics.blocks_in_use;
+}
+
+/**
+ * Parses the playlist response with parseBlock and maps it with
+ * makePlaylistWithJSON:, as BCMediaService (Widevine) does.
+ *
+ * @return the number of blocks allocated at the peak, when the parsed response
+ * and the playlist made from it are both still alive.
+ */
+- (size_t)peakBlocksParsingPlaylistWith:(id (^)(NSData *data))parseBlock
+{
+    BCMediaService *service = [[[BCMediaService alloc] initWithEventEmitter:[[[BCEventEmitter alloc] init] autorelease]
+                                                                      token:@"token"
+                                                                    baseURL:nil] autorelease];
+    NSData *response = [NSData dataWithBytes:[self.playlistData bytes] length:[self.playlistData length]];
+
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    size_t before = BCJSONReaderTestsBlocksInUse();
+    id json = parseBlock(response);
+    BCPlaylist *playlist = [service makePlaylistWithJSON:json];
+    size_t peak = BCJSONReaderTestsBlocksInUse() - before;
+    STAssertEquals([playlist.videos count], (NSUInteger)24, nil);
+    [pool drain];
+    return peak;
+}
+
+- (void)testThreadReaderIsReused
+{
+    STAssertEquals([BCJSONReader readerForCurrentThread], [BCJSONReader readerForCurrentThread], nil);
+    STAssertFalse([BCJSONReader reader] == [BCJSONReader readerForCurrentThread], nil);
+}
+
+- (void)testPooledAndFreshReadersAgree
+{
+    NSError *error = nil;
+    id pooled = [[BCJSONReader readerForCurrentThread] objectWithData:self.playlistData error:&error];
+    id fresh = [[BCJSONReader reader] objectWithData:self.playlistData error:&error];
+
+    STAssertNotNil(pooled, @"%@", error);
+    STAssertEqualObjects(pooled, fresh, nil);
+    STAssertEquals([[pooled objectForKey:@"videos"] count], (NSUInteger)24, nil);
+}
+
+/**
+ * Reports the allocations a playlist parse peaks at with plain objects, as
+ * before views, and with views. The key cache is warmed first, as it is after
+ * the first response.
+ */
+- (void)testViewsAllocateLessForPlaylistParse
+{
+    BCJSONReader *reader = [BCJSONReader readerForCurrentThread];
+    [reader objectWithData:self.playlistData error:NULL];
+
+    size_t objectBlocks = [self peakBlocksParsingPlaylistWith:^id(NSData *data) {
+        return [reader objectWithData:data error:NULL];
+    }];
+    size_t viewBlocks = [self peakBlocksParsingPlaylistWith:^id(NSData *data) {
+        return [reader viewWithData:data error:NULL];
+    }];
+
+    NSLog(@"%s playlist parse of %u bytes peaks at %lu allocations with objects, %lu with views",
+          __PRETTY_FUNCTION__, (unsigned int)[self.playlistData length], (unsigned long)objectBlocks, (unsigned long)viewBlocks);
+    STAssertTrue(viewBlocks * 2 < objectBlocks, @"%lu allocations with views, %lu with objects",
+                 (unsigned long)viewBlocks, (unsigned long)objectBlocks);
+}
+
+/**
+ * The benchmark: 1,000 successive playlist responses, each parsed by a new
+ * reader as before pooling and by the thread's reader. The times are logged;
+ * the key cache must stay warm across the responses.
+ */
+- (void)testSuccessivePlaylistParses
+{
+    NSTimeInterval freshTime = [self parseResponses:BCJSONReaderTestsParseCount withReader:^BCJSONReader *{
+        return [BCJSONReader reader];
+    }];
+
+    BCJSONReader *threadReader = [BCJSONReader readerForCurrentThread];
+    [threadReader.keyCache removeAllStrings];
+    NSTimeInterval pooledTime = [self parseResponses:BCJSONReaderTestsParseCount withReader:^BCJSONReader *{
+        return [BCJSONReader readerForCurrentThread];
+    }];
+
+    BCJSONKeyCache *keyCache = threadReader.keyCache;
+    NSLog(@"%s %u playlist responses of %u bytes: %.3fs with a new reader each, %.3fs pooled; key cache hit rate %.4f (%u misses)",
+          __PRETTY_FUNCTION__, BCJSONReaderTestsParseCount, (unsigned int)[self.playlistData length],
+          freshTime, pooledTime, keyCache.hitRate, (unsigned int)keyCache.misses);
+
+    // Only the first response should miss, once per distinct key.
+    STAssertTrue(keyCache.hitRate > 0.99, @"hit rate %g", keyCache.hitRate);
+    STAssertTrue(keyCache.misses < 100, @"%u misses", (unsigned int)keyCache.misses);
+}
+
+@end
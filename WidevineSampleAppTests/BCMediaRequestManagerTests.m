@@ -0,0 +1,159 @@
+//
+//  BCMediaRequestManagerTests.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+
+#import "BCMediaRequestManager.h"
+#import "BCMediaResponseCache.h"
+#import "BCStubMediaServer.h"
+
+@interface BCMediaRequestManagerTests : SenTestCase
+
+@property (nonatomic, retain) BCMediaRequestManager *manager;
+@property (nonatomic, retain) NSMutableArray *entries;
+@property (nonatomic) NSUInteger failureCount;
+
+@end
+
+@implementation BCMediaRequestManagerTests
+
+@synthesize manager;
+@synthesize entries;
+@synthesize failureCount;
+
+- (void)setUp
+{
+    [super setUp];
+    [[BCMediaResponseCache sharedCache] removeAllEntries];
+    [[BCStubMediaServer sharedServer] start];
+    self.manager = [[[BCMediaRequestManager alloc] init] autorelease];
+    self.manager.hedgingEnabled = NO;
+    self.entries = [NSMutableArray array];
+    self.failureCount = 0;
+
+    // Each request is answered with its own query, after a while, so overlapping calls overlap.
+    [BCStubMediaServer sharedServer].responder = ^BCStubResponse *(NSURLRequest *request, NSUInteger requestNumber) {
+        BCStubResponse *response = [BCStubResponse responseWithStatusCode:200 headers:nil body:[[request URL] query]];
+        response.delay = 0.2;
+        return response;
+    };
+}
+
+- (void)tearDown
+{
+    self.manager = nil;
+    self.entries = nil;
+    [[BCStubMediaServer sharedServer] stop];
+    [[BCMediaResponseCache sharedCache] removeAllEntries];
+    [super tearDown];
+}
+
+/**
+ * Sends a request for query; its entry is added to entries when it finishes.
+ */
+- (void)sendQuery:(NSString *)query
+{
+    __block BCMediaRequestManagerTests *weakself = self;
+    [self.manager sendRequest:[NSURLRequest requestWithURL:[BCStubMediaServer URLWithQuery:query]]
+              completionBlock:^(NSError *error, BCMediaResponseCacheEntry *entry) {
+                  if (entry) {
+                      [weakself.entries addObject:entry];
+                  } else {
+                      weakself.failureCount++;
+                  }
+              }];
+}
+
+- (BOOL)waitForResponses:(NSUInteger)count
+{
+    __block BCMediaRequestManagerTests *weakself = self;
+    return [[BCStubMediaServer sharedServer] waitUntil:^BOOL {
+        return [weakself.entries count] + weakself.failureCount >= count;
+    } timeout:5];
+}
+
+- (void)testIdenticalQueriesShareOneRequest
+{
+    // A pull to refresh during the initial load, with a new token and parameters in another order.
+    [self sendQuery:@"command=find_playlist_by_reference_id&reference_id=a&token=first"];
+    [self sendQuery:@"command=find_playlist_by_reference_id&reference_id=a&token=first"];
+    [self sendQuery:@"token=second&reference_id=a&command=find_playlist_by_reference_id"];
+
+    STAssertTrue([self waitForResponses:3], nil);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)1, nil);
+    STAssertEquals(self.manager.coalescedRequestCount, (NSUInteger)2, nil);
+    STAssertEquals(self.failureCount, (NSUInteger)0, nil);
+
+    // Every caller gets the same entry, so the response is parsed once.
+    STAssertEquals([self.entries objectAtIndex:1], [self.entries objectAtIndex:0], nil);
+    STAssertEquals([self.entries objectAtIndex:2], [self.entries objectAtIndex:0], nil);
+}
+
+- (void)testDifferentQueriesAreSentSeparately
+{
+    [self sendQuery:@"command=find_video_by_id&video_id=1"];
+    [self sendQuery:@"command=find_video_by_id&video_id=2"];
+
+    STAssertTrue([self waitForResponses:2], nil);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)2, nil);
+    STAssertEquals(self.manager.coalescedRequestCount, (NSUInteger)0, nil);
+    STAssertFalse([[[self.entries objectAtIndex:0] data] isEqualToData:[[self.entries objectAtIndex:1] data]], nil);
+}
+
+- (void)testFinishedRequestIsNotJoined
+{
+    [self sendQuery:@"command=find_video_by_id&video_id=1"];
+    STAssertTrue([self waitForResponses:1], nil);
+
+    // Without freshness information the next call goes back to the server.
+    [self sendQuery:@"command=find_video_by_id&video_id=1"];
+    STAssertTrue([self waitForResponses:2], nil);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)2, nil);
+    STAssertEquals(self.manager.coalescedRequestCount, (NSUInteger)0, nil);
+}
+
+- (void)testConcurrencyIsBounded
+{
+    self.manager.maxConcurrentRequests = 2;
+    for (NSUInteger i = 0; i < 6; i++) {
+        [self sendQuery:[NSString stringWithFormat:@"command=find_video_by_id&video_id=%u", (unsigned int)i]];
+    }
+
+    STAssertTrue([self waitForResponses:6], nil);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)6, nil);
+    STAssertEquals([BCStubMediaServer sharedServer].maxConcurrentRequests, (NSUInteger)2, nil);
+    STAssertEquals(self.failureCount, (NSUInteger)0, nil);
+}
+
+- (void)testWaitingRequestsAreCoalescedToo
+{
+    self.manager.maxConcurrentRequests = 1;
+    [self sendQuery:@"command=find_video_by_id&video_id=1"];
+    [self sendQuery:@"command=find_video_by_id&video_id=2"];
+    [self sendQuery:@"command=find_video_by_id&video_id=2"];
+
+    STAssertTrue([self waitForResponses:3], nil);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)2, nil);
+    STAssertEquals(self.manager.coalescedRequestCount, (NSUInteger)1, nil);
+}
+
+- (void)testFailureReachesEveryCaller
+{
+    [BCStubMediaServer sharedServer].responder = ^BCStubResponse *(NSURLRequest *request, NSUInteger requestNumber) {
+        return [BCStubResponse responseWithStatusCode:404 headers:nil body:nil];
+    };
+
+    [self sendQuery:@"command=find_video_by_id&video_id=1"];
+    [self sendQuery:@"command=find_video_by_id&video_id=1"];
+
+    STAssertTrue([self waitForResponses:2], nil);
+    STAssertEquals(self.failureCount, (NSUInteger)2, nil);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)1, nil);
+}
+
+@end
@@ -0,0 +1,250 @@
+//
+//  BCMediaRequestRetryTests.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+
+#import "BCMediaRequestManager.h"
+#import "BCMediaResponseCache.h"
+#import "BCStubMediaServer.h"
+
+#define BCMediaRequestRetryTestsQuery @"command=find_playlist_by_reference_id&reference_id=widevine_sample"
+
+@interface BCMediaRequestRetryTests : SenTestCase
+
+@property (nonatomic, retain) BCMediaRequestManager *manager;
+@property (nonatomic, retain) NSError *error;
+@property (nonatomic, retain) BCMediaResponseCacheEntry *entry;
+@property (nonatomic) BOOL finished;
+
+@end
+
+@implementation BCMediaRequestRetryTests
+
+@synthesize manager;
+@synthesize error;
+@synthesize entry;
+@synthesize finished;
+
+- (void)setUp
+{
+    [super setUp];
+    [[BCMediaResponseCache sharedCache] removeAllEntries];
+    [[BCStubMediaServer sharedServer] start];
+    self.manager = [[[BCMediaRequestManager alloc] init] autorelease];
+    self.manager.hedgingEnabled = NO;
+    self.manager.baseRetryDelay = 0.05;
+    self.finished = NO;
+}
+
+- (void)tearDown
+{
+    self.manager = nil;
+    self.error = nil;
+    self.entry = nil;
+    [[BCStubMediaServer sharedServer] stop];
+    [[BCMediaResponseCache sharedCache] removeAllEntries];
+    [super tearDown];
+}
+
+/**
+ * Answers the requests numbered in failures with statusCode, and the rest with 200.
+ */
+- (void)respondWithStatusCode:(NSInteger)statusCode toRequests:(NSIndexSet *)failures
+{
+    [BCStubMediaServer sharedServer].responder = ^BCStubResponse *(NSURLRequest *request, NSUInteger requestNumber) {
+        if ([failures containsIndex:requestNumber]) {
+            return [BCStubResponse responseWithStatusCode:statusCode headers:nil body:@"{\"error\":\"unavailable\"}"];
+        }
+        return [BCStubResponse responseWithStatusCode:200 headers:nil body:@"{\"id\":2264590867001}"];
+    };
+}
+
+/**
+ * Sends the test request and waits up to timeout for it to finish.
+ *
+ * @return the seconds it took.
+ */
+- (NSTimeInterval)sendRequestWithTimeout:(NSTimeInterval)timeout
+{
+    __block BCMediaRequestRetryTests *weakself = self;
+    NSDate *start = [NSDate date];
+    [self.manager sendRequest:[NSURLRequest requestWithURL:[BCStubMediaServer URLWithQuery:BCMediaRequestRetryTestsQuery]]
+              completionBlock:^(NSError *requestError, BCMediaResponseCacheEntry *requestEntry) {
+                  weakself.error = requestError;
+                  weakself.entry = requestEntry;
+                  weakself.finished = YES;
+              }];
+
+    STAssertTrue([[BCStubMediaServer sharedServer] waitUntil:^BOOL { return weakself.finished; } timeout:timeout],
+                 @"The request did not finish");
+    return -[start timeIntervalSinceNow];
+}
+
+- (void)testServerErrorIsRetried
+{
+    [self respondWithStatusCode:503 toRequests:[NSIndexSet indexSetWithIndex:0]];
+
+    [self sendRequestWithTimeout:5];
+
+    STAssertNil(self.error, @"%@", self.error);
+    STAssertNotNil(self.entry, nil);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)2, nil);
+    STAssertEquals(self.manager.retryCount, (NSUInteger)1, nil);
+}
+
+- (void)testTooManyRequestsIsRetried
+{
+    [self respondWithStatusCode:429 toRequests:[NSIndexSet indexSetWithIndex:0]];
+
+    [self sendRequestWithTimeout:5];
+
+    STAssertNil(self.error, @"%@", self.error);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)2, nil);
+}
+
+- (void)testPersistentServerErrorStopsAtMaxAttempts
+{
+    [self respondWithStatusCode:500 toRequests:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 100)]];
+
+    [self sendRequestWithTimeout:5];
+
+    STAssertEquals([self.error code], (NSInteger)NSURLErrorBadServerResponse, @"%@", self.error);
+    STAssertNil(self.entry, nil);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, self.manager.maxAttempts, nil);
+}
+
+- (void)testClientErrorIsNotRetried
+{
+    [self respondWithStatusCode:404 toRequests:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 100)]];
+
+    [self sendRequestWithTimeout:5];
+
+    STAssertNotNil(self.error, nil);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)1, nil);
+    STAssertEquals(self.manager.retryCount, (NSUInteger)0, nil);
+}
+
+- (void)testSpentRetryBudgetStopsRetries
+{
+    self.manager.maxAttempts = 10;
+    while ([self.manager requestRetryToken]) {
+    }
+    [self respondWithStatusCode:500 toRequests:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 100)]];
+
+    [self sendRequestWithTimeout:5];
+
+    STAssertNotNil(self.error, nil);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)1, nil);
+}
+
+- (void)testZeroRetryBudgetTurnsRetriesOff
+{
+    self.manager.retryBudget = 0;
+    [self respondWithStatusCode:503 toRequests:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 100)]];
+
+    [self sendRequestWithTimeout:5];
+
+    STAssertNotNil(self.error, nil);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)1, nil);
+    STAssertEquals(self.manager.retryCount, (NSUInteger)0, nil);
+}
+
+- (void)testSuccessesRefillRetryBudget
+{
+    self.manager.maxAttempts = 10;
+    while ([self.manager requestRetryToken]) {
+    }
+
+    // Six successes at the default refill of 0.2 earn back one retry, with a fifth to spare.
+    for (NSUInteger i = 0; i < 6; i++) {
+        [self.manager recordLatency:0.1];
+    }
+    [self respondWithStatusCode:500 toRequests:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, 100)]];
+
+    [self sendRequestWithTimeout:5];
+
+    STAssertNotNil(self.error, nil);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)2, nil);
+}
+
+- (void)testSlowAttemptTimesOutAndIsRetried
+{
+    self.manager.attemptTimeout = 0.3;
+    [BCStubMediaServer sharedServer].responder = ^BCStubResponse *(NSURLRequest *request, NSUInteger requestNumber) {
+        BCStubResponse *response = [BCStubResponse responseWithStatusCode:200 headers:nil body:@"{\"id\":2264590867001}"];
+        response.delay = requestNumber == 0 ? 5 : 0;
+        return response;
+    };
+
+    NSTimeInterval duration = [self sendRequestWithTimeout:3];
+
+    STAssertNil(self.error, @"%@", self.error);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)2, nil);
+    STAssertTrue(duration < 2, @"took %g seconds", duration);
+}
+
+- (void)testSlowAttemptIsHedged
+{
+    self.manager.hedgingEnabled = YES;
+    for (NSUInteger i = 0; i < 20; i++) {
+        [self.manager recordLatency:0.1];
+    }
+    STAssertEqualsWithAccuracy([self.manager hedgeDelay], 0.1, 0.001, nil);
+
+    // The first copy is stuck; the hedged copy answers straight away.
+    [BCStubMediaServer sharedServer].responder = ^BCStubResponse *(NSURLRequest *request, NSUInteger requestNumber) {
+        BCStubResponse *response = [BCStubResponse responseWithStatusCode:200 headers:nil body:@"{\"id\":2264590867001}"];
+        response.delay = requestNumber == 0 ? 5 : 0;
+        return response;
+    };
+
+    NSTimeInterval duration = [self sendRequestWithTimeout:3];
+
+    STAssertNil(self.error, @"%@", self.error);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)2, nil);
+    STAssertEquals(self.manager.retryCount, (NSUInteger)1, nil);
+    STAssertTrue(duration < 2, @"took %g seconds", duration);
+}
+
+- (void)testFastAttemptIsNotHedged
+{
+    self.manager.hedgingEnabled = YES;
+    for (NSUInteger i = 0; i < 20; i++) {
+        [self.manager recordLatency:1];
+    }
+    [self respondWithStatusCode:500 toRequests:[NSIndexSet indexSet]];
+
+    [self sendRequestWithTimeout:3];
+
+    STAssertNil(self.error, @"%@", self.error);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)1, nil);
+}
+
+- (void)testRetryDelayGrowsWithJitterUpToMax
+{
+    self.manager.baseRetryDelay = 0.5;
+    self.manager.maxRetryDelay = 4;
+
+    for (NSUInteger i = 0; i < 100; i++) {
+        STAssertTrue([self.manager retryDelayForAttempt:1] <= 0.5, nil);
+        STAssertTrue([self.manager retryDelayForAttempt:2] <= 1, nil);
+        STAssertTrue([self.manager retryDelayForAttempt:10] <= 4, nil);
+    }
+
+    // Full jitter spreads the delays across the whole range.
+    NSTimeInterval shortest = 4;
+    NSTimeInterval longest = 0;
+    for (NSUInteger i = 0; i < 100; i++) {
+        NSTimeInterval delay = [self.manager retryDelayForAttempt:10];
+        shortest = MIN(shortest, delay);
+        longest = MAX(longest, delay);
+    }
+    STAssertTrue(shortest < 1 && longest > 3, @"delays from %g to %g", shortest, longest);
+}
+
+@end
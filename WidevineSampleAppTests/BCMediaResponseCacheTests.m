@@ -0,0 +1,190 @@
+//
+//  BCMediaResponseCacheTests.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+
+#import "BCMediaRequestManager.h"
+#import "BCMediaResponseCache.h"
+#import "BCStubMediaServer.h"
+
+#define BCMediaResponseCacheTestsQuery @"command=find_playlist_by_reference_id&reference_id=widevine_sample&token=first"
+#define BCMediaResponseCacheTestsBody @"{\"id\":2264590867001,\"referenceId\":\"widevine_sample\",\"videos\":[]}"
+
+@interface BCMediaResponseCacheTests : SenTestCase
+
+@property (nonatomic, retain) BCMediaRequestManager *manager;
+
+@end
+
+@implementation BCMediaResponseCacheTests
+
+@synthesize manager;
+
+- (void)setUp
+{
+    [super setUp];
+    [[BCMediaResponseCache sharedCache] removeAllEntries];
+    [[BCStubMediaServer sharedServer] start];
+    self.manager = [[[BCMediaRequestManager alloc] init] autorelease];
+    self.manager.hedgingEnabled = NO;
+}
+
+- (void)tearDown
+{
+    self.manager = nil;
+    [[BCStubMediaServer sharedServer] stop];
+    [[BCMediaResponseCache sharedCache] removeAllEntries];
+    [super tearDown];
+}
+
+/**
+ * Sends a request for query through the manager and waits for its entry.
+ */
+- (BCMediaResponseCacheEntry *)fetchQuery:(NSString *)query
+{
+    __block BOOL finished = NO;
+    __block BCMediaResponseCacheEntry *result = nil;
+    NSURLRequest *request = [NSURLRequest requestWithURL:[BCStubMediaServer URLWithQuery:query]];
+    [self.manager sendRequest:request completionBlock:^(NSError *error, BCMediaResponseCacheEntry *entry) {
+        STAssertNil(error, @"%@", error);
+        result = [entry retain];
+        finished = YES;
+    }];
+
+    STAssertTrue([[BCStubMediaServer sharedServer] waitUntil:^BOOL { return finished; } timeout:5], @"No response for %@", query);
+    return [result autorelease];
+}
+
+/**
+ * Answers with body and an ETag, or with 304 when the request sends the ETag back.
+ */
+- (void)respondWithETag:(NSString *)etag body:(NSString *)body
+{
+    [BCStubMediaServer sharedServer].responder = ^BCStubResponse *(NSURLRequest *request, NSUInteger requestNumber) {
+        NSDictionary *headers = [NSDictionary dictionaryWithObject:etag forKey:@"ETag"];
+        if ([[request valueForHTTPHeaderField:@"If-None-Match"] isEqualToString:etag]) {
+            return [BCStubResponse responseWithStatusCode:304 headers:headers body:nil];
+        }
+        return [BCStubResponse responseWithStatusCode:200 headers:headers body:body];
+    };
+}
+
+- (void)testCacheKeyRedactsTokenAndSortsParameters
+{
+    NSURL *url = [BCStubMediaServer URLWithQuery:@"token=secret&reference_id=a&command=find_playlist_by_reference_id"];
+    NSString *key = [BCMediaResponseCache cacheKeyForURL:url];
+
+    STAssertTrue([key rangeOfString:@"secret"].location == NSNotFound, @"%@", key);
+    STAssertTrue([key hasSuffix:@"?command=find_playlist_by_reference_id&reference_id=a&token=REDACTED"], @"%@", key);
+    STAssertEqualObjects(key, [BCMediaResponseCache cacheKeyForURL:[BCStubMediaServer URLWithQuery:
+                                                                    @"command=find_playlist_by_reference_id&token=other&reference_id=a"]], nil);
+}
+
+- (void)testNotModifiedReturnsCachedEntryWithoutBody
+{
+    [self respondWithETag:@"\"v1\"" body:BCMediaResponseCacheTestsBody];
+
+    BCMediaResponseCacheEntry *first = [self fetchQuery:BCMediaResponseCacheTestsQuery];
+    unsigned long long bodyLength = [[BCMediaResponseCacheTestsBody dataUsingEncoding:NSUTF8StringEncoding] length];
+    STAssertEquals([BCStubMediaServer sharedServer].bytesServed, bodyLength, nil);
+
+    // The media service keeps the objects it built on the entry.
+    id playlist = [[[NSObject alloc] init] autorelease];
+    first.object = playlist;
+
+    BCMediaResponseCacheEntry *second = [self fetchQuery:BCMediaResponseCacheTestsQuery];
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)2, nil);
+    STAssertEqualObjects([[[BCStubMediaServer sharedServer].requests objectAtIndex:1] valueForHTTPHeaderField:@"If-None-Match"],
+                         @"\"v1\"", nil);
+    STAssertEquals([BCStubMediaServer sharedServer].bytesServed, bodyLength, @"The 304 sent a body");
+    STAssertEquals(second, first, nil);
+    STAssertEquals(second.object, playlist, nil);
+}
+
+- (void)testRevalidationIgnoresToken
+{
+    [self respondWithETag:@"\"v1\"" body:BCMediaResponseCacheTestsBody];
+
+    [self fetchQuery:BCMediaResponseCacheTestsQuery];
+    [self fetchQuery:[BCMediaResponseCacheTestsQuery stringByReplacingOccurrencesOfString:@"token=first" withString:@"token=second"]];
+
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)2, nil);
+    STAssertNotNil([[[BCStubMediaServer sharedServer].requests objectAtIndex:1] valueForHTTPHeaderField:@"If-None-Match"], nil);
+}
+
+- (void)testFreshEntryIsServedWithoutRequest
+{
+    [BCStubMediaServer sharedServer].responder = ^BCStubResponse *(NSURLRequest *request, NSUInteger requestNumber) {
+        return [BCStubResponse responseWithStatusCode:200
+                                              headers:[NSDictionary dictionaryWithObject:@"max-age=60" forKey:@"Cache-Control"]
+                                                 body:BCMediaResponseCacheTestsBody];
+    };
+
+    BCMediaResponseCacheEntry *first = [self fetchQuery:BCMediaResponseCacheTestsQuery];
+    BCMediaResponseCacheEntry *second = [self fetchQuery:BCMediaResponseCacheTestsQuery];
+
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)1, nil);
+    STAssertEquals(second, first, nil);
+}
+
+- (void)testIdenticalBodyKeepsEntry
+{
+    // Without validators every request is a full one, but an unchanged body needn't be parsed again.
+    [BCStubMediaServer sharedServer].responder = ^BCStubResponse *(NSURLRequest *request, NSUInteger requestNumber) {
+        return [BCStubResponse responseWithStatusCode:200 headers:nil body:BCMediaResponseCacheTestsBody];
+    };
+
+    BCMediaResponseCacheEntry *first = [self fetchQuery:BCMediaResponseCacheTestsQuery];
+    first.object = [[[NSObject alloc] init] autorelease];
+    BCMediaResponseCacheEntry *second = [self fetchQuery:BCMediaResponseCacheTestsQuery];
+
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)2, nil);
+    STAssertEquals(second, first, nil);
+    STAssertNotNil(second.object, nil);
+}
+
+- (void)testChangedBodyReplacesEntry
+{
+    [BCStubMediaServer sharedServer].responder = ^BCStubResponse *(NSURLRequest *request, NSUInteger requestNumber) {
+        NSString *body = [NSString stringWithFormat:@"{\"id\":%u}", (unsigned int)requestNumber];
+        return [BCStubResponse responseWithStatusCode:200
+                                              headers:[NSDictionary dictionaryWithObject:[NSString stringWithFormat:@"\"v%u\"", (unsigned int)requestNumber]
+                                                                                  forKey:@"ETag"]
+                                                 body:body];
+    };
+
+    BCMediaResponseCacheEntry *first = [self fetchQuery:BCMediaResponseCacheTestsQuery];
+    first.object = [[[NSObject alloc] init] autorelease];
+    BCMediaResponseCacheEntry *second = [self fetchQuery:BCMediaResponseCacheTestsQuery];
+
+    STAssertFalse(second == first, nil);
+    STAssertNil(second.object, nil);
+    STAssertEqualObjects(second.data, [@"{\"id\":1}" dataUsingEncoding:NSUTF8StringEncoding], nil);
+    STAssertEqualObjects(second.etag, @"\"v1\"", nil);
+    STAssertEquals([BCStubMediaServer sharedServer].bytesServed, (unsigned long long)16, nil);
+}
+
+- (void)testNoStoreResponseIsNotCached
+{
+    [BCStubMediaServer sharedServer].responder = ^BCStubResponse *(NSURLRequest *request, NSUInteger requestNumber) {
+        NSDictionary *headers = [NSDictionary dictionaryWithObjectsAndKeys:
+                                 @"no-store", @"Cache-Control",
+                                 @"\"v1\"", @"ETag",
+                                 nil];
+        return [BCStubResponse responseWithStatusCode:200 headers:headers body:BCMediaResponseCacheTestsBody];
+    };
+
+    BCMediaResponseCacheEntry *entry = [self fetchQuery:BCMediaResponseCacheTestsQuery];
+    STAssertNotNil(entry.data, nil);
+    STAssertNil([[BCMediaResponseCache sharedCache] entryForURL:[BCStubMediaServer URLWithQuery:BCMediaResponseCacheTestsQuery]], nil);
+
+    [self fetchQuery:BCMediaResponseCacheTestsQuery];
+    STAssertNil([[[BCStubMediaServer sharedServer].requests objectAtIndex:1] valueForHTTPHeaderField:@"If-None-Match"], nil);
+}
+
+@end
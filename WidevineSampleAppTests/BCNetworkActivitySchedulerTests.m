@@ -0,0 +1,118 @@
+//
+//  BCNetworkActivitySchedulerTests.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+
+#import "BCNetworkActivityScheduler.h"
+
+// An hour of playback.
+#define BCNetworkActivitySchedulerTestsDuration 3600
+
+// Windows of the work done during playback, in seconds. libWViPhoneAPI sends the
+// heartbeat on its own timer, so it runs at its deadline and never shares a wake-up.
+#define BCNetworkActivitySchedulerTestsEMMPeriod 600
+#define BCNetworkActivitySchedulerTestsEMMTolerance 300
+#define BCNetworkActivitySchedulerTestsFlushPeriod 60
+#define BCNetworkActivitySchedulerTestsFlushTolerance 30
+#define BCNetworkActivitySchedulerTestsPrefetchPeriod 45
+#define BCNetworkActivitySchedulerTestsPrefetchTolerance 45
+
+@interface BCNetworkActivitySchedulerTests : SenTestCase
+
+@end
+
+@implementation BCNetworkActivitySchedulerTests
+
+/**
+ * Returns a simulated scheduler that has run duration seconds of playback with
+ * the Widevine heartbeat every heartbeatPeriod seconds.
+ */
+- (BCNetworkActivityScheduler *)schedulerAfterPlaybackWithDuration:(NSTimeInterval)duration heartbeatPeriod:(NSTimeInterval)heartbeatPeriod
+{
+    BCNetworkActivityScheduler *scheduler = [[[BCNetworkActivityScheduler alloc] initWithSimulatedClock] autorelease];
+
+    [scheduler schedulePeriodicTaskNamed:@"widevineHeartbeat" period:heartbeatPeriod tolerance:0 block:nil];
+    [scheduler schedulePeriodicTaskNamed:@"emmRenewal"
+                                  period:BCNetworkActivitySchedulerTestsEMMPeriod
+                               tolerance:BCNetworkActivitySchedulerTestsEMMTolerance
+                                   block:nil];
+    [scheduler schedulePeriodicTaskNamed:@"analyticsFlush"
+                                  period:BCNetworkActivitySchedulerTestsFlushPeriod
+                               tolerance:BCNetworkActivitySchedulerTestsFlushTolerance
+                                   block:nil];
+    [scheduler schedulePeriodicTaskNamed:@"stillPrefetch"
+                                  period:BCNetworkActivitySchedulerTestsPrefetchPeriod
+                               tolerance:BCNetworkActivitySchedulerTestsPrefetchTolerance
+                                   block:nil];
+    [scheduler advanceSimulatedClockBy:duration];
+    return scheduler;
+}
+
+- (void)testPlaybackWorkSharesHeartbeatWakeUps
+{
+    NSTimeInterval heartbeatPeriods[] = { 30, 60, 120 };
+    for (NSUInteger i = 0; i < sizeof(heartbeatPeriods) / sizeof(heartbeatPeriods[0]); i++) {
+        BCNetworkActivityScheduler *scheduler = [self schedulerAfterPlaybackWithDuration:BCNetworkActivitySchedulerTestsDuration
+                                                                         heartbeatPeriod:heartbeatPeriods[i]];
+        NSUInteger heartbeats = BCNetworkActivitySchedulerTestsDuration / heartbeatPeriods[i];
+
+        NSLog(@"%s heartbeat every %.0fs: %lu wake-ups for %lu task runs, %.1f saved per hour",
+              __PRETTY_FUNCTION__, heartbeatPeriods[i], (unsigned long)scheduler.wakeUpCount,
+              (unsigned long)scheduler.taskRunCount, [scheduler wakeUpsSavedPerHour]);
+
+        STAssertEquals(scheduler.lateRunCount, (NSUInteger)0, nil);
+        STAssertTrue(scheduler.wakeUpCount >= heartbeats, @"%lu", (unsigned long)scheduler.wakeUpCount);
+        STAssertTrue(scheduler.taskRunCount > scheduler.wakeUpCount, @"No task shared a wake-up");
+        STAssertTrue([scheduler wakeUpsSavedPerHour] > 0, nil);
+    }
+}
+
+- (void)testTaskRunsWithinItsWindow
+{
+    BCNetworkActivityScheduler *scheduler = [[[BCNetworkActivityScheduler alloc] initWithSimulatedClock] autorelease];
+    __block NSUInteger runs = 0;
+    [scheduler scheduleTaskNamed:@"task" afterDelay:10 deadline:20 block:^{
+        runs++;
+    }];
+
+    // Other traffic before the window opens doesn't run it.
+    [scheduler advanceSimulatedClockBy:5];
+    [scheduler networkWasUsed];
+    STAssertEquals(runs, (NSUInteger)0, nil);
+
+    // Other traffic inside the window does, without a wake-up of its own.
+    [scheduler advanceSimulatedClockBy:10];
+    [scheduler networkWasUsed];
+    STAssertEquals(runs, (NSUInteger)1, nil);
+    STAssertEquals(scheduler.wakeUpCount, (NSUInteger)0, nil);
+
+    [scheduler advanceSimulatedClockBy:30];
+    STAssertEquals(runs, (NSUInteger)1, nil);
+}
+
+- (void)testTaskRunsAtDeadline
+{
+    BCNetworkActivityScheduler *scheduler = [[[BCNetworkActivityScheduler alloc] initWithSimulatedClock] autorelease];
+    __block NSUInteger runs = 0;
+    [scheduler scheduleTaskNamed:@"task" afterDelay:10 deadline:20 block:^{
+        runs++;
+    }];
+    id cancelled = [scheduler scheduleTaskNamed:@"cancelled" afterDelay:0 deadline:5 block:^{
+        runs += 100;
+    }];
+    [scheduler cancelTask:cancelled];
+
+    [scheduler advanceSimulatedClockBy:19];
+    STAssertEquals(runs, (NSUInteger)0, nil);
+    [scheduler advanceSimulatedClockBy:1];
+    STAssertEquals(runs, (NSUInteger)1, nil);
+    STAssertEquals(scheduler.wakeUpCount, (NSUInteger)1, nil);
+    STAssertEquals(scheduler.lateRunCount, (NSUInteger)0, nil);
+}
+
+@end
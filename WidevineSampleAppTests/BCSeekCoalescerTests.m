@@ -0,0 +1,147 @@
+//
+//  BCSeekCoalescerTests.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+
+#import "BCSeekCoalescer.h"
+
+// Length of video, in seconds, that a scrub drags across.
+#define BCSeekCoalescerTestsVideoDuration 600
+
+/**
+ * A coalescer whose clock only moves when the test sets it.
+ */
+@interface BCSimulatedSeekCoalescer : BCSeekCoalescer
+
+@property (nonatomic) NSTimeInterval simulatedTime;
+
+@end
+
+@implementation BCSimulatedSeekCoalescer
+
+@synthesize simulatedTime;
+
+- (NSTimeInterval)now
+{
+    return self.simulatedTime;
+}
+
+@end
+
+@interface BCSeekCoalescerTests : SenTestCase
+
+@property (nonatomic, retain) BCSimulatedSeekCoalescer *coalescer;
+@property (nonatomic, retain) NSMutableArray *seekTargets;
+@property (nonatomic) NSTimeInterval seekDuration;
+@property (nonatomic) NSTimeInterval seekFinishTime;
+@property (nonatomic) BOOL seekInFlight;
+
+@end
+
+@implementation BCSeekCoalescerTests
+
+@synthesize coalescer;
+@synthesize seekTargets;
+@synthesize seekDuration;
+@synthesize seekFinishTime;
+@synthesize seekInFlight;
+
+- (void)setUp
+{
+    [super setUp];
+    self.seekTargets = [NSMutableArray array];
+    __block BCSeekCoalescerTests *weakself = self;
+    self.coalescer = [[[BCSimulatedSeekCoalescer alloc] initWithSeekBlock:^(NSTimeInterval time, BOOL exact) {
+        [weakself.seekTargets addObject:[NSNumber numberWithDouble:time]];
+        weakself.seekInFlight = YES;
+        weakself.seekFinishTime = weakself.coalescer.simulatedTime + weakself.seekDuration;
+    }] autorelease];
+}
+
+- (void)tearDown
+{
+    self.coalescer = nil;
+    self.seekTargets = nil;
+    [super tearDown];
+}
+
+/**
+ * Lets the player finish every seek it would have finished by time.
+ */
+- (void)finishSeeksBy:(NSTimeInterval)time
+{
+    while (self.seekInFlight && self.seekFinishTime <= time) {
+        self.coalescer.simulatedTime = self.seekFinishTime;
+        self.seekInFlight = NO;
+        [self.coalescer seekDidFinish];
+    }
+    self.coalescer.simulatedTime = MAX(self.coalescer.simulatedTime, time);
+}
+
+- (void)testScrubIsCoalesced
+{
+    // Two seconds of dragging, with a slider event every frame and seeks that take a fifth of a second.
+    NSTimeInterval duration = 2;
+    NSTimeInterval eventInterval = 1.0 / 60;
+    self.seekDuration = 0.2;
+
+    NSUInteger events = 0;
+    for (NSUInteger frame = 0; frame * eventInterval <= duration; frame++) {
+        NSTimeInterval time = frame * eventInterval;
+        [self finishSeeksBy:time];
+        BOOL last = time + eventInterval > duration;
+        [self.coalescer requestSeekTo:BCSeekCoalescerTestsVideoDuration * time / duration exact:last];
+        events++;
+    }
+    [self finishSeeksBy:DBL_MAX];
+
+    NSLog(@"%s %lu slider events: %lu seeks, %lu dropped, %.1fs seeking instead of %.1fs",
+          __PRETTY_FUNCTION__, (unsigned long)events, (unsigned long)self.coalescer.seekCount,
+          (unsigned long)self.coalescer.droppedCount, self.coalescer.seekCount * self.seekDuration,
+          events * self.seekDuration);
+
+    STAssertEquals(self.coalescer.requestCount, events, nil);
+    STAssertEquals(self.coalescer.seekCount, [self.seekTargets count], nil);
+    STAssertEquals(self.coalescer.seekCount + self.coalescer.droppedCount, events, nil);
+    STAssertTrue(self.coalescer.seekCount <= duration / self.seekDuration + 2, @"%lu", (unsigned long)self.coalescer.seekCount);
+
+    // The scrub ends where the slider was let go.
+    STAssertEqualsWithAccuracy([[self.seekTargets lastObject] doubleValue], (double)BCSeekCoalescerTestsVideoDuration, 10.0, nil);
+}
+
+- (void)testLostCompletionIsGivenUp
+{
+    [self.coalescer requestSeekTo:10 exact:YES];
+    STAssertEquals([self.seekTargets count], (NSUInteger)1, nil);
+
+    // Held while the first is in flight.
+    self.coalescer.simulatedTime = 0.5;
+    [self.coalescer requestSeekTo:20 exact:YES];
+    STAssertEquals([self.seekTargets count], (NSUInteger)1, nil);
+
+    // The first never reports finishing, so a later request replaces the held one and starts.
+    self.coalescer.simulatedTime = 2;
+    [self.coalescer requestSeekTo:30 exact:YES];
+    STAssertEquals([self.seekTargets count], (NSUInteger)2, nil);
+    STAssertEqualObjects([self.seekTargets lastObject], [NSNumber numberWithDouble:30], nil);
+    STAssertEquals(self.coalescer.droppedCount, (NSUInteger)1, nil);
+}
+
+- (void)testResetDropsHeldSeek
+{
+    [self.coalescer requestSeekTo:10 exact:NO];
+    [self.coalescer requestSeekTo:20 exact:NO];
+    [self.coalescer reset];
+    [self.coalescer seekDidFinish];
+    STAssertEquals([self.seekTargets count], (NSUInteger)1, nil);
+
+    STAssertEquals([self.coalescer requestSeekTo:-5 exact:NO], (NSTimeInterval)0, nil);
+    STAssertEquals([self.seekTargets count], (NSUInteger)2, nil);
+}
+
+@end
@@ -0,0 +1,97 @@
+//
+//  BCStubMediaServer.h
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <Foundation/Foundation.h>
+
+/**
+ * A canned HTTP response, optionally held back for a while before it is sent.
+ */
+@interface BCStubResponse : NSObject
+
++ (BCStubResponse *)responseWithStatusCode:(NSInteger)statusCode headers:(NSDictionary *)headers body:(NSString *)body;
+
+@property (nonatomic) NSInteger statusCode;
+@property (nonatomic, retain) NSDictionary *headers;
+@property (nonatomic, retain) NSData *data;
+
+/**
+ * Seconds to wait before responding. Defaults to 0.
+ */
+@property (nonatomic) NSTimeInterval delay;
+
+@end
+
+/**
+ * The type of blocks that answer stub requests.
+ * @param request the request as the URL loading system sent it, with any
+ *     conditional headers.
+ * @param requestNumber the number of requests received before this one.
+ */
+typedef BCStubResponse *(^BCStubResponder)(NSURLRequest *request, NSUInteger requestNumber);
+
+/**
+ * A stand-in for the Media API, so the request layer can be tested without a
+ * network. Requests to URLWithQuery: are answered by an NSURLProtocol on the
+ * URL loading thread, from responder, and the server counts what it served.
+ *
+ * Tests start the server in setUp, stop it in tearDown and wait for their
+ * requests with waitUntil:timeout:, which runs the main run loop the request
+ * layer receives its callbacks on.
+ */
+@interface BCStubMediaServer : NSObject
+
++ (BCStubMediaServer *)sharedServer;
+
+/**
+ * Forgets earlier requests and starts answering.
+ */
+- (void)start;
+
+/**
+ * Stops answering; requests to the server then fail as unsupported.
+ */
+- (void)stop;
+
+/**
+ * Returns a Media API URL on the server for a query string.
+ */
++ (NSURL *)URLWithQuery:(NSString *)query;
+
+/**
+ * Answers each request. Requests are answered 404 if it is nil.
+ */
+@property (copy) BCStubResponder responder;
+
+/**
+ * Requests received, oldest first.
+ */
+@property (readonly) NSArray *requests;
+
+/**
+ * Number of requests received.
+ */
+@property (readonly) NSUInteger requestCount;
+
+/**
+ * Response body bytes sent.
+ */
+@property (readonly) unsigned long long bytesServed;
+
+/**
+ * Most requests that were in flight at once.
+ */
+@property (readonly) NSUInteger maxConcurrentRequests;
+
+/**
+ * Runs the main run loop until condition returns YES or timeout passes.
+ *
+ * @return the last result of condition.
+ */
+- (BOOL)waitUntil:(BOOL (^)(void))condition timeout:(NSTimeInterval)timeout;
+
+@end
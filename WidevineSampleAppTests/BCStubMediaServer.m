@@ -0,0 +1,254 @@
+//
+//  BCStubMediaServer.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import "BCStubMediaServer.h"
+
+#define BCStubMediaServerHost @"stub.api.brightcove.test"
+
+@implementation BCStubResponse
+
+@synthesize statusCode;
+@synthesize headers;
+@synthesize data;
+@synthesize delay;
+
++ (BCStubResponse *)responseWithStatusCode:(NSInteger)statusCode headers:(NSDictionary *)headers body:(NSString *)body
+{
+    BCStubResponse *response = [[[BCStubResponse alloc] init] autorelease];
+    response.statusCode = statusCode;
+    response.headers = headers;
+    response.data = [body dataUsingEncoding:NSUTF8StringEncoding];
+    return response;
+}
+
+- (void)dealloc
+{
+    self.headers = nil;
+    self.data = nil;
+
+    [super dealloc];
+}
+
+@end
+
+@interface BCStubMediaServer ()
+{
+    NSMutableArray *receivedRequests;
+    unsigned long long bytesServed;
+    NSUInteger inFlightCount;
+    NSUInteger maxConcurrentRequests;
+}
+
+@property BOOL started;
+
+- (BCStubResponse *)responseForRequest:(NSURLRequest *)request;
+- (void)requestDidSendBytes:(NSUInteger)count;
+- (void)requestDidFinish;
+
+@end
+
+/**
+ * Answers requests to the stub host for BCStubMediaServer.
+ */
+@interface BCStubURLProtocol : NSURLProtocol
+
+@property (nonatomic, retain) BCStubResponse *stubResponse;
+@property (nonatomic) BOOL inFlight;
+
+@end
+
+@implementation BCStubURLProtocol
+
+@synthesize stubResponse;
+@synthesize inFlight;
+
++ (BOOL)canInitWithRequest:(NSURLRequest *)request
+{
+    return [BCStubMediaServer sharedServer].started && [[[request URL] host] isEqualToString:BCStubMediaServerHost];
+}
+
++ (NSURLRequest *)canonicalRequestForRequest:(NSURLRequest *)request
+{
+    return request;
+}
+
+- (void)dealloc
+{
+    self.stubResponse = nil;
+
+    [super dealloc];
+}
+
+- (void)startLoading
+{
+    self.inFlight = YES;
+    self.stubResponse = [[BCStubMediaServer sharedServer] responseForRequest:self.request];
+
+    // Common modes, so the response goes out whichever mode the URL loading thread runs in.
+    [self performSelector:@selector(respond) withObject:nil afterDelay:self.stubResponse.delay
+                  inModes:[NSArray arrayWithObject:NSRunLoopCommonModes]];
+}
+
+- (void)stopLoading
+{
+    [NSObject cancelPreviousPerformRequestsWithTarget:self selector:@selector(respond) object:nil];
+    [self finish];
+}
+
+- (void)respond
+{
+    NSHTTPURLResponse *response = [[[NSHTTPURLResponse alloc] initWithURL:[self.request URL]
+                                                               statusCode:self.stubResponse.statusCode
+                                                              HTTPVersion:@"HTTP/1.1"
+                                                             headerFields:self.stubResponse.headers] autorelease];
+    [self.client URLProtocol:self didReceiveResponse:response cacheStoragePolicy:NSURLCacheStorageNotAllowed];
+    if ([self.stubResponse.data length] > 0) {
+        [self.client URLProtocol:self didLoadData:self.stubResponse.data];
+        [[BCStubMediaServer sharedServer] requestDidSendBytes:[self.stubResponse.data length]];
+    }
+    [self finish];
+    [self.client URLProtocolDidFinishLoading:self];
+}
+
+- (void)finish
+{
+    if (self.inFlight) {
+        self.inFlight = NO;
+        [[BCStubMediaServer sharedServer] requestDidFinish];
+    }
+}
+
+@end
+
+@implementation BCStubMediaServer
+
+@synthesize responder;
+@synthesize started;
+
++ (BCStubMediaServer *)sharedServer
+{
+    static BCStubMediaServer *sharedServer = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        sharedServer = [[BCStubMediaServer alloc] init];
+    });
+    return sharedServer;
+}
+
++ (NSURL *)URLWithQuery:(NSString *)query
+{
+    return [NSURL URLWithString:[NSString stringWithFormat:@"http://%@/services/library?%@", BCStubMediaServerHost, query]];
+}
+
+- (id)init
+{
+    if (self = [super init]) {
+        receivedRequests = [[NSMutableArray alloc] init];
+    }
+
+    return self;
+}
+
+- (void)dealloc
+{
+    [self stop];
+    self.responder = nil;
+    [receivedRequests release];
+
+    [super dealloc];
+}
+
+- (void)start
+{
+    @synchronized(self) {
+        [receivedRequests removeAllObjects];
+        bytesServed = 0;
+        inFlightCount = 0;
+        maxConcurrentRequests = 0;
+    }
+    self.started = YES;
+    [NSURLProtocol registerClass:[BCStubURLProtocol class]];
+}
+
+- (void)stop
+{
+    [NSURLProtocol unregisterClass:[BCStubURLProtocol class]];
+    self.started = NO;
+    self.responder = nil;
+}
+
+- (NSArray *)requests
+{
+    @synchronized(self) {
+        return [[receivedRequests copy] autorelease];
+    }
+}
+
+- (NSUInteger)requestCount
+{
+    @synchronized(self) {
+        return [receivedRequests count];
+    }
+}
+
+- (unsigned long long)bytesServed
+{
+    @synchronized(self) {
+        return bytesServed;
+    }
+}
+
+- (NSUInteger)maxConcurrentRequests
+{
+    @synchronized(self) {
+        return maxConcurrentRequests;
+    }
+}
+
+- (BOOL)waitUntil:(BOOL (^)(void))condition timeout:(NSTimeInterval)timeout
+{
+    NSDate *deadline = [NSDate dateWithTimeIntervalSinceNow:timeout];
+    while (!condition() && [deadline timeIntervalSinceNow] > 0) {
+        [[NSRunLoop mainRunLoop] runMode:NSDefaultRunLoopMode beforeDate:[NSDate dateWithTimeIntervalSinceNow:0.01]];
+    }
+    return condition();
+}
+
+#pragma mark - BCStubURLProtocol
+
+- (BCStubResponse *)responseForRequest:(NSURLRequest *)request
+{
+    NSUInteger requestNumber;
+    BCStubResponder currentResponder;
+    @synchronized(self) {
+        requestNumber = [receivedRequests count];
+        [receivedRequests addObject:request];
+        inFlightCount++;
+        maxConcurrentRequests = MAX(maxConcurrentRequests, inFlightCount);
+        currentResponder = [[self.responder retain] autorelease];
+    }
+
+    BCStubResponse *response = currentResponder ? currentResponder(request, requestNumber) : nil;
+    return response ? response : [BCStubResponse responseWithStatusCode:404 headers:nil body:nil];
+}
+
+- (void)requestDidSendBytes:(NSUInteger)count
+{
+    @synchronized(self) {
+        bytesServed += count;
+    }
+}
+
+- (void)requestDidFinish
+{
+    @synchronized(self) {
+        inFlightCount--;
+    }
+}
+
+@end
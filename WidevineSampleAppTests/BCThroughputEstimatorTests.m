@@ -0,0 +1,219 @@
+//
+//  BCThroughputEstimatorTests.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+
+#import "BCThroughputEstimator.h"
+
+#define BCThroughputEstimatorTestsDefaultsKey @"BCThroughputEstimatorTests"
+
+@interface BCThroughputEstimatorTests : SenTestCase
+
+@property (nonatomic, retain) BCThroughputEstimator *estimator;
+
+@end
+
+@implementation BCThroughputEstimatorTests
+
+@synthesize estimator;
+
+- (void)setUp
+{
+    [super setUp];
+    self.estimator = [[[BCThroughputEstimator alloc] initWithDefaultsKey:nil] autorelease];
+}
+
+- (void)tearDown
+{
+    self.estimator = nil;
+    [[NSUserDefaults standardUserDefaults] removeObjectForKey:BCThroughputEstimatorTestsDefaultsKey];
+    [super tearDown];
+}
+
+/**
+ * Feeds the estimator a synthetic transfer log: one transfer per line, as the
+ * network type ("wifi", "cellular" or "unknown"), bytes and seconds.
+ */
+- (void)replayLog:(NSString *)log
+{
+    for (NSString *line in [log componentsSeparatedByString:@"\n"]) {
+        NSArray *fields = [[line stringByTrimmingCharactersInSet:[NSCharacterSet whitespaceCharacterSet]]
+                           componentsSeparatedByString:@" "];
+        if ([fields count] != 3) {
+            continue;
+        }
+
+        NSString *typeName = [fields objectAtIndex:0];
+        BCNetworkType type = BCNetworkTypeUnknown;
+        if ([typeName isEqualToString:@"wifi"]) {
+            type = BCNetworkTypeWiFi;
+        } else if ([typeName isEqualToString:@"cellular"]) {
+            type = BCNetworkTypeCellular;
+        }
+        [self.estimator recordTransferOfBytes:[[fields objectAtIndex:1] longLongValue]
+                                     duration:[[fields objectAtIndex:2] doubleValue]
+                                  networkType:type];
+    }
+}
+
+/**
+ * Returns a log of count identical transfers.
+ */
+- (NSString *)logWithCount:(NSUInteger)count type:(NSString *)type bytes:(long long)bytes seconds:(double)seconds
+{
+    NSMutableString *log = [NSMutableString string];
+    for (NSUInteger i = 0; i < count; i++) {
+        [log appendFormat:@"%@ %lld %g\n", type, bytes, seconds];
+    }
+    return log;
+}
+
+- (void)testWithoutSamplesReturnsDefault
+{
+    STAssertEquals([self.estimator estimatedBandwidthForNetworkType:BCNetworkTypeWiFi], self.estimator.defaultBandwidth, nil);
+    STAssertEquals([self.estimator windowBandwidthForNetworkType:BCNetworkTypeWiFi], 0.0, nil);
+    STAssertEquals([self.estimator averageBandwidthForNetworkType:BCNetworkTypeWiFi], 0.0, nil);
+}
+
+- (void)testSteadyTransfersConverge
+{
+    // 250KB every half second is 4 Mbps.
+    [self replayLog:[self logWithCount:40 type:@"wifi" bytes:250000 seconds:0.5]];
+
+    STAssertEqualsWithAccuracy([self.estimator windowBandwidthForNetworkType:BCNetworkTypeWiFi], 4000000.0, 1.0, nil);
+    STAssertEqualsWithAccuracy([self.estimator averageBandwidthForNetworkType:BCNetworkTypeWiFi], 4000000.0, 1.0, nil);
+    STAssertEqualsWithAccuracy([self.estimator estimatedBandwidthForNetworkType:BCNetworkTypeWiFi], 4000000.0, 1.0, nil);
+}
+
+- (void)testWindowIsTotalBytesOverTotalTime
+{
+    self.estimator.windowSize = 2;
+    [self replayLog:@"wifi 100000 10\n"
+                    @"wifi 100000 1\n"
+                    @"wifi 300000 1\n"];
+
+    // Only the last two transfers: 400KB in 2 seconds.
+    STAssertEqualsWithAccuracy([self.estimator windowBandwidthForNetworkType:BCNetworkTypeWiFi], 1600000.0, 1.0, nil);
+}
+
+- (void)testAverageWeighsNewestBySmoothingFactor
+{
+    self.estimator.smoothingFactor = 0.5;
+    [self replayLog:@"wifi 100000 1\n"
+                    @"wifi 300000 1\n"];
+
+    // 800 Kbps, then halfway to 2.4 Mbps.
+    STAssertEqualsWithAccuracy([self.estimator averageBandwidthForNetworkType:BCNetworkTypeWiFi], 1600000.0, 1.0, nil);
+}
+
+- (void)testOneFastTransferBarelyRaisesEstimate
+{
+    [self replayLog:[self logWithCount:16 type:@"wifi" bytes:125000 seconds:1]];
+    double before = [self.estimator estimatedBandwidthForNetworkType:BCNetworkTypeWiFi];
+
+    [self replayLog:@"wifi 1250000 1\n"];
+    double after = [self.estimator estimatedBandwidthForNetworkType:BCNetworkTypeWiFi];
+
+    // The transfer ran at ten times the estimate; the window keeps the estimate well below twice it.
+    STAssertTrue(after > before, nil);
+    STAssertTrue(after < before * 2, @"%g after %g", after, before);
+}
+
+- (void)testSlowdownLowersEstimateStraightAway
+{
+    [self replayLog:[self logWithCount:16 type:@"wifi" bytes:1250000 seconds:1]];
+    double before = [self.estimator estimatedBandwidthForNetworkType:BCNetworkTypeWiFi];
+
+    // A transfer at a tenth of the speed takes ten seconds, so it dominates the window's total time.
+    [self replayLog:@"wifi 1250000 10\n"];
+    double after = [self.estimator estimatedBandwidthForNetworkType:BCNetworkTypeWiFi];
+
+    STAssertTrue(after < before * 0.7, @"%g after %g", after, before);
+}
+
+- (void)testSmallTransfersAreIgnored
+{
+    [self replayLog:[NSString stringWithFormat:@"wifi 1000 0.001\nwifi %lld 0.001\n", self.estimator.minimumTransferSize - 1]];
+
+    STAssertEquals([self.estimator windowBandwidthForNetworkType:BCNetworkTypeWiFi], 0.0, nil);
+}
+
+- (void)testStreamTransfersOutweighSmallOnes
+{
+    // A catalog response and a still, each slowed by the connection ramping up...
+    self.estimator.networkType = BCNetworkTypeWiFi;
+    [self replayLog:@"wifi 100000 0.4\n"
+                    @"wifi 70000 0.35\n"];
+    STAssertEqualsWithAccuracy([self.estimator estimatedBandwidth], 1813333.0, 1.0, nil);
+
+    // ...then two 4 MB stretches of the stream at the 8 Mbps the link really has.
+    [self.estimator recordStreamTransferOfBytes:4000000 observedBitrate:8000000];
+    [self.estimator recordStreamTransferOfBytes:4000000 observedBitrate:8000000];
+
+    STAssertTrue([self.estimator windowBandwidthForNetworkType:BCNetworkTypeWiFi] > 7000000,
+                 @"%g", [self.estimator windowBandwidthForNetworkType:BCNetworkTypeWiFi]);
+    STAssertTrue([self.estimator estimatedBandwidth] > 3000000, @"%g", [self.estimator estimatedBandwidth]);
+}
+
+- (void)testStreamWithoutBitrateIsIgnored
+{
+    self.estimator.networkType = BCNetworkTypeWiFi;
+    [self.estimator recordStreamTransferOfBytes:4000000 observedBitrate:0];
+
+    STAssertEquals([self.estimator windowBandwidthForNetworkType:BCNetworkTypeWiFi], 0.0, nil);
+}
+
+- (void)testZeroDurationIsIgnored
+{
+    [self replayLog:@"wifi 100000 0\n"];
+
+    STAssertEquals([self.estimator windowBandwidthForNetworkType:BCNetworkTypeWiFi], 0.0, nil);
+}
+
+- (void)testNetworkTypesAreKeptApart
+{
+    [self replayLog:@"wifi 1000000 1\n"
+                    @"cellular 100000 1\n"];
+
+    STAssertEqualsWithAccuracy([self.estimator estimatedBandwidthForNetworkType:BCNetworkTypeWiFi], 8000000.0, 1.0, nil);
+    STAssertEqualsWithAccuracy([self.estimator estimatedBandwidthForNetworkType:BCNetworkTypeCellular], 800000.0, 1.0, nil);
+    STAssertEquals([self.estimator estimatedBandwidthForNetworkType:BCNetworkTypeUnknown], self.estimator.defaultBandwidth, nil);
+}
+
+- (void)testCurrentNetworkTypeSelectsEstimate
+{
+    [self replayLog:@"cellular 100000 1\n"];
+
+    self.estimator.networkType = BCNetworkTypeCellular;
+    STAssertEqualsWithAccuracy([self.estimator estimatedBandwidth], 800000.0, 1.0, nil);
+    STAssertEqualsWithAccuracy([self.estimator estimatedDurationForBytes:200000], 2.0, 0.001, nil);
+
+    self.estimator.networkType = BCNetworkTypeWiFi;
+    STAssertEquals([self.estimator estimatedBandwidth], self.estimator.defaultBandwidth, nil);
+}
+
+- (void)testSamplesPersistAcrossInstances
+{
+    self.estimator = [[[BCThroughputEstimator alloc] initWithDefaultsKey:BCThroughputEstimatorTestsDefaultsKey] autorelease];
+    [self replayLog:[self logWithCount:5 type:@"wifi" bytes:500000 seconds:1]];
+    double recorded = [self.estimator estimatedBandwidthForNetworkType:BCNetworkTypeWiFi];
+
+    BCThroughputEstimator *relaunched = [[[BCThroughputEstimator alloc] initWithDefaultsKey:BCThroughputEstimatorTestsDefaultsKey] autorelease];
+    STAssertEqualsWithAccuracy([relaunched estimatedBandwidthForNetworkType:BCNetworkTypeWiFi], recorded, 1.0, nil);
+
+    // New samples keep sliding the restored window.
+    relaunched.windowSize = 5;
+    [relaunched recordTransferOfBytes:125000 duration:1 networkType:BCNetworkTypeWiFi];
+    STAssertEqualsWithAccuracy([relaunched windowBandwidthForNetworkType:BCNetworkTypeWiFi], 3400000.0, 1.0, nil);
+
+    [relaunched reset];
+    BCThroughputEstimator *afterReset = [[[BCThroughputEstimator alloc] initWithDefaultsKey:BCThroughputEstimatorTestsDefaultsKey] autorelease];
+    STAssertEquals([afterReset windowBandwidthForNetworkType:BCNetworkTypeWiFi], 0.0, nil);
+}
+
+@end
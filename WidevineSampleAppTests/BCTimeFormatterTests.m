@@ -0,0 +1,98 @@
+//
+//  BCTimeFormatterTests.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+
+#import "BCTimeFormatter.h"
+
+// Progress ticks four times a second across half a minute of playback, as the control bar sees them.
+#define BCTimeFormatterTestsTicks 120
+#define BCTimeFormatterTestsTickInterval 0.25
+
+@interface BCTimeFormatterTests : SenTestCase
+
+@property (nonatomic, retain) BCTimeFormatter *formatter;
+
+@end
+
+@implementation BCTimeFormatterTests
+
+@synthesize formatter;
+
+- (void)setUp
+{
+    [super setUp];
+    self.formatter = [[[BCTimeFormatter alloc] init] autorelease];
+}
+
+- (void)tearDown
+{
+    self.formatter = nil;
+    [super tearDown];
+}
+
+- (void)testStyles
+{
+    STAssertEqualObjects([self.formatter stringForSeconds:425.9 style:BCTimeFormatterStyleMinutesSeconds], @"07:05", nil);
+    STAssertEqualObjects([self.formatter stringForSeconds:4025 style:BCTimeFormatterStyleMinutesSeconds], @"67:05", nil);
+    STAssertEqualObjects([self.formatter stringForSeconds:4025 style:BCTimeFormatterStyleHoursMinutesSeconds], @"1:07:05", nil);
+    STAssertEqualObjects([self.formatter stringForSeconds:425 style:BCTimeFormatterStyleHoursMinutesSeconds], @"0:07:05", nil);
+    STAssertEqualObjects([self.formatter stringForSeconds:-3 style:BCTimeFormatterStyleMinutesSeconds], @"00:00", nil);
+    STAssertEqualObjects([self.formatter stringForSeconds:NAN style:BCTimeFormatterStyleMinutesSeconds], @"00:00", nil);
+    STAssertEqualObjects([self.formatter stringForSeconds:INFINITY style:BCTimeFormatterStyleMinutesSeconds], @"00:00", nil);
+}
+
+- (void)testCacheKeepsSecondsApart
+{
+    // 1 and 129 share a slot; each replaces the other rather than being returned for it.
+    STAssertEqualObjects([self.formatter stringForSeconds:1 style:BCTimeFormatterStyleMinutesSeconds], @"00:01", nil);
+    STAssertEqualObjects([self.formatter stringForSeconds:129 style:BCTimeFormatterStyleMinutesSeconds], @"02:09", nil);
+    STAssertEqualObjects([self.formatter stringForSeconds:1 style:BCTimeFormatterStyleMinutesSeconds], @"00:01", nil);
+    STAssertEqualObjects([self.formatter stringForSeconds:1 style:BCTimeFormatterStyleHoursMinutesSeconds], @"0:00:01", nil);
+    STAssertEquals(self.formatter.missCount, (NSUInteger)4, nil);
+    STAssertEquals(self.formatter.hitCount, (NSUInteger)0, nil);
+}
+
+- (void)testProgressTicksMakeNoStringsAfterWarmUp
+{
+    // What BCUIControls formatTime: did before: a new string every tick.
+    NSDate *start = [NSDate date];
+    NSAutoreleasePool *pool = [[NSAutoreleasePool alloc] init];
+    for (NSUInteger tick = 0; tick < BCTimeFormatterTestsTicks; tick++) {
+        int seconds = (int)(tick * BCTimeFormatterTestsTickInterval);
+        [NSString stringWithFormat:@"%.2d:%.2d", seconds / 60, seconds % 60];
+    }
+    [pool drain];
+    NSTimeInterval baselineTime = -[start timeIntervalSinceNow];
+
+    // The first pass fills the cache with one string per second shown.
+    for (NSUInteger tick = 0; tick < BCTimeFormatterTestsTicks; tick++) {
+        [self.formatter stringForSeconds:tick * BCTimeFormatterTestsTickInterval style:BCTimeFormatterStyleMinutesSeconds];
+    }
+    NSUInteger seconds = (NSUInteger)(BCTimeFormatterTestsTicks * BCTimeFormatterTestsTickInterval);
+    STAssertEquals(self.formatter.missCount, seconds, nil);
+
+    // Seeking back over the same stretch makes no strings at all.
+    NSUInteger missesBefore = self.formatter.missCount;
+    start = [NSDate date];
+    pool = [[NSAutoreleasePool alloc] init];
+    for (NSUInteger tick = 0; tick < BCTimeFormatterTestsTicks; tick++) {
+        [self.formatter stringForSeconds:tick * BCTimeFormatterTestsTickInterval style:BCTimeFormatterStyleMinutesSeconds];
+    }
+    [pool drain];
+    NSTimeInterval formatterTime = -[start timeIntervalSinceNow];
+    double stringsPerTick = (double)(self.formatter.missCount - missesBefore) / BCTimeFormatterTestsTicks;
+
+    NSLog(@"%s %d ticks: stringWithFormat: %.0fns per tick, formatter %.0fns and %.2f strings per tick",
+          __PRETTY_FUNCTION__, BCTimeFormatterTestsTicks, baselineTime * NSEC_PER_SEC / BCTimeFormatterTestsTicks,
+          formatterTime * NSEC_PER_SEC / BCTimeFormatterTestsTicks, stringsPerTick);
+
+    STAssertEquals(stringsPerTick, 0.0, nil);
+}
+
+@end
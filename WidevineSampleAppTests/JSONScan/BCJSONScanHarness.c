@@ -0,0 +1,396 @@
+//
+//  BCJSONScanHarness.c
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+/*
+ * Checks and times the BCJSONScan primitives outside the app; see the Makefile.
+ *
+ *   fuzz [iterations [seed]]   runs every vector implementation the CPU has
+ *                              against the scalar one on random buffers.
+ *   bench file...              times each implementation walking the corpus
+ *                              the way BCJSONReader does.
+ *
+ * BCJSONScan.c is included rather than linked so the harness can call each
+ * implementation directly instead of only the one the dispatcher picks.
+ */
+
+#include "../../WidevineSampleApp/lib/bc-ios-sdk/BCJSONScan.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    const char *name;
+    BCJSONScanFunction scanString;
+    BCJSONScanFunction skipWhitespace;
+    BCJSONTestFunction isASCII;
+} BCJSONScanImplementationEntry;
+
+static BCJSONScanImplementationEntry implementations[4];
+static int implementationCount;
+
+/**
+ * Lists the scalar implementation first, then each vector one this CPU runs.
+ */
+static void BCJSONHarnessFindImplementations(void)
+{
+    implementations[implementationCount++] = (BCJSONScanImplementationEntry) {
+        "scalar", BCJSONScanStringScalar, BCJSONSkipWhitespaceScalar, BCJSONIsASCIIScalar };
+#if BCJSON_X86 && defined(__SSE2__)
+    implementations[implementationCount++] = (BCJSONScanImplementationEntry) {
+        "sse2", BCJSONScanStringSSE2, BCJSONSkipWhitespaceSSE2, BCJSONIsASCIISSE2 };
+    if (BCJSONCPUSupportsAVX2()) {
+        implementations[implementationCount++] = (BCJSONScanImplementationEntry) {
+            "avx2", BCJSONScanStringAVX2, BCJSONSkipWhitespaceSSE2, BCJSONIsASCIIAVX2 };
+    }
+#elif BCJSON_NEON
+    implementations[implementationCount++] = (BCJSONScanImplementationEntry) {
+        "neon", BCJSONScanStringNEON, BCJSONSkipWhitespaceNEON, BCJSONIsASCIINEON };
+#endif
+}
+
+#pragma mark - Fuzz
+
+static uint64_t randomState;
+
+static uint32_t BCJSONHarnessRandom(void)
+{
+    // xorshift64*
+    randomState ^= randomState >> 12;
+    randomState ^= randomState << 25;
+    randomState ^= randomState >> 27;
+    return (uint32_t)((randomState * 2685821657736338717ULL) >> 32);
+}
+
+/**
+ * Appends the UTF-8 for a code point, or returns 0 if it does not fit.
+ */
+static size_t BCJSONHarnessAppendUTF8(uint8_t *p, size_t room, uint32_t c)
+{
+    if (c < 0x80 && room >= 1) {
+        p[0] = c;
+        return 1;
+    } else if (c < 0x800 && room >= 2) {
+        p[0] = 0xC0 | (c >> 6);
+        p[1] = 0x80 | (c & 0x3F);
+        return 2;
+    } else if (c >= 0x800 && c < 0x10000 && room >= 3) {
+        p[0] = 0xE0 | (c >> 12);
+        p[1] = 0x80 | ((c >> 6) & 0x3F);
+        p[2] = 0x80 | (c & 0x3F);
+        return 3;
+    } else if (c >= 0x10000 && room >= 4) {
+        p[0] = 0xF0 | (c >> 18);
+        p[1] = 0x80 | ((c >> 12) & 0x3F);
+        p[2] = 0x80 | ((c >> 6) & 0x3F);
+        p[3] = 0x80 | (c & 0x3F);
+        return 4;
+    }
+    return 0;
+}
+
+/**
+ * Fills a buffer with one of several kinds of content, chosen so the special
+ * byte each primitive looks for turns up at every offset within a vector.
+ */
+static void BCJSONHarnessFill(uint8_t *buffer, size_t length)
+{
+    static const uint8_t specials[] = { '"', '\\', 0x00, 0x1F, ' ', '\t', '\n', '\r', 0x7F, 0x80, 0xFF, 0x20, 0x21 };
+
+    switch (BCJSONHarnessRandom() % 5) {
+        case 0:
+            // Arbitrary bytes.
+            for (size_t i = 0; i < length; i++) {
+                buffer[i] = BCJSONHarnessRandom();
+            }
+            break;
+        case 1:
+        case 2: {
+            // String contents: printable ASCII with the odd special byte.
+            uint32_t odds = 1 + BCJSONHarnessRandom() % 64;
+            for (size_t i = 0; i < length; i++) {
+                buffer[i] = BCJSONHarnessRandom() % odds ? 'a' + BCJSONHarnessRandom() % 26
+                                                         : specials[BCJSONHarnessRandom() % sizeof(specials)];
+            }
+            break;
+        }
+        case 3: {
+            // Indentation: whitespace with the odd other byte.
+            uint32_t odds = 1 + BCJSONHarnessRandom() % 64;
+            for (size_t i = 0; i < length; i++) {
+                buffer[i] = BCJSONHarnessRandom() % odds ? " \t\n\r"[BCJSONHarnessRandom() % 4]
+                                                         : specials[BCJSONHarnessRandom() % sizeof(specials)];
+            }
+            break;
+        }
+        case 4: {
+            // UTF-8 text, sometimes with one byte corrupted.
+            static const uint32_t limits[] = { 0x80, 0x800, 0x10000, 0x110000 };
+            size_t i = 0;
+            while (i < length) {
+                uint32_t c = BCJSONHarnessRandom() % limits[BCJSONHarnessRandom() % 4];
+                if (c >= 0xD800 && c <= 0xDFFF) {
+                    c = 'x';
+                }
+                size_t count = BCJSONHarnessAppendUTF8(buffer + i, length - i, c);
+                if (count == 0) {
+                    buffer[i] = 'x';
+                    count = 1;
+                }
+                i += count;
+            }
+            if (length > 0 && BCJSONHarnessRandom() % 2) {
+                buffer[BCJSONHarnessRandom() % length] = specials[BCJSONHarnessRandom() % sizeof(specials)];
+            }
+            break;
+        }
+    }
+}
+
+static void BCJSONHarnessDump(const uint8_t *p, const uint8_t *end)
+{
+    for (const uint8_t *q = p; q < end; q++) {
+        fprintf(stderr, "%02x%s", *q, (q - p) % 32 == 31 ? "\n" : " ");
+    }
+    fprintf(stderr, "\n");
+}
+
+static int BCJSONHarnessMismatch(const char *function, const char *implementation,
+                                 const uint8_t *p, const uint8_t *end, long expected, long actual)
+{
+    fprintf(stderr, "%s: %s returned %ld, scalar returned %ld, for %ld bytes:\n",
+            function, implementation, actual, expected, (long)(end - p));
+    BCJSONHarnessDump(p, end);
+    return 1;
+}
+
+/**
+ * Compares every implementation with the scalar one on [p, end).
+ */
+static int BCJSONHarnessCompare(const uint8_t *p, const uint8_t *end)
+{
+    const BCJSONScanImplementationEntry *scalar = &implementations[0];
+    long expectedString = scalar->scanString(p, end) - p;
+    long expectedWhitespace = scalar->skipWhitespace(p, end) - p;
+    bool expectedASCII = scalar->isASCII(p, end);
+
+    for (int i = 1; i < implementationCount; i++) {
+        const BCJSONScanImplementationEntry *entry = &implementations[i];
+        long actual = entry->scanString(p, end) - p;
+        if (actual != expectedString) {
+            return BCJSONHarnessMismatch("scanString", entry->name, p, end, expectedString, actual);
+        }
+        actual = entry->skipWhitespace(p, end) - p;
+        if (actual != expectedWhitespace) {
+            return BCJSONHarnessMismatch("skipWhitespace", entry->name, p, end, expectedWhitespace, actual);
+        }
+        if (entry->isASCII(p, end) != expectedASCII) {
+            return BCJSONHarnessMismatch("isASCII", entry->name, p, end, expectedASCII, !expectedASCII);
+        }
+    }
+
+    bool expectedUTF8 = BCJSONValidateUTF8Scalar(p, end);
+    if (BCJSONValidateUTF8(p, end) != expectedUTF8) {
+        return BCJSONHarnessMismatch("validateUTF8", BCJSONScanImplementation(), p, end, expectedUTF8, !expectedUTF8);
+    }
+    return 0;
+}
+
+static int BCJSONHarnessFuzz(long iterations, uint64_t seed)
+{
+    randomState = seed ? seed : 1;
+    printf("fuzz: %ld buffers, seed %llu, against", iterations, (unsigned long long)seed);
+    for (int i = 1; i < implementationCount; i++) {
+        printf(" %s", implementations[i].name);
+    }
+    printf("\n");
+
+    for (long n = 0; n < iterations; n++) {
+        // Mostly short buffers, where the vector loops hand over to their scalar tails.
+        size_t length = BCJSONHarnessRandom() % 4 ? BCJSONHarnessRandom() % 80 : BCJSONHarnessRandom() % 600;
+
+        // Each buffer ends at the end of its own allocation, so a sanitizer build catches over-reads.
+        uint8_t *buffer = malloc(length ? length : 1);
+        BCJSONHarnessFill(buffer, length);
+
+        size_t start = length ? BCJSONHarnessRandom() % (length < 40 ? length + 1 : 40) : 0;
+        if (BCJSONHarnessCompare(buffer + start, buffer + length)) {
+            fprintf(stderr, "fuzz: failed at buffer %ld\n", n);
+            free(buffer);
+            return 1;
+        }
+        free(buffer);
+    }
+
+    printf("fuzz: ok\n");
+    return 0;
+}
+
+#pragma mark - Benchmark
+
+/**
+ * Walks a document the way BCJSONReader does: skips whitespace between
+ * tokens and scans each string for its closing quote. Returns a count of the
+ * strings, so the work can't be optimized away.
+ */
+static long BCJSONHarnessWalk(const BCJSONScanImplementationEntry *entry, const uint8_t *p, const uint8_t *end)
+{
+    long strings = 0;
+    while (p < end) {
+        p = entry->skipWhitespace(p, end);
+        if (p == end) {
+            break;
+        }
+        if (*p != '"') {
+            p++;
+            continue;
+        }
+
+        p++;
+        while (p < end) {
+            p = entry->scanString(p, end);
+            if (p == end || *p == '"') {
+                break;
+            }
+            p += *p == '\\' ? 2 : 1;
+        }
+        p++;
+        strings++;
+    }
+    return strings;
+}
+
+static double BCJSONHarnessNow(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+typedef enum {
+    BCJSONHarnessWorkWalk,
+    BCJSONHarnessWorkASCII,
+    BCJSONHarnessWorkUTF8
+} BCJSONHarnessWork;
+
+static long BCJSONHarnessRun(BCJSONHarnessWork work, const BCJSONScanImplementationEntry *entry,
+                             const uint8_t *p, const uint8_t *end)
+{
+    switch (work) {
+        case BCJSONHarnessWorkWalk:
+            return BCJSONHarnessWalk(entry, p, end);
+        case BCJSONHarnessWorkASCII:
+            return entry->isASCII(p, end);
+        case BCJSONHarnessWorkUTF8:
+            // Validation can only use the implementation the dispatcher picked; see BCJSONHarnessBench.
+            return entry == &implementations[0] ? BCJSONValidateUTF8Scalar(p, end) : BCJSONValidateUTF8(p, end);
+    }
+    return 0;
+}
+
+/**
+ * Returns the best throughput of several timed runs, in MB/s.
+ */
+static double BCJSONHarnessTime(BCJSONHarnessWork work, const BCJSONScanImplementationEntry *entry,
+                                const uint8_t *p, const uint8_t *end, long *result)
+{
+    // Enough repeats for each run to take a few milliseconds.
+    long repeats = 1 + (4L << 20) / (end - p + 1);
+    double best = 0;
+    for (int run = 0; run < 7; run++) {
+        double start = BCJSONHarnessNow();
+        for (long i = 0; i < repeats; i++) {
+            *result = BCJSONHarnessRun(work, entry, p, end);
+        }
+        double rate = (double)(end - p) * repeats / (BCJSONHarnessNow() - start) / 1e6;
+        if (rate > best) {
+            best = rate;
+        }
+    }
+    return best;
+}
+
+static uint8_t *BCJSONHarnessReadFile(const char *path, size_t *length)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return NULL;
+    }
+    fseek(file, 0, SEEK_END);
+    *length = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t *bytes = malloc(*length ? *length : 1);
+    if (fread(bytes, 1, *length, file) != *length) {
+        perror(path);
+        free(bytes);
+        bytes = NULL;
+    }
+    fclose(file);
+    return bytes;
+}
+
+static int BCJSONHarnessBench(int fileCount, char **paths)
+{
+    static const char *workNames[] = { "walk", "ascii", "utf8" };
+    int status = 0;
+
+    for (int f = 0; f < fileCount; f++) {
+        size_t length;
+        uint8_t *bytes = BCJSONHarnessReadFile(paths[f], &length);
+        if (!bytes) {
+            return 1;
+        }
+
+        printf("%s: %zu bytes\n", paths[f], length);
+        for (int work = BCJSONHarnessWorkWalk; work <= BCJSONHarnessWorkUTF8; work++) {
+            long expected = 0;
+            double scalarRate = 0;
+            for (int i = 0; i < implementationCount; i++) {
+                if (work == BCJSONHarnessWorkUTF8 && i > 0 &&
+                    strcmp(implementations[i].name, BCJSONScanImplementation()) != 0) {
+                    continue;
+                }
+
+                long result = 0;
+                double rate = BCJSONHarnessTime(work, &implementations[i], bytes, bytes + length, &result);
+                if (i == 0) {
+                    expected = result;
+                    scalarRate = rate;
+                } else if (result != expected) {
+                    // The corpus doubles as a differential test.
+                    fprintf(stderr, "%s: %s %s got %ld, scalar got %ld\n",
+                            paths[f], workNames[work], implementations[i].name, result, expected);
+                    status = 1;
+                }
+                printf("  %-6s %-7s %9.0f MB/s  %5.2fx\n", workNames[work], implementations[i].name,
+                       rate, rate / scalarRate);
+            }
+        }
+        free(bytes);
+    }
+    return status;
+}
+
+int main(int argc, char **argv)
+{
+    BCJSONHarnessFindImplementations();
+
+    if (argc >= 2 && strcmp(argv[1], "fuzz") == 0) {
+        long iterations = argc >= 3 ? atol(argv[2]) : 1000000;
+        uint64_t seed = argc >= 4 ? strtoull(argv[3], NULL, 10) : (uint64_t)time(NULL);
+        return BCJSONHarnessFuzz(iterations, seed);
+    } else if (argc >= 3 && strcmp(argv[1], "bench") == 0) {
+        return BCJSONHarnessBench(argc - 2, argv + 2);
+    }
+
+    fprintf(stderr, "usage: %s fuzz [iterations [seed]]\n"
+                    "       %s bench file...\n", argv[0], argv[0]);
+    return 2;
+}
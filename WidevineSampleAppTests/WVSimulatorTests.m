@@ -0,0 +1,252 @@
+//
+//  WVSimulatorTests.m
+//  WidevinePlugin
+//
+//  Created by agent on 10/19/26.
+//
+//
+
+#import <SenTestingKit/SenTestingKit.h>
+
+#import "WViPhoneAPISimulator.h"
+#import "BCStubMediaServer.h"
+
+#if WV_SIMULATOR_ENABLED
+
+#define WVSimulatorTestsInitializeLatency 0.2
+#define WVSimulatorTestsPlayLatency 0.3
+#define WVSimulatorTestsBitrateSwitchLatency 0.2
+#define WVSimulatorTestsAsset @"http://example.com/widevine/movie.wvm"
+
+// Events the simulator has reported, with the time each arrived, oldest first.
+static NSMutableArray *WVSimulatorTestsEvents = nil;
+
+static WViOsApiStatus WVSimulatorTestsCallback(WViOsApiEvent event, NSDictionary *attributes)
+{
+    NSDictionary *record = [NSDictionary dictionaryWithObjectsAndKeys:
+                            [NSNumber numberWithInt:event], @"event",
+                            attributes ?: [NSDictionary dictionary], @"attributes",
+                            [NSDate date], @"date", nil];
+    @synchronized (WVSimulatorTestsEvents) {
+        [WVSimulatorTestsEvents addObject:record];
+    }
+    return WViOsApiStatus_OK;
+}
+
+@interface WVSimulatorTests : SenTestCase
+
+@end
+
+@implementation WVSimulatorTests
+
+- (void)setUp
+{
+    [super setUp];
+    if (!WVSimulatorTestsEvents) {
+        WVSimulatorTestsEvents = [[NSMutableArray alloc] init];
+    }
+    @synchronized (WVSimulatorTestsEvents) {
+        [WVSimulatorTestsEvents removeAllObjects];
+    }
+
+    [[BCStubMediaServer sharedServer] start];
+    [BCStubMediaServer sharedServer].responder = ^BCStubResponse *(NSURLRequest *request, NSUInteger requestNumber) {
+        return [BCStubResponse responseWithStatusCode:200 headers:nil body:@"#EXTM3U\n"];
+    };
+
+    NSDictionary *configuration = [NSDictionary dictionaryWithObjectsAndKeys:
+                                   [NSNumber numberWithDouble:WVSimulatorTestsInitializeLatency], @"initializeLatency",
+                                   [NSNumber numberWithDouble:0.05], @"queryLatency",
+                                   [NSNumber numberWithDouble:WVSimulatorTestsPlayLatency], @"playLatency",
+                                   [NSNumber numberWithDouble:WVSimulatorTestsBitrateSwitchLatency], @"bitrateSwitchLatency",
+                                   [NSNumber numberWithDouble:0], @"proxyLatency",
+                                   [NSNumber numberWithDouble:0], @"failureRate",
+                                   [NSArray arrayWithObjects:[NSNumber numberWithInt:400000], [NSNumber numberWithInt:800000],
+                                    [NSNumber numberWithInt:1500000], nil], @"bitrates",
+                                   [NSArray array], @"script", nil];
+    [[WVSimulator sharedSimulator] configureWithDictionary:configuration];
+    [WVSimulator sharedSimulator].playbackURL = [BCStubMediaServer URLWithQuery:@"command=playback"];
+}
+
+- (void)tearDown
+{
+    WV_Stop();
+    WV_Terminate();
+    [WVSimulator sharedSimulator].playbackURL = nil;
+    [[BCStubMediaServer sharedServer] stop];
+    [super tearDown];
+}
+
+/**
+ * Returns the date of the first reported event after date, or nil.
+ */
+- (NSDate *)dateOfEvent:(WViOsApiEvent)event after:(NSDate *)date
+{
+    @synchronized (WVSimulatorTestsEvents) {
+        for (NSDictionary *record in WVSimulatorTestsEvents) {
+            NSDate *recordDate = [record objectForKey:@"date"];
+            if ([[record objectForKey:@"event"] intValue] == event && [recordDate compare:date] != NSOrderedAscending) {
+                return recordDate;
+            }
+        }
+    }
+    return nil;
+}
+
+/**
+ * Returns the attributes of the last reported event of a kind, or nil.
+ */
+- (NSDictionary *)attributesOfLastEvent:(WViOsApiEvent)event
+{
+    @synchronized (WVSimulatorTestsEvents) {
+        for (NSDictionary *record in [WVSimulatorTestsEvents reverseObjectEnumerator]) {
+            if ([[record objectForKey:@"event"] intValue] == event) {
+                return [record objectForKey:@"attributes"];
+            }
+        }
+    }
+    return nil;
+}
+
+- (NSDate *)waitForEvent:(WViOsApiEvent)event after:(NSDate *)date timeout:(NSTimeInterval)timeout
+{
+    __block WVSimulatorTests *weakself = self;
+    [[BCStubMediaServer sharedServer] waitUntil:^BOOL {
+        return [weakself dateOfEvent:event after:date] != nil;
+    } timeout:timeout];
+    return [self dateOfEvent:event after:date];
+}
+
+- (NSDate *)initializeSimulator
+{
+    NSDate *start = [NSDate date];
+    STAssertEquals(WV_Initialize(WVSimulatorTestsCallback, [NSDictionary dictionary]), WViOsApiStatus_OK, nil);
+    NSDate *initialized = [self waitForEvent:WViOsApiEvent_Initialized after:start timeout:5];
+    STAssertNotNil(initialized, @"Initialized was not reported");
+    return initialized;
+}
+
+- (NSHTTPURLResponse *)fetch:(NSString *)url
+{
+    NSHTTPURLResponse *response = nil;
+    NSError *error = nil;
+    [NSURLConnection sendSynchronousRequest:[NSURLRequest requestWithURL:[NSURL URLWithString:url]]
+                          returningResponse:&response
+                                      error:&error];
+    STAssertNotNil(response, @"%@", error);
+    return response;
+}
+
+- (void)testStartup
+{
+    NSDate *start = [NSDate date];
+    NSDate *initialized = [self initializeSimulator];
+    NSTimeInterval initializeTime = [initialized timeIntervalSinceDate:start];
+    STAssertTrue(initializeTime >= WVSimulatorTestsInitializeLatency, @"%f", initializeTime);
+
+    NSDate *playStart = [NSDate date];
+    NSMutableString *url = [NSMutableString string];
+    STAssertEquals(WV_Play(WVSimulatorTestsAsset, url, nil), WViOsApiStatus_OK, nil);
+    NSTimeInterval playTime = -[playStart timeIntervalSinceNow];
+    STAssertTrue(playTime >= WVSimulatorTestsPlayLatency, @"%f", playTime);
+    STAssertTrue([url hasPrefix:@"http://127.0.0.1:"], @"%@", url);
+    STAssertNotNil([self waitForEvent:WViOsApiEvent_Playing after:playStart timeout:5], @"Playing was not reported");
+
+    // The proxy sends the player on to the playback URL.
+    NSUInteger proxiedBefore = [WVSimulator sharedSimulator].proxiedRequestCount;
+    NSDate *fetchStart = [NSDate date];
+    NSHTTPURLResponse *response = [self fetch:url];
+    NSTimeInterval fetchTime = -[fetchStart timeIntervalSinceNow];
+    STAssertEquals([response statusCode], (NSInteger)200, nil);
+    STAssertEqualObjects([response URL], [WVSimulator sharedSimulator].playbackURL, nil);
+    STAssertEquals([WVSimulator sharedSimulator].proxiedRequestCount, proxiedBefore + 1, nil);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)1, nil);
+
+    NSLog(@"%s initialize %.3fs, play %.3fs, first playlist %.3fs",
+          __PRETTY_FUNCTION__, initializeTime, playTime, fetchTime);
+}
+
+- (void)testStoppedVideoIsNotProxied
+{
+    [self initializeSimulator];
+    NSMutableString *url = [NSMutableString string];
+    STAssertEquals(WV_Play(WVSimulatorTestsAsset, url, nil), WViOsApiStatus_OK, nil);
+    STAssertEquals(WV_Stop(), WViOsApiStatus_OK, nil);
+
+    STAssertEquals([[self fetch:url] statusCode], (NSInteger)404, nil);
+    STAssertEquals([BCStubMediaServer sharedServer].requestCount, (NSUInteger)0, nil);
+}
+
+- (void)testBitrateSwitch
+{
+    [self initializeSimulator];
+    NSMutableString *url = [NSMutableString string];
+    STAssertEquals(WV_Play(WVSimulatorTestsAsset, url, nil), WViOsApiStatus_OK, nil);
+    STAssertNotNil([self waitForEvent:WViOsApiEvent_Bitrates after:[NSDate distantPast] timeout:5], nil);
+    STAssertEqualObjects([[self attributesOfLastEvent:WViOsApiEvent_Bitrates] objectForKey:WVBitratesKey],
+                         [WVSimulator sharedSimulator].bitrates, nil);
+
+    NSDate *switchStart = [NSDate date];
+    STAssertEquals(WV_SelectBitrateTrack(2), WViOsApiStatus_OK, nil);
+    NSDate *switched = [self waitForEvent:WViOsApiEvent_SetCurrentBitrate after:switchStart timeout:5];
+    STAssertNotNil(switched, @"SetCurrentBitrate was not reported");
+    NSTimeInterval switchTime = [switched timeIntervalSinceDate:switchStart];
+    STAssertTrue(switchTime >= WVSimulatorTestsBitrateSwitchLatency, @"%f", switchTime);
+    STAssertEqualObjects([[self attributesOfLastEvent:WViOsApiEvent_SetCurrentBitrate] objectForKey:WVCurrentBitrateKey],
+                         [NSNumber numberWithInt:1500000], nil);
+    STAssertEquals(WV_SelectBitrateTrack(3), WViOsApiStatus_BadMedia, nil);
+
+    NSLog(@"%s switch %.3fs", __PRETTY_FUNCTION__, switchTime);
+}
+
+- (void)testScriptIsReplayed
+{
+    NSDictionary *step = [NSDictionary dictionaryWithObjectsAndKeys:
+                          @"WViOsApiEvent_SetCurrentBitrate", WVSimulatorStepEventKey,
+                          [NSNumber numberWithDouble:0.1], WVSimulatorStepDelayKey,
+                          [NSDictionary dictionaryWithObject:[NSNumber numberWithInt:800000] forKey:WVCurrentBitrateKey], WVSimulatorStepAttributesKey, nil];
+    [WVSimulator sharedSimulator].script = [NSArray arrayWithObject:step];
+
+    [self initializeSimulator];
+    NSMutableString *url = [NSMutableString string];
+    NSDate *playStart = [NSDate date];
+    STAssertEquals(WV_Play(WVSimulatorTestsAsset, url, nil), WViOsApiStatus_OK, nil);
+
+    __block WVSimulatorTests *weakself = self;
+    STAssertTrue([[BCStubMediaServer sharedServer] waitUntil:^BOOL {
+        NSNumber *bitrate = [[weakself attributesOfLastEvent:WViOsApiEvent_SetCurrentBitrate] objectForKey:WVCurrentBitrateKey];
+        return [bitrate intValue] == 800000;
+    } timeout:5], @"The script step was not reported");
+    STAssertNotNil([self dateOfEvent:WViOsApiEvent_Playing after:playStart], nil);
+}
+
+- (void)testPlayStoppedAndRestartedWhileStarting
+{
+    [self initializeSimulator];
+
+    // The first WV_Play blocks for playLatency; the video is stopped and another started meanwhile.
+    __block WViOsApiStatus firstStatus = WViOsApiStatus_OK;
+    __block BOOL firstReturned = NO;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        firstStatus = WV_Play(WVSimulatorTestsAsset, [NSMutableString string], nil);
+        dispatch_async(dispatch_get_main_queue(), ^{
+            firstReturned = YES;
+        });
+    });
+    [NSThread sleepForTimeInterval:WVSimulatorTestsPlayLatency / 3];
+    STAssertEquals(WV_Stop(), WViOsApiStatus_OK, nil);
+
+    NSMutableString *url = [NSMutableString string];
+    STAssertEquals(WV_Play(WVSimulatorTestsAsset, url, nil), WViOsApiStatus_OK, nil);
+    STAssertTrue([[BCStubMediaServer sharedServer] waitUntil:^BOOL {
+        return firstReturned;
+    } timeout:5], @"The first WV_Play did not return");
+    STAssertEquals(firstStatus, WViOsApiStatus_NotPlaying, nil);
+
+    // The second video is still the one playing.
+    STAssertEquals([[self fetch:url] statusCode], (NSInteger)200, nil);
+}
+
+@end
+
+#endif